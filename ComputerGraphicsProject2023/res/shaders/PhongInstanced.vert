@@ -0,0 +1,31 @@
+#version 450
+
+// Same as Phong.vert, with the model matrices of all the instances stored in a buffer.
+layout(std430, set = 0, binding = 0) readonly buffer InstanceBufferObject {
+    mat4 models[];
+} ibo;
+
+layout(set = 1, binding = 0) uniform CameraBufferObject {
+    mat4 view;
+    mat4 proj;
+} cbo;
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inNorm;
+layout(location = 2) in vec2 inTexCoord;
+
+layout(location = 0) out vec3 fragNorm;
+layout(location = 1) out vec2 fragTexCoord;
+layout(location = 2) out vec3 fragPos;
+
+void main() {
+    mat4 model = ibo.models[gl_InstanceIndex];
+
+    vec4 position = cbo.proj * cbo.view * model * vec4(inPosition, 1.0);
+
+    gl_Position = position;
+
+    fragNorm = normalize(inverse(transpose(mat3(model))) * inNorm);
+    fragTexCoord = inTexCoord;
+    fragPos = (model * vec4(inPosition, 1.0)).xyz;
+}
@@ -32,7 +32,7 @@ GameManager::GameManager(const TerrainGenerationConfig& terrainConfig) :
 
 			auto spawnPoint = m_Player->getPosition() +
 				glm::vec3(spawnPointOffset.x, 0.0f, spawnPointOffset.y);
-			enemy->setup(m_Player, m_Terrain, spawnPoint);
+			enemy->setup(m_Player, spawnPoint);
 		}
 	});
 	m_WaveTimer->pause();
@@ -64,6 +64,7 @@ void GameManager::update(f32 dt)
 	case GameState::PLAYING:
 	{
 		m_EnemyFactory.update(dt);
+		placeEnemiesOnGround();
 		m_PickUpManager.update(dt);
 		m_Player->update(dt);
 
@@ -107,6 +108,26 @@ void GameManager::update(f32 dt)
 	m_Terrain->update(dt);
 }
 
+void GameManager::placeEnemiesOnGround()
+{
+	// The enemies are close to each other, so most of the batch is answered by the same few chunks.
+	m_EnemyPositions.clear();
+	for (auto& enemy : m_EnemyFactory)
+	{
+		auto pos = enemy->gameObject->transform->getPosition();
+		m_EnemyPositions.emplace_back(pos.x, pos.z);
+	}
+
+	m_EnemyHeights.resize(m_EnemyPositions.size());
+	m_Terrain->getHeightsAt(m_EnemyPositions, m_EnemyHeights);
+
+	u64 i = 0;
+	for (auto& enemy : m_EnemyFactory)
+	{
+		enemy->setGroundHeight(m_EnemyHeights[i++]);
+	}
+}
+
 void GameManager::setGameState(GameState gameState)
 {
 	if (gameState == m_GameState) return;
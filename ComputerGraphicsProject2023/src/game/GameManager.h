@@ -32,6 +32,8 @@ private:
 	Ref<Player> m_Player = nullptr;
 	u32 m_EnemyWaveSize = 10;
 	Factory<Enemy> m_EnemyFactory;
+	std::vector<glm::vec2> m_EnemyPositions;
+	std::vector<f32> m_EnemyHeights;
 
 	PickUpManager m_PickUpManager;
 	Ref<Timer> m_WaveTimer;
@@ -43,6 +45,8 @@ private:
 
 	void setGameState(GameState gameState);
 
+	void placeEnemiesOnGround();
+
 	void onGameOver();
 
 	void onEnemyDied(EnemyDied event);
@@ -1,6 +1,7 @@
 #define VU_LOGGER_TRACE_ENABLED
 #include "vulture/core/Application.h"
 #include "vulture/core/Job.h"
+#include "vulture/core/Task.h"
 #include "vulture/core/Logger.h"
 #include "vulture/util/ScopeTimer.h"
 
@@ -46,28 +47,7 @@ public:
 		/***********
 		 * LOADING *
 		 ***********/
-		Job::submit([](void*) -> bool {
-			using namespace std::chrono_literals;
-
-			std::this_thread::sleep_for(100ms);
-			return true;
-		}, nullptr, [this](bool, void*) {
-			DEBUG_TIMER("Game creation");
-
-			/***********
-			* TERRAIN *
-			***********/
-			TerrainGenerationConfig terrainConfig{};
-			terrainConfig.noiseScale = 2;
-			terrainConfig.heightScale = 250;
-
-			/**************
-			* GAME LOGIC *
-			**************/
-			m_GameManager = makeRef<GameManager>(terrainConfig);
-
-			m_HUD->loadingEnded();
-		});
+		load().detach();
 	}
 
 	void update(float dt) override
@@ -103,6 +83,33 @@ private:
 	Ref<HUD> m_HUD = nullptr;
 	Ref<GameManager> m_GameManager = nullptr;
 
+	Task<void> load()
+	{
+		co_await Job::worker();
+		{
+			using namespace std::chrono_literals;
+
+			std::this_thread::sleep_for(100ms);
+		}
+		co_await Job::mainThread();
+
+		DEBUG_TIMER("Game creation");
+
+		/***********
+		* TERRAIN *
+		***********/
+		TerrainGenerationConfig terrainConfig{};
+		terrainConfig.noiseScale = 2;
+		terrainConfig.heightScale = 250;
+
+		/**************
+		* GAME LOGIC *
+		**************/
+		m_GameManager = makeRef<GameManager>(terrainConfig);
+
+		m_HUD->loadingEnded();
+	}
+
 	void setupLight()
 	{
 		m_Scene->getWorld()->directLight.color = glm::vec4(1.0f);
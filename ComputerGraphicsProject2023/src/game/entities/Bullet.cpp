@@ -12,9 +12,18 @@ Bullet::Bullet(Ref<GameObject> gameObject)
 {
 	m_Hitbox = makeRef<HitBox>(makeRef<CapsuleCollisionShape>(0.05f, 0.28f));
 	m_Hitbox->layerMask = PLAYER_BULLET_MASK;
-	m_Hitbox->collisionMask = ENEMY_MASK;
+	m_Hitbox->collisionMask = ENEMY_MASK | TERRAIN_MASK;
+	// Below about 17 FPS a bullet moves farther than an enemy is wide in a single frame.
+	m_Hitbox->fast = true;
 
 	m_Hitbox->addCallback([this](const HitBoxEntered& e) {
+		// The ground stops the bullet, however many hits it has left.
+		if (e.layerMask & TERRAIN_MASK)
+		{
+			m_Status = EntityStatus::DEAD;
+			return;
+		}
+
 		m_HitsLeft--;
 
 		if (m_HitsLeft <= 0)
@@ -13,5 +13,6 @@ constexpr u64 ENEMY_MASK = BitMask::BIT1;
 constexpr u64 PLAYER_BULLET_MASK = BitMask::BIT2;
 constexpr u64 POWER_UP_MASK = BitMask::BIT3;
 constexpr u64 EXPLOSION_MASK = BitMask::BIT4;
+constexpr u64 TERRAIN_MASK = BitMask::BIT5;
 
 }
@@ -32,13 +32,11 @@ Enemy::Enemy(Ref<GameObject> gameObject) : gameObject(gameObject)
 	}, 0.0f, glm::radians(360.0f), 1.0f);
 }
 
-void Enemy::setup(Ref<Player> player, Ref<Terrain> terrain, glm::vec3 spawnLocation)
+void Enemy::setup(Ref<Player> player, glm::vec3 spawnLocation)
 {
 	m_Player = player;
 	m_Status = EntityStatus::ALIVE;
 
-	m_Terrain = terrain;
-
 	gameObject->transform->setPosition(spawnLocation);
 
 	Application::getScene()->addHitbox(m_Hitbox);
@@ -50,12 +48,15 @@ EntityStatus Enemy::update(f32 dt)
 	m_Movement->lookAt({ target.x, gameObject->transform->getPosition().y, target.z });
 	m_Movement->move(c_Speed * dt, 0, 0);
 
-	auto pos = gameObject->transform->getPosition();
-	gameObject->transform->setPosition(pos.x, m_Terrain->getHeightAt(pos.x, pos.z) + getFlyingHeight(), pos.z);
-
 	return m_Status;
 }
 
+void Enemy::setGroundHeight(f32 height)
+{
+	auto pos = gameObject->transform->getPosition();
+	gameObject->transform->setPosition(pos.x, height + getFlyingHeight(), pos.z);
+}
+
 Enemy::~Enemy()
 {
 	m_BobbingTween->stop();
@@ -18,10 +18,17 @@ public:
 
 	explicit Enemy(Ref<GameObject> gameObject);
 
-	void setup(Ref<Player> player, Ref<Terrain> terrain, glm::vec3 spawnLocation);
+	void setup(Ref<Player> player, glm::vec3 spawnLocation);
 
 	EntityStatus update(f32 dt);
 
+	/**
+	 * @brief Places the enemy at its flying height above the ground.
+	 *
+	 * @param height The height of the terrain below the enemy.
+	 */
+	void setGroundHeight(f32 height);
+
 	inline f32 getFlyingHeight() { return m_FlyingHeight; }
 
 	~Enemy();
@@ -29,7 +36,6 @@ private:
 	const f32 c_Speed = 6.0f;
 
 	Ref<Player> m_Player;
-	Ref<Terrain> m_Terrain;
 
 	EntityStatus m_Status = EntityStatus::ALIVE;
 	u32 m_Damage = 1;
@@ -40,7 +40,7 @@ void Explosion::setup(glm::vec3 initialPosition)
 
 	auto tween = Application::getScene()->makeTween();
 
-	f32 finalScale = 10.0f;
+	f32 finalScale = c_FinalRadius;
 	f32 finalRedness = 4.0f;
 
 	f32 scaleUpDuration = 2.0f;
@@ -21,6 +21,9 @@ public:
 	static const String s_EmissionTextureName;
 	static const String s_RoughnessTextureName;
 
+	// The radius of the explosion at its largest.
+	static constexpr f32 c_FinalRadius = 10.0f;
+
 	Ref<GameObject> gameObject;
 
 	explicit Explosion(Ref<GameObject> gameObject);
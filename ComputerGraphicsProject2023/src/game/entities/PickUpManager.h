@@ -28,6 +28,9 @@ public:
 private:
 	Ref<Timer> m_Timer;
 
+	static constexpr u32 c_SpawnAttempts = 4;
+	static constexpr f32 c_SpawnClearance = 5.0f;
+
 	std::function<void(f32)> m_UpdateImpl;
 	std::function<void()> m_ResetImpl;
 
@@ -66,13 +69,25 @@ inline PickUpHandler PickUpHandler::create(Ref<Player> player, Ref<Terrain> terr
 
 	auto timer = Application::getScene()->makeTimer(cooldown, false);
 	timer->addCallback([=](const TimerTimeoutEvent&) {
+		auto* collisionEngine = Application::getScene()->getCollisionEngine();
+		std::vector<Ref<HitBox>> nearbyPickUps;
+
 		for (u32 i = 0; i < amount; i++)
 		{
-			auto p = Random::nextAnnulusPoint(100.f);
 			auto pickUp = factory->get();
 			if (!pickUp) break;
 
-			auto startingLocation = player->getPosition() + glm::vec3(p.x, 0.0f, p.y);
+			// A location too close to another power-up is rolled again, a few times at most.
+			glm::vec3 startingLocation;
+			for (u32 attempt = 0; attempt < c_SpawnAttempts; attempt++)
+			{
+				auto p = Random::nextAnnulusPoint(100.f);
+				startingLocation = player->getPosition() + glm::vec3(p.x, 0.0f, p.y);
+				startingLocation.y = terrain->getHeightAt(startingLocation.x, startingLocation.z);
+
+				collisionEngine->querySphere(startingLocation, c_SpawnClearance, nearbyPickUps, POWER_UP_MASK);
+				if (nearbyPickUps.empty()) break;
+			}
 
 			pickUp->gameObject->transform->setPosition(startingLocation);
 			pickUp->setup(terrain);
@@ -283,11 +283,28 @@ void Player::onPickUpEntered(const HitBoxEntered& event)
 		if (m_CanSpawnExplosion)
 		{
 			auto* bomb = reinterpret_cast<BombData*>(pickUp);
-			auto p = Random::nextAnnulusPoint(20.0f, 10.0f);
 			auto exp = m_ExplosionFactory.get();
 			if (!exp) break;
 
-			exp->setup(m_Transform->getPosition() + glm::vec3(p.x, 2.5f, p.y));
+			// Among a few random spots, the explosion goes off where it reaches the most enemies.
+			auto* collisionEngine = Application::getScene()->getCollisionEngine();
+			std::vector<Ref<HitBox>> enemies;
+			glm::vec3 target{};
+			u64 targetEnemies = 0;
+			for (u32 i = 0; i < c_BombCandidateSpots; i++)
+			{
+				auto p = Random::nextAnnulusPoint(20.0f, 10.0f);
+				glm::vec3 spot = m_Transform->getPosition() + glm::vec3(p.x, 2.5f, p.y);
+
+				collisionEngine->querySphere(spot, Explosion::c_FinalRadius, enemies, ENEMY_MASK);
+				if (i == 0 || enemies.size() > targetEnemies)
+				{
+					target = spot;
+					targetEnemies = enemies.size();
+				}
+			}
+
+			exp->setup(target);
 			bomb->setHandled(true);
 		}
 	}
@@ -63,6 +63,7 @@ private:
 	const f32 c_SlopeSpeed = 20.0f;
 	const f32 c_MaxSlope = 0.6f;
 	const f32 c_RotSpeed = 4.0f;
+	const u32 c_BombCandidateSpots = 8;
 	f32 m_BobbingHeight = -0.4f;
 
 	Ref<Terrain> m_Terrain;
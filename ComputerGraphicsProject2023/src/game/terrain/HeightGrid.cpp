@@ -0,0 +1,42 @@
+#include "HeightGrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace game {
+
+HeightGrid::HeightGrid(glm::vec2 origin, f32 size, u32 resolution) :
+	m_Origin(origin), m_Size(size), m_Resolution(std::max(resolution, 2u)),
+	m_Heights(static_cast<u64>(m_Resolution) * m_Resolution, 0.0f)
+{}
+
+bool HeightGrid::contains(glm::vec2 position) const
+{
+	if (isEmpty()) return false;
+
+	glm::vec2 local = position - m_Origin;
+	return local.x >= 0.0f && local.y >= 0.0f && local.x <= m_Size && local.y <= m_Size;
+}
+
+f32 HeightGrid::sample(glm::vec2 position) const
+{
+	f32 cellsCount = static_cast<f32>(m_Resolution - 1);
+	glm::vec2 local = (position - m_Origin) / m_Size * cellsCount;
+	local = glm::clamp(local, 0.0f, cellsCount);
+
+	u32 x0 = std::min(static_cast<u32>(local.x), m_Resolution - 2);
+	u32 y0 = std::min(static_cast<u32>(local.y), m_Resolution - 2);
+	f32 tx = local.x - static_cast<f32>(x0);
+	f32 ty = local.y - static_cast<f32>(y0);
+
+	f32 h00 = at(x0, y0);
+	f32 h10 = at(x0 + 1, y0);
+	f32 h01 = at(x0, y0 + 1);
+	f32 h11 = at(x0 + 1, y0 + 1);
+
+	f32 h0 = h00 + (h10 - h00) * tx;
+	f32 h1 = h01 + (h11 - h01) * tx;
+	return h0 + (h1 - h0) * ty;
+}
+
+} // namespace game
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "vulture/core/Core.h"
+#include "vulture/util/Types.h"
+
+#include <vector>
+
+namespace game {
+
+using namespace vulture;
+
+/**
+ * @brief Square grid of height samples covering a region of the XZ plane.
+ *
+ * The samples are evenly spaced and include both borders of the region,
+ * so that two adjacent grids share the samples along their common edge.
+ */
+class HeightGrid
+{
+public:
+	HeightGrid() = default;
+
+	/**
+	 * @brief Constructs a grid of `resolution * resolution` samples initialized to zero.
+	 *
+	 * @param origin The world position of the (0, 0) sample.
+	 * @param size The side length of the covered region in world units.
+	 * @param resolution The number of samples along each side.
+	 */
+	HeightGrid(glm::vec2 origin, f32 size, u32 resolution);
+
+	/**
+	 * @brief Checks whether a world position lies inside the covered region.
+	 *
+	 * @param position The world position to test.
+	 * @return true if the position can be sampled, false otherwise.
+	 */
+	bool contains(glm::vec2 position) const;
+
+	/**
+	 * @brief Computes the height at a world position using bilinear interpolation.
+	 * The position is expected to be inside the grid (see contains).
+	 *
+	 * @param position The world position to sample.
+	 * @return The interpolated height.
+	 */
+	f32 sample(glm::vec2 position) const;
+
+	/**
+	 * @brief Gets a reference to the sample at the given grid coordinates.
+	 */
+	inline f32& at(u32 x, u32 y) { return m_Heights[static_cast<u64>(y) * m_Resolution + x]; }
+
+	/**
+	 * @brief Gets the sample at the given grid coordinates.
+	 */
+	inline f32 at(u32 x, u32 y) const { return m_Heights[static_cast<u64>(y) * m_Resolution + x]; }
+
+	inline bool isEmpty() const { return m_Heights.empty(); }
+
+	inline glm::vec2 getOrigin() const { return m_Origin; }
+	inline f32 getSize() const { return m_Size; }
+	inline u32 getResolution() const { return m_Resolution; }
+private:
+	glm::vec2 m_Origin = { 0, 0 };
+	f32 m_Size = 0.0f;
+	u32 m_Resolution = 0;
+	std::vector<f32> m_Heights;
+};
+
+} // namespace game
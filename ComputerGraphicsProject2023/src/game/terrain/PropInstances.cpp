@@ -0,0 +1,56 @@
+#include "PropInstances.h"
+
+#include "vulture/core/Application.h"
+
+namespace game {
+
+PropInstances::PropInstances(PipelineHandle pipeline, Ref<DescriptorSetLayout> descriptorSetLayout,
+	const String& modelName, const String& textureName, const String& roughnessTextureName, u32 instanceCount) :
+	m_Scene(Application::getScene()), m_Pipeline(pipeline)
+{
+	m_Model = Model::get(modelName);
+
+	m_BaseTexture = Texture::get("base/" + textureName);
+	m_TextureSampler = makeRef<TextureSampler>(*m_BaseTexture);
+
+	m_EmissionTexture = Texture::get("emission/" + GameObject::c_DefaultEmissionTextureName);
+	m_EmissionTextureSampler = makeRef<TextureSampler>(*m_EmissionTexture);
+
+	m_RoughnessTexture = Texture::get("roughness/" + roughnessTextureName);
+	m_RoughnessTextureSampler = makeRef<TextureSampler>(*m_RoughnessTexture);
+
+	m_Instances = Renderer::makeStorageBuffer<glm::mat4>(instanceCount);
+	// Every instance is hidden until set.
+	std::vector<glm::mat4> hiddenInstances(instanceCount, glm::mat4(0.0f));
+	m_Instances.set(0, hiddenInstances);
+	m_ObjectUniform = Renderer::makeUniform<ObjectBufferObject>();
+
+	m_DescriptorSet = m_Scene->getDescriptorPool()->getDescriptorSet(
+		descriptorSetLayout,
+		{ m_Instances, *m_TextureSampler, *m_EmissionTextureSampler, *m_RoughnessTextureSampler, m_ObjectUniform });
+
+	m_Object = m_Scene->addObject(m_Pipeline, m_Model, m_DescriptorSet, instanceCount);
+}
+
+Ref<DescriptorSetLayout> PropInstances::makeDescriptorSetLayout()
+{
+	auto layout = makeRef<DescriptorSetLayout>();
+	// Instances Buffer
+	layout->addBinding(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_VERTEX_BIT);
+	// Base, Emission and Roughness Textures
+	layout->addBinding(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT);
+	layout->addBinding(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT);
+	layout->addBinding(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT);
+	// ObjectBufferObject
+	layout->addBinding(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT);
+	layout->create();
+
+	return layout;
+}
+
+PropInstances::~PropInstances()
+{
+	m_Scene->removeObject(m_Pipeline, m_Object);
+}
+
+} // namespace game
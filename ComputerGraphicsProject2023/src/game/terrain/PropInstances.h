@@ -0,0 +1,74 @@
+#pragma once
+
+#include "vulture/scene/Scene.h"
+
+#include <span>
+
+namespace game {
+
+using namespace vulture;
+
+/**
+ * @brief Draws many copies of a model with a single instanced draw call.
+ *
+ * Every instance has its own model matrix, stored in a buffer that is updated incrementally.
+ * The pipeline must use PhongInstanced.vert and a descriptor set layout compatible with makeDescriptorSetLayout.
+ */
+class PropInstances
+{
+public:
+	NO_COPY(PropInstances)
+
+	/**
+	 * @brief Adds the instances to the scene, all of them initially hidden.
+	 *
+	 * @param pipeline The pipeline used to draw the instances.
+	 * @param descriptorSetLayout The layout created by makeDescriptorSetLayout.
+	 * @param modelName The name of the model.
+	 * @param textureName The name of the base color texture.
+	 * @param roughnessTextureName The name of the roughness texture.
+	 * @param instanceCount The number of instances.
+	 */
+	PropInstances(PipelineHandle pipeline, Ref<DescriptorSetLayout> descriptorSetLayout,
+		const String& modelName, const String& textureName, const String& roughnessTextureName, u32 instanceCount);
+
+	/**
+	 * @brief Sets the model matrices of a range of instances.
+	 * A null matrix hides the instance.
+	 *
+	 * @param first The index of the first instance to update.
+	 * @param transforms The model matrices of the instances.
+	 */
+	inline void setInstances(u32 first, std::span<const glm::mat4> transforms) { m_Instances.set(first, transforms); }
+
+	inline u32 getInstanceCount() const { return static_cast<u32>(m_Instances.getSize()); }
+
+	/**
+	 * @brief Creates the descriptor set layout used by the instanced pipelines.
+	 */
+	static Ref<DescriptorSetLayout> makeDescriptorSetLayout();
+
+	~PropInstances();
+private:
+	Scene* m_Scene;
+	PipelineHandle m_Pipeline;
+
+	Ref<Model> m_Model;
+
+	Ref<Texture> m_BaseTexture;
+	Ref<TextureSampler> m_TextureSampler;
+
+	Ref<Texture> m_EmissionTexture;
+	Ref<TextureSampler> m_EmissionTextureSampler;
+
+	Ref<Texture> m_RoughnessTexture;
+	Ref<TextureSampler> m_RoughnessTextureSampler;
+
+	StorageBuffer<glm::mat4> m_Instances;
+	Uniform<ObjectBufferObject> m_ObjectUniform;
+
+	Ref<DescriptorSet> m_DescriptorSet;
+	ObjectHandle m_Object;
+};
+
+} // namespace game
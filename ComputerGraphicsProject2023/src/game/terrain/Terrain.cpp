@@ -1,34 +1,75 @@
 #include "Terrain.h"
+#include "TerrainNoise.h"
+#include "game/entities/CollisionMask.h"
 
 #include "vulture/core/Logger.h"
 #include "vulture/core/Input.h"
+#include "vulture/core/Job.h"
 #include "vulture/util/Random.h"
 
-#include "stb_perlin.h"
+#include <algorithm>
+#include <random>
 
 namespace game {
 
 using namespace vulture;
 
 static constexpr f32 NOISE_SCALE_MULTIPLIER = 100.0f;
+static constexpr u32 HEIGHTMAP_RESOLUTION = 128;
+static constexpr u32 MIN_HEIGHTMAP_RESOLUTION = 8;
+static constexpr u32 HEIGHTMAP_ROWS_GRAIN = 8;
+static constexpr u32 PLANE_RESOLUTION = 200;
+static constexpr u32 MIN_PLANE_RESOLUTION = 4;
+// Depth of the skirts hiding the cracks between chunks with different levels of detail, relative to the height scale.
+static constexpr f32 SKIRT_DEPTH_FACTOR = 0.02f;
+static constexpr f32 PROP_SCALE = 0.05f;
+static constexpr f32 TREE_VERTICAL_OFFSET = -1.0f;
+static constexpr f32 ROCK_VERTICAL_OFFSET = 0.2f;
+static constexpr u32 POISSON_DISK_ATTEMPTS = 30;
+
+static inline u32 getHeightmapResolution(u32 lod)
+{
+	return std::max(HEIGHTMAP_RESOLUTION >> std::min(lod, 31u), MIN_HEIGHTMAP_RESOLUTION);
+}
+
+/*
+ * CPU-side data of a chunk: the heightmap pixels to be uploaded and
+ * the grid of heights used to answer the terrain queries.
+ */
+struct TerrainChunkData
+{
+	std::vector<f32> pixels;
+	HeightGrid heightGrid;
+
+	// Stops the generation when a newer one is requested for the same chunk.
+	JobStopToken stopToken;
 
-f32 noiseFunction(f32 x, f32 y);
-glm::vec4 noise(f32 x, f32 y);
+	inline bool isStale() const { return stopToken.stopRequested(); }
+};
 
-static i32 terrainNoiseSeed = 0;
+static bool generateChunkData(TerrainChunkData& data, glm::vec2 noisePosition, glm::vec2 noiseSize);
+static void validateGpuHeights(const HeightGrid& heightGrid, glm::vec2 noisePosition, glm::vec2 noiseSize);
 
 TerrainGenerationConfig TerrainGenerationConfig::defaultConfig{};
 
 Terrain::Terrain(const TerrainGenerationConfig& config) :
 	m_Config(config)
 {
-	terrainNoiseSeed = Random::nextInt();
+	setTerrainNoiseSeed(Random::nextInt());
 	initializeRenderingComponents();
 	initializeChunks();
 }
 
 void Terrain::update(f32 dt)
 {
+	if (m_NoiseShader)
+	{
+		for (auto& chunk : m_Chunks)
+		{
+			chunk->pollGpuGenerations();
+		}
+	}
+	dispatchPendingChunks();
 }
 
 void Terrain::setReferencePosition(glm::vec2 position)
@@ -42,6 +83,7 @@ void Terrain::setReferencePosition(glm::vec2 position)
 	if (oldX != targetX || oldY != targetY)
 	{
 		std::vector<Ref<TerrainChunk>> newChunks(m_Chunks.size());
+		glm::vec2 referenceChunk = { static_cast<f32>(targetX), static_cast<f32>(targetY) };
 
 		i64 count = m_ChunksSideCount;
 		for (i64 y = 0; y < count; y++)
@@ -69,12 +111,23 @@ void Terrain::setReferencePosition(glm::vec2 position)
 					}
 
 					auto& chunk = m_Chunks[vectorCoordY * count + vectorCoordX];
-					chunk->update(chunkPosition);
+					requestChunkUpdate(chunk, chunkPosition, getChunkLod(chunkPosition, referenceChunk));
 					newChunks[y * count + x] = chunk;
 				}
 				else
 				{
-					newChunks[y * count + x] = m_Chunks[vectorCoordY * count + vectorCoordX];
+					auto& chunk = m_Chunks[vectorCoordY * count + vectorCoordX];
+					newChunks[y * count + x] = chunk;
+
+					glm::vec2 chunkPosition = {
+						static_cast<f32>(targetX + x - count / 2),
+						static_cast<f32>(targetY + y - count / 2)
+					};
+					u32 lod = getChunkLod(chunkPosition, referenceChunk);
+					if (lod != chunk->getLod())
+					{
+						requestChunkUpdate(chunk, chunkPosition, lod);
+					}
 				}
 			}
 		}
@@ -86,32 +139,79 @@ void Terrain::setReferencePosition(glm::vec2 position)
 
 f32 Terrain::getHeightAt(glm::vec2 position) const
 {
-	auto chunkPosition = position * m_Config.noiseScale / NOISE_SCALE_MULTIPLIER;
-	f32 h = noiseFunction(chunkPosition.x, chunkPosition.y);
-	return std::clamp(h, m_VertexUniform->waterLevel, 1.0f) * m_VertexUniform->scale;
+	return noiseToHeight(getNoiseAt(position));
 }
 
 glm::vec2 Terrain::getSlopeAt(glm::vec2 position) const
 {
+	// The offset is expressed in noise space to keep the slope consistent with the heightmap normals.
 	constexpr f32 epsilon = 0.01f;
-	auto chunkPosition = position * m_Config.noiseScale / NOISE_SCALE_MULTIPLIER;
-
-	f32 h0 = noiseFunction(chunkPosition.x, chunkPosition.y);
-	f32 hx = noiseFunction(chunkPosition.x + epsilon, chunkPosition.y);
-	f32 hy = noiseFunction(chunkPosition.x, chunkPosition.y + epsilon);
+	f32 offset = epsilon * NOISE_SCALE_MULTIPLIER / m_Config.noiseScale;
 
-	h0 = std::clamp(h0, m_VertexUniform->waterLevel, 1.0f) * m_VertexUniform->scale;
-	hx = std::clamp(hx, m_VertexUniform->waterLevel, 1.0f) * m_VertexUniform->scale;
-	hy = std::clamp(hy, m_VertexUniform->waterLevel, 1.0f) * m_VertexUniform->scale;
+	f32 h0 = getHeightAt(position);
+	f32 hx = getHeightAt(position + glm::vec2(offset, 0.0f));
+	f32 hy = getHeightAt(position + glm::vec2(0.0f, offset));
 
 	return glm::vec2(hx - h0, hy - h0);
 }
 
 bool Terrain::isWater(glm::vec2 position) const
 {
-	auto chunkPosition = position * m_Config.noiseScale / NOISE_SCALE_MULTIPLIER;
-	f32 h = noiseFunction(chunkPosition.x, chunkPosition.y);
-	return h <= m_VertexUniform->waterLevel;
+	return getNoiseAt(position) <= m_VertexUniform->waterLevel;
+}
+
+void Terrain::getHeightsAt(std::span<const glm::vec2> positions, std::span<f32> heights) const
+{
+	const HeightGrid* grid = nullptr;
+	for (u64 i = 0; i < positions.size() && i < heights.size(); i++)
+	{
+		// Consecutive queries usually fall in the same chunk.
+		if (!grid || !grid->contains(positions[i]))
+		{
+			grid = findHeightGrid(positions[i]);
+		}
+
+		f32 h;
+		if (grid)
+		{
+			h = grid->sample(positions[i]);
+		}
+		else
+		{
+			auto noisePosition = positions[i] * m_Config.noiseScale / NOISE_SCALE_MULTIPLIER;
+			h = noiseFunction(noisePosition.x, noisePosition.y);
+		}
+		heights[i] = noiseToHeight(h);
+	}
+}
+
+const HeightGrid* Terrain::findHeightGrid(glm::vec2 position) const
+{
+	i64 count = m_ChunksSideCount;
+	i64 firstX = static_cast<i64>(std::floor(m_ReferencePosition.x / m_Config.chunkSize)) - count / 2;
+	i64 firstY = static_cast<i64>(std::floor(m_ReferencePosition.y / m_Config.chunkSize)) - count / 2;
+
+	i64 x = static_cast<i64>(std::floor(position.x / m_Config.chunkSize)) - firstX;
+	i64 y = static_cast<i64>(std::floor(position.y / m_Config.chunkSize)) - firstY;
+
+	if (x < 0 || x >= count || y < 0 || y >= count) return nullptr;
+
+	auto& chunk = m_Chunks[y * count + x];
+	// The chunk may still be under construction or waiting for the generation of its new position.
+	if (!chunk || !chunk->getHeightGrid().contains(position)) return nullptr;
+
+	return &chunk->getHeightGrid();
+}
+
+f32 Terrain::getNoiseAt(glm::vec2 position) const
+{
+	if (auto* grid = findHeightGrid(position))
+	{
+		return grid->sample(position);
+	}
+
+	auto noisePosition = position * m_Config.noiseScale / NOISE_SCALE_MULTIPLIER;
+	return noiseFunction(noisePosition.x, noisePosition.y);
 }
 
 void Terrain::initializeRenderingComponents()
@@ -135,12 +235,23 @@ void Terrain::initializeRenderingComponents()
 
 	m_Pipeline = m_Scene->makePipeline("res/shaders/Terrain_vert.spv", "res/shaders/Terrain_frag.spv", m_DescriptorSetLayout);
 
-	// Model is just a flat plane
-	m_Model = Model::getPlane(200, 200);
+	// Models are flat planes with decreasing resolution, one for every level of detail.
+	// The skirts hide the cracks between adjacent chunks of different levels.
+	f32 skirtDepth = m_Config.heightScale * SKIRT_DEPTH_FACTOR;
+	for (u32 lod = 0; lod <= m_Config.lodDistances.size(); lod++)
+	{
+		u32 resolution = std::max(PLANE_RESOLUTION >> std::min(lod, 31u), MIN_PLANE_RESOLUTION);
+		m_LodModels.push_back(Model::getPlane(resolution, resolution, skirtDepth));
+	}
 	m_VertexUniform = Renderer::makeUniform<TerrainVertexBufferObject>();
 
 	m_VertexUniform->scale = m_Config.heightScale;
 
+	if (m_Config.useGpuGeneration)
+	{
+		m_NoiseShader = makeRef<TerrainNoiseShader>(getTerrainNoiseSeed());
+	}
+
 	m_WaterTexture = Texture::get("water");
 	m_WaterSampler = makeRef<TextureSampler>(*m_WaterTexture);
 
@@ -160,6 +271,8 @@ void Terrain::initializeChunks()
 
 	m_Chunks.resize(m_ChunksSideCount * m_ChunksSideCount);
 
+	initializeProps();
+
 	i64 count = m_ChunksSideCount;
 
 	for (i64 y = 0; y < count; y++)
@@ -170,40 +283,207 @@ void Terrain::initializeChunks()
 				static_cast<f32>(x - count / 2),
 				static_cast<f32>(y - count / 2)
 			};
-			m_Chunks[y * count + x] = makeRef<TerrainChunk>(this, chunkPosition);
+			m_Chunks[y * count + x] = makeRef<TerrainChunk>(this, static_cast<u32>(y * count + x), chunkPosition, getChunkLod(chunkPosition, { 0, 0 }));
 		}
 	}
 }
 
-TerrainChunk::TerrainChunk(Terrain* terrain, glm::vec2 position) :
-	m_Terrain(terrain)
+void Terrain::initializeProps()
+{
+	u32 chunksCount = static_cast<u32>(m_ChunksSideCount * m_ChunksSideCount);
+
+	m_PropDescriptorSetLayout = PropInstances::makeDescriptorSetLayout();
+	m_PropPipeline = m_Scene->makePipeline("res/shaders/PhongInstanced_vert.spv", "res/shaders/Phong_frag.spv", m_PropDescriptorSetLayout);
+
+	PipelineAdvancedConfig leavesConfig{};
+	leavesConfig.cullMode = VK_CULL_MODE_NONE;
+	m_LeavesPipeline = m_Scene->makePipeline("res/shaders/PhongInstanced_vert.spv", "res/shaders/Phong_frag.spv", m_PropDescriptorSetLayout, leavesConfig);
+
+	if (m_Config.treesPerChunk > 0)
+	{
+		u32 treesCount = chunksCount * m_Config.treesPerChunk;
+		m_TreeTrunks = makeRef<PropInstances>(m_PropPipeline, m_PropDescriptorSetLayout, "tree-trunk", "tree-trunk", "rough", treesCount);
+		m_TreeLeaves = makeRef<PropInstances>(m_LeavesPipeline, m_PropDescriptorSetLayout, "tree-leaves", "tree-leaves", "rough", treesCount);
+	}
+
+	if (m_Config.rocksPerChunk > 0)
+	{
+		u32 rocksCount = chunksCount * m_Config.rocksPerChunk;
+		m_Rocks = makeRef<PropInstances>(m_PropPipeline, m_PropDescriptorSetLayout, "rock", "rock", "rock", rocksCount);
+	}
+}
+
+void Terrain::requestChunkUpdate(const Ref<TerrainChunk>& chunk, glm::vec2 position, u32 lod)
+{
+	// The generation in progress, if any, is superseded by this request.
+	chunk->cancel();
+	// The level is updated immediately so that following reference position changes see the requested one.
+	chunk->setLod(lod);
+
+	auto it = std::find_if(m_PendingChunks.begin(), m_PendingChunks.end(), [&chunk](const ChunkRequest& request) {
+		return request.chunk == chunk;
+	});
+
+	if (it != m_PendingChunks.end())
+	{
+		it->position = position;
+		it->lod = lod;
+	}
+	else
+	{
+		m_PendingChunks.push_back({ chunk, position, lod });
+	}
+}
+
+void Terrain::dispatchPendingChunks()
+{
+	if (m_PendingChunks.empty() || *m_ChunksInFlight >= m_Config.maxChunksInFlight) return;
+
+	// The closest chunks are the most visible ones, they are placed at the end to be popped first.
+	glm::vec2 referenceChunk = glm::floor(m_ReferencePosition / m_Config.chunkSize);
+	std::sort(m_PendingChunks.begin(), m_PendingChunks.end(), [referenceChunk](const ChunkRequest& a, const ChunkRequest& b) {
+		return glm::distance(a.position, referenceChunk) > glm::distance(b.position, referenceChunk);
+	});
+
+	while (!m_PendingChunks.empty() && *m_ChunksInFlight < m_Config.maxChunksInFlight)
+	{
+		ChunkRequest request = std::move(m_PendingChunks.back());
+		m_PendingChunks.pop_back();
+
+		(*m_ChunksInFlight)++;
+		request.chunk->update(request.position, request.lod, [chunksInFlight = m_ChunksInFlight]() {
+			(*chunksInFlight)--;
+		});
+	}
+}
+
+u32 Terrain::getChunkLod(glm::vec2 chunkPosition, glm::vec2 referenceChunk) const
+{
+	f32 distance = glm::length(chunkPosition - referenceChunk) * m_Config.chunkSize;
+
+	u32 lod = 0;
+	while (lod < m_Config.lodDistances.size() && distance > m_Config.lodDistances[lod])
+	{
+		lod++;
+	}
+	return lod;
+}
+
+TerrainChunk::TerrainChunk(Terrain* terrain, u32 slot, glm::vec2 position, u32 lod) :
+	m_Terrain(terrain), m_Slot(slot), m_Lod(lod)
 {
 	m_Scene = terrain->m_Scene;
-	m_Tree = makeRef<Tree>();
-	m_Rock = makeRef<Rock>();
 
 	m_Uniform = Renderer::makeUniform<ModelBufferObject>();
+
+	m_Heightfield = makeRef<HeightfieldCollisionShape>();
+	m_Hitbox = makeRef<HitBox>(m_Heightfield);
+	m_Hitbox->layerMask = TERRAIN_MASK;
+
 	glm::vec2 noiseSize = glm::vec2(1, 1) * terrain->m_Config.noiseScale * terrain->m_Config.chunkSize / NOISE_SCALE_MULTIPLIER;
-	updateRenderingComponents(Texture::make(128, 128, position * noiseSize, noiseSize, noise), position);
+
+	u32 resolution = getHeightmapResolution(lod);
+	TerrainChunkData data;
+	data.heightGrid = HeightGrid(position * terrain->m_Config.chunkSize, terrain->m_Config.chunkSize, resolution);
+
+	Ref<Texture> texture;
+	if (terrain->m_NoiseShader)
+	{
+		// Chunks are created synchronously on both paths, so the first heightmap is awaited.
+		auto heightmap = terrain->m_NoiseShader->generate(position * noiseSize, noiseSize, resolution);
+		heightmap->wait();
+		terrain->m_NoiseShader->readHeights(*heightmap, data.heightGrid);
+		texture = heightmap->getTexture();
+		if (terrain->m_Config.validateGpuGeneration)
+			validateGpuHeights(data.heightGrid, position * noiseSize, noiseSize);
+	}
+	else
+	{
+		generateChunkData(data, position * noiseSize, noiseSize);
+		texture = Texture::make(resolution, resolution, data.pixels.data());
+	}
+	updateRenderingComponents(texture, std::move(data.heightGrid), position, lod);
+
+	m_Scene->addHitbox(m_Hitbox);
 }
 
-void TerrainChunk::update(glm::vec2 position)
+void TerrainChunk::update(glm::vec2 position, u32 lod, std::function<void()> onFinished)
 {
 	glm::vec2 noiseSize = glm::vec2(1, 1) * m_Terrain->m_Config.noiseScale * m_Terrain->m_Config.chunkSize / NOISE_SCALE_MULTIPLIER;
-	Texture::makeAsync(128, 128, position * noiseSize, noiseSize, noise, [this, position](Ref<Texture> texture) {
-		m_Scene->removeObject(m_Terrain->m_Pipeline, m_Object);
-		updateRenderingComponents(texture, position);
-	});
+
+	u32 resolution = getHeightmapResolution(lod);
+
+	if (m_Terrain->m_NoiseShader)
+	{
+		m_GpuGenerationId++;
+		auto heightmap = m_Terrain->m_NoiseShader->generate(position * noiseSize, noiseSize, resolution);
+		m_GpuGenerations.push_back({ heightmap, position, lod, m_GpuGenerationId, std::move(onFinished) });
+		return;
+	}
+
+	TerrainChunkData* data = new TerrainChunkData;
+	data->heightGrid = HeightGrid(position * m_Terrain->m_Config.chunkSize, m_Terrain->m_Config.chunkSize, resolution);
+
+	m_UpdateJob.cancel();
+	m_UpdateJob = Job::submit([position, noiseSize](void* _data) -> bool
+	{
+		TerrainChunkData* chunkData = reinterpret_cast<TerrainChunkData*>(_data);
+		chunkData->stopToken = Job::getStopToken();
+		return generateChunkData(*chunkData, position * noiseSize, noiseSize);
+	}, data, [this, position, lod, resolution, onFinished](bool result, void* _data)
+	{
+		TerrainChunkData* chunkData = reinterpret_cast<TerrainChunkData*>(_data);
+		// The result is false if a newer generation was requested, even after the work completed.
+		if (result)
+		{
+			auto texture = Texture::make(resolution, resolution, chunkData->pixels.data());
+			m_Scene->removeObject(m_Terrain->m_Pipeline, m_Object);
+			updateRenderingComponents(texture, std::move(chunkData->heightGrid), position, lod);
+		}
+		delete chunkData;
+
+		if (onFinished) onFinished();
+	}, {}, JobPriority::LOW);
+}
+
+void TerrainChunk::pollGpuGenerations()
+{
+	glm::vec2 noiseSize = glm::vec2(1, 1) * m_Terrain->m_Config.noiseScale * m_Terrain->m_Config.chunkSize / NOISE_SCALE_MULTIPLIER;
+
+	while (!m_GpuGenerations.empty() && m_GpuGenerations.front().heightmap->isReady())
+	{
+		GpuGeneration generation = std::move(m_GpuGenerations.front());
+		m_GpuGenerations.erase(m_GpuGenerations.begin());
+
+		// Generations superseded by a newer update or cancelled are discarded.
+		if (generation.id == m_GpuGenerationId)
+		{
+			u32 resolution = getHeightmapResolution(generation.lod);
+			HeightGrid heightGrid(generation.position * m_Terrain->m_Config.chunkSize, m_Terrain->m_Config.chunkSize, resolution);
+			m_Terrain->m_NoiseShader->readHeights(*generation.heightmap, heightGrid);
+			if (m_Terrain->m_Config.validateGpuGeneration)
+				validateGpuHeights(heightGrid, generation.position * noiseSize, noiseSize);
+
+			m_Scene->removeObject(m_Terrain->m_Pipeline, m_Object);
+			updateRenderingComponents(generation.heightmap->getTexture(), std::move(heightGrid), generation.position, generation.lod);
+		}
+
+		if (generation.onFinished) generation.onFinished();
+	}
 }
 
 TerrainChunk::~TerrainChunk()
 {
+	m_UpdateJob.cancel();
 	m_Scene->removeObject(m_Terrain->m_Pipeline, m_Object);
+	m_Scene->removeHitbox(m_Hitbox);
 }
 
-void TerrainChunk::updateRenderingComponents(const Ref<Texture>& texture, glm::vec2 position)
+void TerrainChunk::updateRenderingComponents(const Ref<Texture>& texture, HeightGrid&& heightGrid, glm::vec2 position, u32 lod)
 {
 	m_NoiseTexture = texture;
+	m_HeightGrid = std::move(heightGrid);
+	updateCollider();
 	TextureSamplerConfig samplerConfig;
 	samplerConfig.setAddressMode(VK_SAMPLER_ADDRESS_MODE_MIRRORED_REPEAT);
 	m_NoiseSampler = makeRef<TextureSampler>(*m_NoiseTexture, samplerConfig);
@@ -217,53 +497,178 @@ void TerrainChunk::updateRenderingComponents(const Ref<Texture>& texture, glm::v
 		{ m_Uniform, *m_NoiseSampler, m_Terrain->m_VertexUniform, *m_Terrain->m_WaterSampler,
 		*m_Terrain->m_SandSampler, *m_Terrain->m_GrassSampler, *m_Terrain->m_RockSampler });
 
-	m_Object = m_Scene->addObject(m_Terrain->m_Pipeline, m_Terrain->m_Model, m_DescriptorSet);
+	m_Object = m_Scene->addObject(m_Terrain->m_Pipeline, m_Terrain->m_LodModels[lod], m_DescriptorSet);
+
+	scatterProps(position);
+}
 
-	auto treePosition = getPropPosition(0x4269);
-	treePosition.y -= 1.0f;
-	m_Tree->setPosition(treePosition);
+void TerrainChunk::updateCollider()
+{
+	u32 resolution = m_HeightGrid.getResolution();
+	std::vector<f32> heights(static_cast<u64>(resolution) * resolution);
+	for (u32 y = 0; y < resolution; y++)
+	{
+		for (u32 x = 0; x < resolution; x++)
+		{
+			heights[static_cast<u64>(y) * resolution + x] = m_Terrain->noiseToHeight(m_HeightGrid.at(x, y));
+		}
+	}
+	m_Heightfield->setHeights(m_HeightGrid.getOrigin(), m_HeightGrid.getSize(), resolution, std::move(heights));
 
-	auto rockPosition = getPropPosition(0x1172);
-	rockPosition.y += 0.2f;
-	m_Rock->setPosition(rockPosition);
+	// The collision engine keeps the bounds of a static collider until told they changed.
+	// The first time the collider is not in the engine yet, and gets its bounds when added.
+	m_Scene->updateStaticHitbox(m_Hitbox);
 }
 
-glm::vec3 TerrainChunk::getPropPosition(size_t seed)
+/*
+ * Dart throwing Poisson-disk sampling of a square region: random candidates closer than
+ * minDistance to an accepted point are rejected, and so are the ones near the borders.
+ * Fewer than count points are returned if the region is too crowded.
+ */
+template <class Generator>
+static std::vector<glm::vec2> samplePoissonDisk(Generator& nextFloat, f32 size, f32 minDistance, u32 count)
 {
-	glm::vec3 chunkPosition = glm::column(m_Uniform->model, 3);
+	std::vector<glm::vec2> points;
+	points.reserve(count);
 
-	auto hashX = std::hash<f32>()(chunkPosition.x) ^ std::hash<f32>()(chunkPosition.z) ^ seed;
-	auto hashZ = hashX ^ seed;
+	f32 margin = minDistance * 0.5f;
+	f32 range = std::max(size - 2.0f * margin, 0.0f);
+	f32 minDistance2 = minDistance * minDistance;
 
-	auto offsetX = (hashX % 1024) / 1024.0f * m_Terrain->m_Config.chunkSize;
-	auto offsetZ = (hashZ % 1024) / 1024.0f * m_Terrain->m_Config.chunkSize;
+	for (u32 attempt = 0; attempt < count * POISSON_DISK_ATTEMPTS && points.size() < count; attempt++)
+	{
+		f32 x = nextFloat();
+		f32 y = nextFloat();
+		glm::vec2 candidate = glm::vec2(margin) + glm::vec2(x, y) * range;
 
-	auto x = chunkPosition.x + offsetX;
-	auto z = chunkPosition.z + offsetZ;
-	auto y = m_Terrain->getHeightAt(x, z);
+		bool isFarEnough = std::none_of(points.begin(), points.end(), [candidate, minDistance2](glm::vec2 point) {
+			glm::vec2 d = point - candidate;
+			return glm::dot(d, d) < minDistance2;
+		});
 
-	if (m_Terrain->isWater(x, z)) y -= 100.0f;
+		if (isFarEnough) points.push_back(candidate);
+	}
 
-	return {x, y, z};
+	return points;
 }
 
-f32 noiseFunction(f32 x, f32 y)
+void TerrainChunk::scatterProps(glm::vec2 position)
 {
-	f32 h = stb_perlin_noise3_seed(x, y, 0.0f, 0, 0, 0, terrainNoiseSeed);
-	h += stb_perlin_ridge_noise3(x, y, 0.0f, 2.0f, 0.5f, 1.0f, 4) * 0.5f;
-	h += 1.5f;
-	h /= 3.0f;
-	h = 0.5f - 4.0f * std::pow(0.5f - h, 3.0f);
-	return h * h;
+	auto& config = m_Terrain->m_Config;
+	u32 treesCount = m_Terrain->m_TreeTrunks ? config.treesPerChunk : 0;
+	u32 rocksCount = m_Terrain->m_Rocks ? config.rocksPerChunk : 0;
+
+	if (treesCount + rocksCount == 0) return;
+
+	// The placements only depend on the chunk position, chunks look the same every time they are generated.
+	u32 seed = static_cast<u32>(static_cast<i32>(position.x)) * 73856093u ^
+		static_cast<u32>(static_cast<i32>(position.y)) * 19349663u ^
+		static_cast<u32>(getTerrainNoiseSeed());
+	std::mt19937 rng(seed);
+	auto nextFloat = [&rng]() { return static_cast<f32>(rng() >> 8) / 16777216.0f; };
+
+	glm::vec2 origin = position * config.chunkSize;
+	auto points = samplePoissonDisk(nextFloat, config.chunkSize, config.propMinDistance, treesCount + rocksCount);
+
+	auto getPropTransform = [&](u64 index, f32 verticalOffset) {
+		f32 yaw = nextFloat() * glm::two_pi<f32>();
+		if (index >= points.size()) return glm::mat4(0.0f);
+
+		glm::vec2 propPosition = origin + points[index];
+		f32 noise = m_HeightGrid.sample(propPosition);
+		// A null matrix hides the instance.
+		if (noise <= m_Terrain->m_VertexUniform->waterLevel) return glm::mat4(0.0f);
+
+		glm::vec3 translation = { propPosition.x, m_Terrain->noiseToHeight(noise) + verticalOffset, propPosition.y };
+		return glm::translate(glm::mat4(1), translation) *
+			glm::rotate(glm::mat4(1), yaw, { 0, 1, 0 }) *
+			glm::scale(glm::mat4(1), glm::vec3(PROP_SCALE));
+	};
+
+	if (treesCount > 0)
+	{
+		std::vector<glm::mat4> trees(treesCount);
+		for (u32 i = 0; i < treesCount; i++)
+		{
+			trees[i] = getPropTransform(i, TREE_VERTICAL_OFFSET);
+		}
+		m_Terrain->m_TreeTrunks->setInstances(m_Slot * treesCount, trees);
+		m_Terrain->m_TreeLeaves->setInstances(m_Slot * treesCount, trees);
+	}
+
+	if (rocksCount > 0)
+	{
+		std::vector<glm::mat4> rocks(rocksCount);
+		for (u32 i = 0; i < rocksCount; i++)
+		{
+			rocks[i] = getPropTransform(treesCount + i, ROCK_VERTICAL_OFFSET);
+		}
+		m_Terrain->m_Rocks->setInstances(m_Slot * rocksCount, rocks);
+	}
 }
 
-glm::vec4 noise(f32 x, f32 y)
+/*
+ * Fills the heightmap pixels with the same layout used by Texture::make,
+ * keeping the sampled heights in the chunk's grid.
+ */
+static bool generateChunkData(TerrainChunkData& data, glm::vec2 noisePosition, glm::vec2 noiseSize)
 {
-	constexpr f32 epsilon = 0.01f;
-	f32 h0 = noiseFunction(x, y);
-	f32 hx = noiseFunction(x + epsilon, y);
-	f32 hy = noiseFunction(x, y + epsilon);
-	return glm::vec4(h0, hx, hy, epsilon);
+	u32 resolution = data.heightGrid.getResolution();
+	data.pixels.resize(static_cast<u64>(resolution) * resolution * 4);
+
+	// Rows are independent, so they are generated in parallel.
+	Job::parallelFor(0, resolution, HEIGHTMAP_ROWS_GRAIN, [&](u64 y) {
+		if (data.isStale()) return;
+
+		for (u32 x = 0; x < resolution; x++)
+		{
+			f32 noiseX = noiseSize.x * static_cast<f32>(x) / (resolution - 1);
+			f32 noiseY = noiseSize.y * static_cast<f32>(y) / (resolution - 1);
+
+			auto color = noise(noisePosition.x + noiseX, noisePosition.y + noiseY);
+
+			u64 index = (y * resolution + x) * 4;
+			data.pixels[index + 3] = color.a; // a
+			data.pixels[index + 2] = color.r; // r
+			data.pixels[index + 1] = color.g; // g
+			data.pixels[index + 0] = color.b; // b
+
+			data.heightGrid.at(x, static_cast<u32>(y)) = color.r;
+		}
+	});
+
+	return !data.isStale();
+}
+
+/*
+ * Evaluates the CPU noise function on the samples of a heightmap generated on the GPU
+ * and logs the largest absolute difference.
+ */
+static void validateGpuHeights(const HeightGrid& heightGrid, glm::vec2 noisePosition, glm::vec2 noiseSize)
+{
+	u32 resolution = heightGrid.getResolution();
+
+	f32 maxError = 0.0f;
+	for (u32 y = 0; y < resolution; y++)
+	{
+		for (u32 x = 0; x < resolution; x++)
+		{
+			f32 noiseX = noiseSize.x * static_cast<f32>(x) / (resolution - 1);
+			f32 noiseY = noiseSize.y * static_cast<f32>(y) / (resolution - 1);
+
+			f32 expected = noiseFunction(noisePosition.x + noiseX, noisePosition.y + noiseY);
+			maxError = std::max(maxError, std::abs(heightGrid.at(x, y) - expected));
+		}
+	}
+
+	if (maxError > GPU_NOISE_TOLERANCE)
+	{
+		VUWARN("GPU heightmap at (%f, %f) differs from the CPU noise by up to %e", noisePosition.x, noisePosition.y, maxError);
+	}
+	else
+	{
+		VUINFO("GPU heightmap at (%f, %f) max abs error: %e", noisePosition.x, noisePosition.y, maxError);
+	}
 }
 
 } // namespace game
@@ -1,8 +1,15 @@
 #pragma once
 #include "vulture/core/Application.h"
+#include "vulture/core/Job.h"
 #include "vulture/scene/Scene.h"
-#include "Tree.h"
-#include "Rock.h"
+#include "vulture/scene/physics/HeightfieldCollisionShape.h"
+#include "PropInstances.h"
+#include "HeightGrid.h"
+#include "TerrainNoiseShader.h"
+
+#include <span>
+#include <atomic>
+#include <functional>
 
 namespace game {
 
@@ -24,28 +31,89 @@ class Terrain;
 class TerrainChunk
 {
 public:
-	TerrainChunk(Terrain* terrain, glm::vec2 position);
+	/**
+	 * @brief Generates the chunk at the given position.
+	 *
+	 * @param terrain The terrain owning the chunk.
+	 * @param slot The index of the chunk, used to find its range of prop instances.
+	 * @param position The position of the chunk, in chunk units.
+	 * @param lod The level of detail, 0 being the most detailed.
+	 */
+	TerrainChunk(Terrain* terrain, u32 slot, glm::vec2 position, u32 lod);
+
+	/**
+	 * @brief Moves the chunk to a new position and level of detail, regenerating its heightmap asynchronously.
+	 * The results of the generations started before this call are discarded.
+	 *
+	 * @param position The new position of the chunk, in chunk units.
+	 * @param lod The new level of detail, 0 being the most detailed.
+	 * @param onFinished Called on the main thread once the generation ends, whether its result is applied or discarded.
+	 */
+	void update(glm::vec2 position, u32 lod, std::function<void()> onFinished);
+
+	/**
+	 * @brief Invalidates the generation in progress, if any.
+	 * The work is interrupted as soon as possible and its result is discarded.
+	 */
+	inline void cancel()
+	{
+		m_UpdateJob.cancel();
+		m_GpuGenerationId++;
+	}
 
-	void update(glm::vec2 position);
+	/**
+	 * @brief Applies the heightmaps generated on the GPU that are ready, without blocking.
+	 * Called every frame when the terrain is generated on the GPU.
+	 */
+	void pollGpuGenerations();
+
+	inline const HeightGrid& getHeightGrid() const { return m_HeightGrid; }
+
+	inline u32 getLod() const { return m_Lod; }
+	inline void setLod(u32 lod) { m_Lod = lod; }
 
 	~TerrainChunk();
 private:
 	Scene* m_Scene = nullptr;
 	Terrain* m_Terrain;
+	u32 m_Slot;
+	u32 m_Lod = 0;
+	JobHandle m_UpdateJob;
+
+	// A heightmap being generated on the GPU, applied once read back if no newer update was requested meanwhile.
+	struct GpuGeneration
+	{
+		Ref<PendingTexture> heightmap;
+		glm::vec2 position;
+		u32 lod;
+		u32 id;
+		std::function<void()> onFinished;
+	};
 
-	Ref<Tree> m_Tree;
-	Ref<Rock> m_Rock;
+	// In submission order, which is the order of completion.
+	std::vector<GpuGeneration> m_GpuGenerations;
+	u32 m_GpuGenerationId = 0;
 
 	Ref<Texture> m_NoiseTexture;
 	Ref<TextureSampler> m_NoiseSampler;
+	HeightGrid m_HeightGrid;
 
 	Uniform<ModelBufferObject> m_Uniform;
 	Ref<DescriptorSet> m_DescriptorSet;
 	ObjectHandle m_Object;
 
-	void updateRenderingComponents(const Ref<Texture>& texture, glm::vec2 position);
+	// The static collider of the ground, made of the heights of m_HeightGrid.
+	Ref<HeightfieldCollisionShape> m_Heightfield;
+	Ref<HitBox> m_Hitbox;
 
-	glm::vec3 getPropPosition(size_t seed);
+	void updateRenderingComponents(const Ref<Texture>& texture, HeightGrid&& heightGrid, glm::vec2 position, u32 lod);
+	void updateCollider();
+
+	/**
+	 * @brief Places the props of the chunk on a Poisson-disk distribution, deterministic for a given position.
+	 * Props falling in the water are hidden.
+	 */
+	void scatterProps(glm::vec2 position);
 };
 
 struct TerrainGenerationConfig
@@ -55,6 +123,33 @@ struct TerrainGenerationConfig
 	f32 noiseScale = 3.0f;
 	f32 heightScale = 50.0f;
 
+	/**
+	 * Distances from the reference position beyond which chunks switch to the next, coarser, level of detail.
+	 * Every level halves the resolution of the chunk mesh and heightmap. The values must be increasing.
+	 */
+	std::vector<f32> lodDistances = { 150.0f, 300.0f };
+
+	// Maximum number of chunks generated at the same time. Pending chunks wait in order of distance.
+	u32 maxChunksInFlight = 4;
+
+	/**
+	 * Generates the heightmaps with a compute shader instead of the worker threads.
+	 * The heights are read back once the GPU is done, which is checked every frame without waiting.
+	 */
+	bool useGpuGeneration = false;
+
+	/**
+	 * Evaluates the CPU noise function on every heightmap generated on the GPU and logs the largest difference.
+	 * Slow, meant to check the compute shader against the CPU reference on a new driver.
+	 */
+	bool validateGpuGeneration = false;
+
+	// Number of props scattered on every chunk. All the props of a type are drawn with a single instanced draw call.
+	u32 treesPerChunk = 6;
+	u32 rocksPerChunk = 3;
+	// Minimum distance between two props. Half of it is kept from the chunk borders, so that it holds across chunks.
+	f32 propMinDistance = 8.0f;
+
 	static TerrainGenerationConfig defaultConfig;
 };
 
@@ -76,13 +171,41 @@ public:
 	bool isWater(glm::vec2 position) const;
 	bool isWater(f32 x, f32 y) const { return isWater({ x, y }); }
 
+	/**
+	 * @brief Computes the terrain height for a batch of positions.
+	 *
+	 * @param positions The positions to query.
+	 * @param heights The output heights, must be at least as long as positions.
+	 */
+	void getHeightsAt(std::span<const glm::vec2> positions, std::span<f32> heights) const;
+
+	/**
+	 * @brief Gets the number of chunks waiting to be generated.
+	 */
+	inline u32 getPendingChunksCount() const { return static_cast<u32>(m_PendingChunks.size()); }
+
+	/**
+	 * @brief Gets the number of chunks currently being generated.
+	 */
+	inline u32 getChunksInFlightCount() const { return *m_ChunksInFlight; }
+
 	friend class TerrainChunk;
 private:
 	Scene* m_Scene = nullptr;
 	Ref<DescriptorSetLayout> m_DescriptorSetLayout;
 	PipelineHandle m_Pipeline;
-	Ref<Model> m_Model;
+	std::vector<Ref<Model>> m_LodModels;
 	Uniform<TerrainVertexBufferObject> m_VertexUniform;
+	// Only set when the heightmaps are generated on the GPU.
+	Ref<TerrainNoiseShader> m_NoiseShader;
+
+	Ref<DescriptorSetLayout> m_PropDescriptorSetLayout;
+	PipelineHandle m_PropPipeline;
+	PipelineHandle m_LeavesPipeline;
+	// Every chunk owns a contiguous range of instances, starting at slot * propsPerChunk.
+	Ref<PropInstances> m_TreeTrunks;
+	Ref<PropInstances> m_TreeLeaves;
+	Ref<PropInstances> m_Rocks;
 
 	Ref<Texture> m_WaterTexture;
 	Ref<TextureSampler> m_WaterSampler;
@@ -102,8 +225,56 @@ private:
 	std::vector<Ref<TerrainChunk>> m_Chunks;
 	glm::vec2 m_ReferencePosition = { 0, 0 };
 
+	struct ChunkRequest
+	{
+		Ref<TerrainChunk> chunk;
+		glm::vec2 position;
+		u32 lod;
+	};
+
+	std::vector<ChunkRequest> m_PendingChunks;
+	// Shared with the completion callbacks, whose cleanups can still run after the terrain is destroyed.
+	Ref<u32> m_ChunksInFlight = makeRef<u32>(0);
+
 	void initializeRenderingComponents();
 	void initializeChunks();
+	void initializeProps();
+
+	/**
+	 * @brief Computes the level of detail of a chunk.
+	 *
+	 * @param chunkPosition The position of the chunk, in chunk units.
+	 * @param referenceChunk The position of the chunk containing the reference position, in chunk units.
+	 */
+	u32 getChunkLod(glm::vec2 chunkPosition, glm::vec2 referenceChunk) const;
+
+	/**
+	 * @brief Schedules the generation of a chunk at a new position, replacing the previous request for the same chunk.
+	 */
+	void requestChunkUpdate(const Ref<TerrainChunk>& chunk, glm::vec2 position, u32 lod);
+
+	/**
+	 * @brief Starts the generation of the pending chunks closest to the reference position.
+	 */
+	void dispatchPendingChunks();
+
+	/**
+	 * @brief Finds the height grid of the loaded chunk containing the position.
+	 *
+	 * @return The grid, or nullptr if the chunk is not loaded yet.
+	 */
+	const HeightGrid* findHeightGrid(glm::vec2 position) const;
+
+	/**
+	 * @brief Gets the raw noise value at a world position, using the chunks' height grids
+	 * when available and evaluating the noise function otherwise.
+	 */
+	f32 getNoiseAt(glm::vec2 position) const;
+
+	inline f32 noiseToHeight(f32 noise) const
+	{
+		return std::clamp(noise, m_VertexUniform->waterLevel, 1.0f) * m_VertexUniform->scale;
+	}
 };
 
 } // namespace game
@@ -0,0 +1,40 @@
+#include "TerrainNoise.h"
+
+#include "stb_perlin.h"
+
+#include <cmath>
+
+namespace game {
+
+static i32 terrainNoiseSeed = 0;
+
+void setTerrainNoiseSeed(i32 seed)
+{
+	terrainNoiseSeed = seed;
+}
+
+i32 getTerrainNoiseSeed()
+{
+	return terrainNoiseSeed;
+}
+
+f32 noiseFunction(f32 x, f32 y)
+{
+	f32 h = stb_perlin_noise3_seed(x, y, 0.0f, 0, 0, 0, terrainNoiseSeed);
+	h += stb_perlin_ridge_noise3(x, y, 0.0f, 2.0f, 0.5f, 1.0f, 4) * 0.5f;
+	h += 1.5f;
+	h /= 3.0f;
+	h = 0.5f - 4.0f * std::pow(0.5f - h, 3.0f);
+	return h * h;
+}
+
+glm::vec4 noise(f32 x, f32 y)
+{
+	constexpr f32 epsilon = 0.01f;
+	f32 h0 = noiseFunction(x, y);
+	f32 hx = noiseFunction(x + epsilon, y);
+	f32 hy = noiseFunction(x, y + epsilon);
+	return glm::vec4(h0, hx, hy, epsilon);
+}
+
+} // namespace game
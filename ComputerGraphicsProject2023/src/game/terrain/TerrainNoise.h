@@ -0,0 +1,36 @@
+#pragma once
+
+#include "vulture/core/Core.h"
+#include "vulture/util/Types.h"
+
+namespace game {
+
+using namespace vulture;
+
+// Largest difference between the heights generated on the GPU and the CPU noise, in noise units.
+static constexpr f32 GPU_NOISE_TOLERANCE = 1e-4f;
+
+/**
+ * @brief Sets the seed of the terrain noise, before any heightmap is generated.
+ */
+void setTerrainNoiseSeed(i32 seed);
+
+i32 getTerrainNoiseSeed();
+
+/**
+ * @brief Evaluates the terrain noise on the CPU. The TerrainNoise compute shader reproduces it on the GPU.
+ *
+ * @param x The x coordinate in noise space.
+ * @param y The y coordinate in noise space.
+ * @return The noise value, between 0 and 1.
+ */
+f32 noiseFunction(f32 x, f32 y);
+
+/**
+ * @brief Evaluates the terrain noise at a point and at two close points along the axes, to compute the normals.
+ *
+ * @return The noise at (x, y), at (x + epsilon, y), at (x, y + epsilon), and epsilon.
+ */
+glm::vec4 noise(f32 x, f32 y);
+
+} // namespace game
@@ -0,0 +1,70 @@
+#include "TerrainNoiseShader.h"
+
+#include <cstring>
+
+void stb_perlin_get_tables(unsigned char randtab[512], unsigned char gradIdx[512]);
+
+namespace game {
+
+static constexpr u32 WORK_GROUP_SIZE = 16;
+
+TerrainNoiseShader::TerrainNoiseShader(i32 seed) :
+	// The CPU noise only uses the lowest byte of the seed.
+	m_Seed(static_cast<u8>(seed)), m_DescriptorPool(1), m_Tables(1)
+{
+	unsigned char randtab[512];
+	unsigned char gradIdx[512];
+	stb_perlin_get_tables(randtab, gradIdx);
+
+	std::memcpy(m_Tables->randtab, randtab, sizeof(randtab));
+	std::memcpy(m_Tables->gradIdx, gradIdx, sizeof(gradIdx));
+
+	m_DescriptorSetLayout = makeRef<DescriptorSetLayout>();
+	// Perlin Tables
+	m_DescriptorSetLayout->addBinding(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT);
+	m_DescriptorSetLayout->create();
+
+	m_DescriptorSet = m_DescriptorPool.getDescriptorSet(m_DescriptorSetLayout, { m_Tables });
+	m_DescriptorSet->map(0);
+
+	m_Pipeline = makeRef<ComputePipeline>("res/shaders/TerrainNoise_comp.spv",
+		std::vector<DescriptorSetLayout*>{ Texture::getStorageImageLayout().get(), m_DescriptorSetLayout.get() },
+		static_cast<u32>(sizeof(NoiseParameters)));
+}
+
+Ref<PendingTexture> TerrainNoiseShader::generate(glm::vec2 noisePosition, glm::vec2 noiseSize, u32 resolution)
+{
+	NoiseParameters parameters{};
+	parameters.position = noisePosition;
+	parameters.size = noiseSize;
+	parameters.resolution = resolution;
+	parameters.seed = m_Seed;
+
+	TextureComputeInfo computeInfo{};
+	computeInfo.pipeline = m_Pipeline.get();
+	computeInfo.descriptorSet = m_DescriptorSet.get();
+	computeInfo.pushConstants = &parameters;
+	computeInfo.pushConstantsSize = static_cast<u32>(sizeof(parameters));
+	computeInfo.workGroupSize = WORK_GROUP_SIZE;
+
+	return Texture::generate(resolution, resolution, computeInfo, true);
+}
+
+void TerrainNoiseShader::readHeights(const PendingTexture& heightmap, HeightGrid& heightGrid)
+{
+	u32 resolution = heightGrid.getResolution();
+
+	m_Readback.resize(static_cast<u64>(resolution) * resolution * 4);
+	heightmap.read(m_Readback.data());
+
+	// The height is stored in the third value of every pixel, as done by the CPU generation.
+	for (u32 y = 0; y < resolution; y++)
+	{
+		for (u32 x = 0; x < resolution; x++)
+		{
+			heightGrid.at(x, y) = m_Readback[(static_cast<u64>(y) * resolution + x) * 4 + 2];
+		}
+	}
+}
+
+} // namespace game
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "vulture/renderer/Renderer.h"
+#include "HeightGrid.h"
+
+#include <vector>
+
+namespace game {
+
+using namespace vulture;
+
+/**
+ * @brief Generates the terrain heightmaps on the GPU with a compute shader.
+ *
+ * The shader reproduces the noise function evaluated on the CPU, so the generated heights
+ * match the CPU ones within floating point tolerance.
+ */
+class TerrainNoiseShader
+{
+public:
+	NO_COPY(TerrainNoiseShader)
+
+	/**
+	 * @brief Creates the compute pipeline and uploads the noise permutation tables.
+	 *
+	 * @param seed The seed of the noise, the same given to the CPU noise function.
+	 */
+	explicit TerrainNoiseShader(i32 seed);
+
+	/**
+	 * @brief Starts the generation of the heightmap of a region, without waiting for the GPU.
+	 *
+	 * @param noisePosition The position of the region in noise space.
+	 * @param noiseSize The size of the region in noise space.
+	 * @param resolution The number of samples along each side of the heightmap.
+	 * @return The heightmap texture being generated, with the same layout as the one generated on the CPU.
+	 */
+	Ref<PendingTexture> generate(glm::vec2 noisePosition, glm::vec2 noiseSize, u32 resolution);
+
+	/**
+	 * @brief Copies the heights of a generated heightmap into a grid.
+	 *
+	 * @param heightmap A heightmap returned by generate, which must be ready.
+	 * @param heightGrid The grid receiving the heights, with the resolution of the heightmap.
+	 */
+	void readHeights(const PendingTexture& heightmap, HeightGrid& heightGrid);
+private:
+	// Tables of 512 bytes packed in std140 arrays of uvec4.
+	struct PerlinTables
+	{
+		alignas(16) u32 randtab[128];
+		alignas(16) u32 gradIdx[128];
+	};
+
+	struct NoiseParameters
+	{
+		glm::vec2 position;
+		glm::vec2 size;
+		u32 resolution;
+		u32 seed;
+	};
+
+	u32 m_Seed;
+	Ref<DescriptorSetLayout> m_DescriptorSetLayout;
+	DescriptorPool m_DescriptorPool;
+	Uniform<PerlinTables> m_Tables;
+	Ref<DescriptorSet> m_DescriptorSet;
+	Ref<ComputePipeline> m_Pipeline;
+
+	std::vector<f32> m_Readback;
+};
+
+} // namespace game
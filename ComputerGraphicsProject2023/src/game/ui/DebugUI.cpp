@@ -1,5 +1,7 @@
 #include "DebugUI.h"
 
+#include "vulture/core/Job.h"
+
 using namespace vulture;
 
 namespace game {
@@ -20,15 +22,21 @@ DebugUI::DebugUI()
 	m_FPSText = m_UIHandler->makeText("FPS");
 	m_FrameTimeText = m_UIHandler->makeText("FT");
 	m_GodmodeText = m_UIHandler->makeText("GOD: OFF");
+	m_JobsText = m_UIHandler->makeText("JOBS");
+	m_JobOverrunsText = m_UIHandler->makeText("JOB OVERRUNS");
 
 	m_FPSText->setColor(0.0f, 0.0f, 0.0f);
 	m_FrameTimeText->setColor(0.0f, 0.0f, 0.0f);
 	m_GodmodeText->setColor(0.0f, 0.0f, 0.0f);
+	m_JobsText->setColor(0.0f, 0.0f, 0.0f);
+	m_JobOverrunsText->setColor(0.0f, 0.0f, 0.0f);
 
 	m_Visible = false;
 	m_FPSText->setVisible(m_Visible);
 	m_FrameTimeText->setVisible(m_Visible);
 	m_GodmodeText->setVisible(m_Visible);
+	m_JobsText->setVisible(m_Visible);
+	m_JobOverrunsText->setVisible(m_Visible);
 
 	setTextPosition();
 }
@@ -41,6 +49,8 @@ void DebugUI::update(float dt)
 		m_FPSText->setVisible(m_Visible);
 		m_FrameTimeText->setVisible(m_Visible);
 		m_GodmodeText->setVisible(m_Visible);
+		m_JobsText->setVisible(m_Visible);
+		m_JobOverrunsText->setVisible(m_Visible);
 	}
 
 	static float fps = 0.0f;
@@ -57,6 +67,10 @@ void DebugUI::update(float dt)
 		m_FPSText->setText(stringFormat("FPS: %.0f", fps));
 		m_FrameTimeText->setText(stringFormat("FT: %.3fms", dt * 1000));
 
+		auto jobStats = Job::getStats();
+		m_JobsText->setText(stringFormat("JOBS: %llu Q, %llu CL", jobStats.queuedJobs, jobStats.pendingCleanups));
+		m_JobOverrunsText->setText(stringFormat("JOB OVERRUNS: %llu", jobStats.budgetOverruns));
+
 		delta -= WRITE_FPS_TIMEOUT;
 	}
 }
@@ -69,6 +83,8 @@ void DebugUI::setTextPosition()
 	m_FPSText->setPosition(rightOffset, topOffset);
 	m_FrameTimeText->setPosition(rightOffset,m_FPSText->getPosition().y + topOffset);
 	m_GodmodeText->setPosition(rightOffset, m_FrameTimeText->getPosition().y + topOffset);
+	m_JobsText->setPosition(rightOffset, m_GodmodeText->getPosition().y + topOffset);
+	m_JobOverrunsText->setPosition(rightOffset, m_JobsText->getPosition().y + topOffset);
 }
 
 } // namespace game
@@ -25,6 +25,8 @@ private:
 	Ref<UIText> m_FPSText;
 	Ref<UIText> m_FrameTimeText;
 	Ref<UIText> m_GodmodeText;
+	Ref<UIText> m_JobsText;
+	Ref<UIText> m_JobOverrunsText;
 
 	void setTextPosition();
 };
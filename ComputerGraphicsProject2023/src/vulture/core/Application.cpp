@@ -16,7 +16,7 @@ Application::Application(Game& game, AppConfig config) :
 	m_Game(&game)
 {
 	DEBUG_TIMER("Application creation");
-	if (!Job::init())
+	if (!Job::init(config.jobs))
 	{
 		throw std::runtime_error("Unable to initialize the Job System.");
 	}
@@ -31,7 +31,7 @@ Application::Application(Game& game, AppConfig config) :
 		throw std::runtime_error("Unable to initialize the Audio Engine.");
 	}
 
-	m_Scene = makeRef<Scene>();
+	m_Scene = makeRef<Scene>(config.broadphase);
 }
 
 void Application::run()
@@ -6,6 +6,7 @@
 
 #include "vulture/core/Game.h"
 #include "vulture/core/Core.h"
+#include "vulture/core/Job.h"
 
 #include "vulture/renderer/Window.h"
 #include "vulture/renderer/Renderer.h"
@@ -18,6 +19,8 @@ struct AppConfig
     const char *name;
     uint32_t width;
     uint32_t height;
+    JobSystemConfig jobs{};
+    BroadphaseType broadphase = BroadphaseType::SPATIAL_HASH_GRID;
 };
 
 class Application
@@ -1,153 +1,1250 @@
 #include "Job.h"
 
 #include "vulture/core/Logger.h"
+#include "vulture/core/WorkStealingDeque.h"
+#include "vulture/util/SystemTimer.h"
 
 #include <algorithm> // std::max
-#include <queue>
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <atomic>
+#include <memory>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
+#include <deque>
 #include <utility>
 
+#if defined(_WIN32)
+// wingdi.h defines ERROR, which would break the logging macros.
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOGDI
+#define NOGDI
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 namespace vulture {
 
+// Counters of the jobs run by a thread, all times in nanoseconds.
+// Every worker has its own, so that they do not bounce between the caches of the workers.
+struct JobCounters
+{
+	std::atomic<u64> executedJobs = 0;
+	std::atomic<u64> waitTime = 0;
+	std::atomic<u64> runTime = 0;
+	std::atomic<u64> maxWaitTime = 0;
+	std::atomic<u64> maxRunTime = 0;
+
+	void add();
+	void add(u64 wait, u64 run);
+	void reset();
+};
+
 class Worker
 {
 public:
-	Worker();
+	Worker(u32 index, JobQueue queue, u64 affinity, bool lowPriority);
 
+	void start();
 	void stop();
+	void join();
 
 	int operator()(const std::stop_token&);
+
+	inline u32 getIndex() const { return m_Index; }
+	inline JobQueue getQueue() const { return m_Queue; }
+
+	friend class Job;
 private:
+	u32 m_Index;
+	JobQueue m_Queue;
+	u64 m_Affinity;
+	bool m_LowPriority;
+	WorkStealingDeque<Job*> m_Jobs; // Only used by the compute workers.
 	std::jthread m_Thread;
+
+	void runComputeJobs(const std::stop_token& stopToken);
+	void runIOJobs(const std::stop_token& stopToken);
+
+	// Written by the worker, read by the thread collecting the metrics.
+	JobCounters m_Counters;
+};
+
+struct TraceEvent
+{
+	const char* name;
+	u64 id;
+	u64 start;
+	u64 duration;
+	u64 wait;
+};
+
+// Spans recorded by a thread while tracing.
+struct TraceBuffer
+{
+	std::mutex mutex;
+	std::vector<TraceEvent> events;
+	u32 threadId = 0;
+	std::string threadName;
+};
+
+static std::vector<std::unique_ptr<Worker>> workers;
+static std::vector<std::unique_ptr<Worker>> ioWorkers;
+static std::atomic<bool> running = false;
+static std::thread::id mainThreadId;
+
+// The compute worker running on the current thread, nullptr on any other thread.
+static thread_local Worker* currentWorker = nullptr;
+// The I/O worker running on the current thread, nullptr on any other thread.
+static thread_local Worker* currentIOWorker = nullptr;
+// The job whose work or cleanup is running on the current thread.
+static thread_local Job* currentJob = nullptr;
+
+// Jobs submitted from outside the workers.
+// The queue is consumed from injectionQueueHead and compacted instead of being reallocated.
+static std::mutex injectionQueueMutex;
+static std::vector<Job*> injectionQueue;
+static u64 injectionQueueHead = 0;
+static constexpr u64 INJECTION_BATCH_SIZE = 32;
+
+// Number of jobs submitted but not yet picked up by a worker.
+// It is incremented before the job is queued, so that a worker never sleeps while a job is queued.
+static std::atomic<i64> pendingJobsCount = 0;
+
+// Threads blocked in JobHandle::wait, which have to be notified when a job is done.
+static std::atomic<u32> blockedWaitersCount = 0;
+
+// Bumped to wake the sleeping workers, which wait for it to change.
+static std::atomic<u32> wakeSignal = 0;
+static std::atomic<u32> sleepingWorkersCount = 0;
+// Set while a woken worker has not yet looked for jobs, so that a burst of submissions wakes it only once.
+static std::atomic<bool> wakingWorker = false;
+
+// Jobs waiting for an I/O worker. They are expected to block, so they are simply served in order.
+static std::mutex ioQueueMutex;
+static std::condition_variable ioConditionVariable;
+static std::deque<Job*> ioQueue;
+
+// Lock-free list of the jobs whose cleanup has to run on the main thread.
+// Workers push at the head, the main thread detaches the whole list at once, so there is no ABA problem.
+static std::atomic<Job*> jobsCompleted = nullptr;
+
+// Cleanups waiting to be run on the main thread, one queue for each priority, each sorted by submission.
+// The queues are consumed from their head and compacted instead of being reallocated.
+struct CleanupQueue
+{
+	std::vector<Job*> jobs;
+	u64 head = 0;
+
+	inline bool isEmpty() const { return head == jobs.size(); }
+	inline u64 getSize() const { return jobs.size() - head; }
+
+	void insert(Job* job);
+};
+
+static std::array<CleanupQueue, 3> cleanupQueues;
+static f32 processBudget = Job::DEFAULT_PROCESS_BUDGET;
+static JobStats processStats;
+static std::atomic<u64> submissionsCount = 0;
+
+// Metrics, all times in nanoseconds.
+static std::atomic<u64> metricsStartTime = 0;
+static std::atomic<u64> metricsFirstSubmission = 0;
+static std::atomic<bool> metricsEnabled = false;
+// The jobs run by the threads other than the workers, while they wait for other jobs.
+static JobCounters externalCounters;
+
+static std::atomic<bool> tracing = false;
+static std::atomic<u64> traceStartTime = 0;
+static std::mutex traceBuffersMutex;
+static std::vector<std::unique_ptr<TraceBuffer>> traceBuffers;
+static thread_local TraceBuffer* currentTraceBuffer = nullptr;
+
+static u64 getTime()
+{
+	using namespace std::chrono;
+	return static_cast<u64>(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+}
+
+// Whether the jobs have to be timed, for the metrics or for the trace.
+static bool isTimingJobs()
+{
+	return metricsEnabled.load(std::memory_order_relaxed) || tracing.load(std::memory_order_relaxed);
+}
+
+static void updateMax(std::atomic<u64>& max, u64 value)
+{
+	u64 current = max.load(std::memory_order_relaxed);
+	while (value > current && !max.compare_exchange_weak(current, value, std::memory_order_relaxed));
+}
+
+void JobCounters::add()
+{
+	executedJobs.fetch_add(1, std::memory_order_relaxed);
+}
+
+void JobCounters::add(u64 wait, u64 run)
+{
+	executedJobs.fetch_add(1, std::memory_order_relaxed);
+	waitTime.fetch_add(wait, std::memory_order_relaxed);
+	runTime.fetch_add(run, std::memory_order_relaxed);
+	updateMax(maxWaitTime, wait);
+	updateMax(maxRunTime, run);
+}
+
+void JobCounters::reset()
+{
+	executedJobs = 0;
+	waitTime = 0;
+	runTime = 0;
+	maxWaitTime = 0;
+	maxRunTime = 0;
+}
+
+static void recordTraceEvent(const char* name, u64 id, u64 start, u64 end, u64 wait)
+{
+	if (!tracing.load(std::memory_order_relaxed)) return;
+
+	if (!currentTraceBuffer)
+	{
+		std::scoped_lock lock{ traceBuffersMutex };
+		traceBuffers.push_back(std::make_unique<TraceBuffer>());
+		currentTraceBuffer = traceBuffers.back().get();
+		currentTraceBuffer->threadId = static_cast<u32>(traceBuffers.size() - 1);
+		if (currentWorker)
+			currentTraceBuffer->threadName = "Worker " + std::to_string(currentWorker->getIndex());
+		else if (currentIOWorker)
+			currentTraceBuffer->threadName = "I/O worker " + std::to_string(currentIOWorker->getIndex());
+		else
+			currentTraceBuffer->threadName = "Main thread";
+	}
+
+	std::scoped_lock lock{ currentTraceBuffer->mutex };
+	currentTraceBuffer->events.push_back({ name, id, start, end - start, wait });
+}
+
+// Applies the affinity and the priority of a worker to the calling thread.
+static void configureCurrentThread(u64 affinity, bool lowPriority)
+{
+#if defined(_WIN32)
+	if (affinity != 0 && !SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(affinity)))
+	{
+		VUWARN("Unable to set the affinity of a job worker.");
+	}
+	if (lowPriority && !SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL))
+	{
+		VUWARN("Unable to lower the priority of a job worker.");
+	}
+#elif defined(__linux__)
+	if (affinity != 0)
+	{
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		for (u32 cpu = 0; cpu < 64; cpu++)
+		{
+			if (affinity & (1ULL << cpu)) CPU_SET(cpu, &set);
+		}
+		if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0)
+		{
+			VUWARN("Unable to set the affinity of a job worker.");
+		}
+	}
+	// On Linux the nice value applies to the single thread.
+	if (lowPriority && setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 10) != 0)
+	{
+		VUWARN("Unable to lower the priority of a job worker.");
+	}
+#else
+	(void)affinity;
+	(void)lowPriority;
+#endif
+}
+
+
+// Recycled jobs. Each thread keeps a small cache and exchanges batches with the shared pool.
+static constexpr u64 JOB_POOL_BATCH_SIZE = 32;
+
+static std::mutex jobPoolMutex;
+static std::vector<Job*> jobPool;
+
+struct JobPoolCache
+{
+	std::vector<Job*> jobs;
+
+	// A cache never holds more than two batches, so it does not allocate once the thread is running.
+	JobPoolCache() { jobs.reserve(2 * JOB_POOL_BATCH_SIZE); }
+
+	~JobPoolCache()
+	{
+		std::scoped_lock lock{ jobPoolMutex };
+		jobPool.insert(jobPool.end(), jobs.begin(), jobs.end());
+	}
 };
 
-static std::vector<Worker> workers;
+static thread_local JobPoolCache jobPoolCache;
 
-static std::mutex jobsQueueMutex;
-static std::condition_variable jobsQueueConditionVariable;
-static std::queue<Job> jobsQueue;
+struct CallbackPayload
+{
+	std::function<bool(void*)> work;
+	void* data;
+	std::function<void(bool, void*)> cleanup;
 
-static std::mutex jobsCompletedMutex;
-static std::vector<Job> jobsCompleted;
+	static bool execute(void* payload)
+	{
+		auto* self = static_cast<CallbackPayload*>(payload);
+		return self->work ? self->work(self->data) : true;
+	}
 
-void Job::submit(std::function<bool(void*)> jobCallback, void* data, std::function<void(bool, void*)> cleanupCallback)
+	static void finish(void* payload, bool result)
+	{
+		auto* self = static_cast<CallbackPayload*>(payload);
+		if (self->cleanup) self->cleanup(result, self->data);
+	}
+};
+
+JobHandle Job::submit(std::function<bool(void*)> jobCallback, void* data, std::function<void(bool, void*)> cleanupCallback,
+	JobList dependencies, JobPriority priority, JobQueue queue)
 {
+	Job* job = allocate();
+	job->m_HasCleanup = cleanupCallback != nullptr;
+	job->m_Priority = priority;
+	job->m_Queue = queue;
+	job->emplacePayload<CallbackPayload>(std::move(jobCallback), data, std::move(cleanupCallback));
+
+	return enqueue(job, dependencies);
+}
+
+JobHandle Job::enqueue(Job* job, JobList dependencies)
+{
+	job->m_Sequence = submissionsCount.fetch_add(1, std::memory_order_relaxed);
+
+	JobHandle handle(job);
+
+	if (dependencies.size() == 0)
+	{
+		schedule(job);
+		return handle;
+	}
+
+	// The extra dependency prevents the job from being scheduled while the dependencies are being registered.
+	job->m_PendingDependencies.store(static_cast<u32>(dependencies.size()) + 1, std::memory_order_relaxed);
+
+	for (auto& dependency : dependencies)
+	{
+		bool registered = false;
+		if (Job* parent = dependency.m_Job)
+		{
+			std::scoped_lock lock{ parent->m_ContinuationsMutex };
+			if (!parent->m_Done.load(std::memory_order_acquire))
+			{
+				parent->m_Continuations.push_back(job);
+				registered = true;
+			}
+		}
+
+		if (!registered)
+		{
+			job->m_PendingDependencies.fetch_sub(1, std::memory_order_relaxed);
+		}
+	}
+
+	if (job->m_PendingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
 	{
-		std::scoped_lock lock{ jobsQueueMutex };
-		jobsQueue.push(Job(std::move(jobCallback), data, std::move(cleanupCallback)));
+		schedule(job);
 	}
 
-	jobsQueueConditionVariable.notify_one();
+	return handle;
 }
 
-bool Job::init()
+void Job::join(JobList jobs)
 {
-	u32 workersCount = std::max(1, static_cast<i32>(std::jthread::hardware_concurrency()) - 1);
-	workers.resize(workersCount);
+	for (auto& job : jobs)
+	{
+		job.wait();
+	}
+}
 
-	return true;
+void Job::setProcessBudget(f32 milliseconds)
+{
+	processBudget = milliseconds;
 }
 
-void Job::cleanup()
+bool Job::isMainThread()
 {
+	return std::this_thread::get_id() == mainThreadId;
+}
+
+bool Job::isWorkerThread()
+{
+	return currentWorker != nullptr;
+}
+
+bool Job::isIOThread()
+{
+	return currentIOWorker != nullptr;
+}
+
+JobStopToken Job::getStopToken()
+{
+	return currentJob ? JobStopToken(JobHandle(currentJob)) : JobStopToken();
+}
+
+JobMetrics Job::getMetrics()
+{
+	JobMetrics metrics;
+	u64 now = getTime();
+	u64 elapsed = now - metricsStartTime.load(std::memory_order_relaxed);
+	constexpr f64 NS_TO_MS = 1.0 / 1000000.0;
+
+	metrics.submittedJobs = submissionsCount.load(std::memory_order_relaxed) - metricsFirstSubmission.load(std::memory_order_relaxed);
+	metrics.queuedJobs = static_cast<u64>(std::max(pendingJobsCount.load(std::memory_order_relaxed), 0LL));
+
+	u64 waitTime = 0;
+	u64 runTime = 0;
+	auto collectCounters = [&](const JobCounters& counters) {
+		metrics.executedJobs += counters.executedJobs.load(std::memory_order_relaxed);
+		waitTime += counters.waitTime.load(std::memory_order_relaxed);
+		runTime += counters.runTime.load(std::memory_order_relaxed);
+		metrics.maxWaitTime = std::max(metrics.maxWaitTime, static_cast<f64>(counters.maxWaitTime.load(std::memory_order_relaxed)) * NS_TO_MS);
+		metrics.maxRunTime = std::max(metrics.maxRunTime, static_cast<f64>(counters.maxRunTime.load(std::memory_order_relaxed)) * NS_TO_MS);
+	};
+
+	metrics.workers.reserve(workers.size() + ioWorkers.size());
+	auto collectWorkerMetrics = [&](const Worker& worker) {
+		collectCounters(worker.m_Counters);
+
+		WorkerMetrics& workerMetrics = metrics.workers.emplace_back();
+		workerMetrics.queue = worker.getQueue();
+		workerMetrics.executedJobs = worker.m_Counters.executedJobs.load(std::memory_order_relaxed);
+		workerMetrics.busyTime = static_cast<f64>(worker.m_Counters.runTime.load(std::memory_order_relaxed)) * NS_TO_MS;
+		workerMetrics.idleTime = std::max(0.0, static_cast<f64>(elapsed) * NS_TO_MS - workerMetrics.busyTime);
+		f64 total = workerMetrics.busyTime + workerMetrics.idleTime;
+		workerMetrics.utilization = total > 0.0 ? static_cast<f32>(workerMetrics.busyTime / total) : 0.0f;
+	};
 	for (auto& worker : workers)
 	{
-		worker.stop();
+		collectWorkerMetrics(*worker);
 	}
-	jobsQueueConditionVariable.notify_all();
+	for (auto& worker : ioWorkers)
+	{
+		collectWorkerMetrics(*worker);
+	}
+	collectCounters(externalCounters);
 
-	workers.clear();
+	metrics.jobsPerSecond = elapsed > 0 ? static_cast<f64>(metrics.executedJobs) * 1000000000.0 / static_cast<f64>(elapsed) : 0.0;
+	if (metrics.executedJobs > 0)
+	{
+		metrics.averageWaitTime = static_cast<f64>(waitTime) * NS_TO_MS / static_cast<f64>(metrics.executedJobs);
+		metrics.averageRunTime = static_cast<f64>(runTime) * NS_TO_MS / static_cast<f64>(metrics.executedJobs);
+	}
+
+	return metrics;
 }
 
-void Job::process()
+void Job::resetMetrics()
 {
-	std::scoped_lock lock{ jobsCompletedMutex };
+	metricsStartTime = getTime();
+	metricsFirstSubmission = submissionsCount.load(std::memory_order_relaxed);
+	externalCounters.reset();
 
-	for (auto& job : jobsCompleted)
+	for (auto* pool : { &workers, &ioWorkers })
 	{
-		job.cleanupExecute();
+		for (auto& worker : *pool)
+		{
+			worker->m_Counters.reset();
+		}
 	}
+}
 
-	jobsCompleted.clear();
+void Job::setMetricsEnabled(bool enabled)
+{
+	metricsEnabled = enabled;
 }
 
-Job::Job() :
-	Job(nullptr, nullptr, nullptr)
-{}
+void Job::beginTrace()
+{
+	std::scoped_lock lock{ traceBuffersMutex };
+	for (auto& buffer : traceBuffers)
+	{
+		std::scoped_lock bufferLock{ buffer->mutex };
+		buffer->events.clear();
+	}
 
-Job::Job(std::function<bool(void*)> workCallback, void* data, std::function<void(bool, void*)> cleanupCallback) :
-	m_WorkCallback(std::move(workCallback)), m_CleanupCallback(std::move(cleanupCallback)), m_Data(data)
-{}
+	traceStartTime = getTime();
+	tracing = true;
+}
 
-void Job::execute()
+bool Job::endTrace(const String& path)
 {
-	if (m_WorkCallback)
+	tracing = false;
+
+	std::ofstream file(path.cString());
+	if (!file.is_open())
+	{
+		VUERROR("Unable to write the job trace to %s.", path.cString());
+		return false;
+	}
+
+	u64 startTime = traceStartTime.load();
+	bool first = true;
+
+	file << "{\"traceEvents\":[";
+	std::scoped_lock lock{ traceBuffersMutex };
+	for (auto& buffer : traceBuffers)
 	{
-		try
+		std::scoped_lock bufferLock{ buffer->mutex };
+
+		file << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << buffer->threadId
+			<< ",\"args\":{\"name\":\"" << buffer->threadName << "\"}}";
+		first = false;
+
+		for (auto& event : buffer->events)
 		{
-			m_Result = m_WorkCallback(m_Data);
+			if (event.start < startTime) continue;
+
+			// Chrome traces use microseconds.
+			file << (first ? "" : ",") << "\n{\"name\":\"" << event.name << "\",\"cat\":\"job\",\"ph\":\"X\""
+				<< ",\"ts\":" << static_cast<f64>(event.start - startTime) / 1000.0
+				<< ",\"dur\":" << static_cast<f64>(event.duration) / 1000.0
+				<< ",\"pid\":0,\"tid\":" << buffer->threadId
+				<< ",\"args\":{\"id\":" << event.id << ",\"wait_us\":" << static_cast<f64>(event.wait) / 1000.0 << "}}";
+			first = false;
 		}
-		catch (const std::exception&)
+		buffer->events.clear();
+	}
+	file << "\n]}\n";
+
+	return file.good();
+}
+
+JobStats Job::getStats()
+{
+	JobStats stats = processStats;
+	stats.queuedJobs = static_cast<u64>(std::max(pendingJobsCount.load(std::memory_order_relaxed), 0LL));
+	return stats;
+}
+
+u32 Job::getParallelism()
+{
+	return std::min(static_cast<u32>(workers.size()) + 1, MAX_PARALLEL_FOR_PARTICIPANTS);
+}
+
+void Job::joinHelpers(std::span<const JobHandle> helpers)
+{
+	for (auto& helper : helpers)
+	{
+		Job* job = helper.m_Job;
+
+		// The range is done, so a helper that has not started is taken back and skipped by the worker.
+		if (!job->m_Claimed.exchange(true, std::memory_order_acq_rel)) continue;
+
+		// The others are finishing their last chunk. Running other jobs meanwhile could delay the caller
+		// behind unrelated work, so the thread blocks instead.
+		while (!job->m_Done.load(std::memory_order_acquire))
 		{
-			m_Result = false;
+			blockedWaitersCount.fetch_add(1, std::memory_order_seq_cst);
+			job->m_Done.wait(false, std::memory_order_seq_cst);
+			blockedWaitersCount.fetch_sub(1, std::memory_order_relaxed);
 		}
 	}
+}
+
+void Job::schedule(Job* job)
+{
+	job->m_ScheduleTime = isTimingJobs() ? getTime() : 0;
+
+	if (job->m_Queue == JobQueue::IO)
+	{
+		if (!ioWorkers.empty())
+		{
+			{
+				std::scoped_lock lock{ ioQueueMutex };
+				ioQueue.push_back(job);
+			}
+			ioConditionVariable.notify_one();
+			return;
+		}
+
+		// Without I/O workers the job is run as any other.
+		job->m_Queue = JobQueue::COMPUTE;
+	}
+
+	pendingJobsCount.fetch_add(1, std::memory_order_seq_cst);
+
+	if (currentWorker)
+	{
+		currentWorker->m_Jobs.push(job);
+	}
 	else
-		m_Result = true;
+	{
+		std::scoped_lock lock{ injectionQueueMutex };
+		if (injectionQueueHead > 0 && injectionQueueHead * 2 >= injectionQueue.size())
+		{
+			injectionQueue.erase(injectionQueue.begin(), injectionQueue.begin() + static_cast<i64>(injectionQueueHead));
+			injectionQueueHead = 0;
+		}
+		injectionQueue.push_back(job);
+	}
+
+	wakeWorker();
 }
 
-void Job::cleanupExecute()
+void Job::run(Job* job)
+{
+	if (job->m_Queue == JobQueue::COMPUTE)
+	{
+		pendingJobsCount.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	bool timed = isTimingJobs();
+	u64 start = timed ? getTime() : 0;
+	if (job->m_Revocable && job->m_Claimed.exchange(true, std::memory_order_acq_rel))
+		job->m_Result = false; // Taken back by the caller of the parallelFor.
+	else if (job->m_Cancelled.load(std::memory_order_relaxed))
+		job->m_Result = false;
+	else
+		job->execute();
+
+	Worker* worker = currentWorker ? currentWorker : currentIOWorker;
+	JobCounters& counters = worker ? worker->m_Counters : externalCounters;
+	if (timed)
+	{
+		u64 end = getTime();
+		// Jobs scheduled before the timing was enabled have no schedule time.
+		u64 wait = job->m_ScheduleTime > 0 && start > job->m_ScheduleTime ? start - job->m_ScheduleTime : 0;
+		counters.add(wait, end - start);
+		recordTraceEvent("Job", job->m_Sequence, start, end, wait);
+	}
+	else
+	{
+		counters.add();
+	}
+
+	finish(job);
+}
+
+void Job::finish(Job* job)
 {
-	if (m_CleanupCallback)
+	// Without handles nobody can add a continuation or wait for the job, so there is nothing to synchronize with.
+	if (job->m_ReferenceCount.load(std::memory_order_acquire) == 1)
+	{
+		job->m_Done.store(true, std::memory_order_relaxed);
+	}
+	else
+	{
+		{
+			std::scoped_lock lock{ job->m_ContinuationsMutex };
+			job->m_Done.store(true, std::memory_order_seq_cst);
+		}
+		// Pairs with the increment in JobHandle::wait: either the waiter sees the job done, or the job sees the waiter.
+		// Notifying is not free even without waiters, so it is skipped when nobody is blocked.
+		if (blockedWaitersCount.load(std::memory_order_seq_cst) > 0)
+		{
+			job->m_Done.notify_all();
+		}
+	}
+
+	// No continuation can be added once the job is done.
+	for (Job* continuation : job->m_Continuations)
 	{
-		try
+		if (continuation->m_PendingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
 		{
-			m_CleanupCallback(m_Result, m_Data);
+			schedule(continuation);
 		}
-		catch (const std::exception& e)
+	}
+	job->m_Continuations.clear();
+
+	if (job->m_HasCleanup)
+	{
+		Job* head = jobsCompleted.load(std::memory_order_relaxed);
+		do
+		{
+			job->m_NextCompleted = head;
+		} while (!jobsCompleted.compare_exchange_weak(head, job, std::memory_order_release, std::memory_order_relaxed));
+	}
+	else
+	{
+		job->destroyPayload();
+		job->release();
+	}
+}
+
+void Job::discard(Job* job)
+{
+	// The continuations of a discarded job would never be scheduled.
+	for (Job* continuation : job->m_Continuations)
+	{
+		if (continuation->m_PendingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
 		{
-			VUERROR("Un exception was thrown during job processing.\nMessage: %s.", e.what());
+			discard(continuation);
 		}
 	}
+	job->m_Continuations.clear();
+
+	// The cleanup runs as for a cancelled job, so that it can free the data handed to the work.
+	if (job->m_HasCleanup)
+	{
+		job->m_Cancelled.store(true, std::memory_order_relaxed);
+		job->m_Result = false;
+		job->cleanupExecute();
+	}
+	job->destroyPayload();
+	job->release();
 }
 
-Worker::Worker() :
-	m_Thread(std::bind_front(&Worker::operator(), this))
+bool Job::runPendingJob()
+{
+	Job* job = findJob(currentWorker);
+	if (!job) return false;
+
+	run(job);
+	return true;
+}
+
+void Job::wakeWorker()
+{
+	// Pairs with the increment in Worker::runComputeJobs: either the worker sees the pending job,
+	// or the submitter sees the sleeping worker.
+	if (sleepingWorkersCount.load(std::memory_order_seq_cst) == 0) return;
+	// The worker being woken will find the job, and wakes the next one if there is more work.
+	if (wakingWorker.exchange(true, std::memory_order_seq_cst)) return;
+
+	// A worker that read the signal before this increment does not block, or is woken.
+	wakeSignal.fetch_add(1, std::memory_order_seq_cst);
+	wakeSignal.notify_one();
+}
+
+bool Job::init(const JobSystemConfig& config)
+{
+	u32 workersCount = config.computeWorkers;
+	if (workersCount == 0)
+	{
+		workersCount = std::max(1, static_cast<i32>(std::jthread::hardware_concurrency()) - 1);
+	}
+
+	// All the deques must exist before any worker tries to steal from them.
+	workers.reserve(workersCount);
+	for (u32 i = 0; i < workersCount; i++)
+	{
+		workers.push_back(std::make_unique<Worker>(i, JobQueue::COMPUTE, config.computeAffinity, false));
+	}
+	for (u32 i = 0; i < config.ioWorkers; i++)
+	{
+		ioWorkers.push_back(std::make_unique<Worker>(i, JobQueue::IO, config.ioAffinity, config.lowPriorityIO));
+	}
+
+	for (auto& worker : workers)
+	{
+		worker->start();
+	}
+	for (auto& worker : ioWorkers)
+	{
+		worker->start();
+	}
+
+	resetMetrics();
+
+	mainThreadId = std::this_thread::get_id();
+	running = true;
+	return true;
+}
+
+void Job::cleanup()
+{
+	running = false;
+
+	for (auto& worker : workers)
+	{
+		worker->stop();
+	}
+	for (auto& worker : ioWorkers)
+	{
+		worker->stop();
+	}
+	wakeSignal.fetch_add(1, std::memory_order_seq_cst);
+	wakeSignal.notify_all();
+	{
+		std::scoped_lock lock{ ioQueueMutex };
+	}
+	ioConditionVariable.notify_all();
+
+	for (auto& worker : workers)
+	{
+		worker->join();
+	}
+	for (auto& worker : ioWorkers)
+	{
+		worker->join();
+	}
+	ioWorkers.clear();
+
+	// The jobs left are cancelled, their cleanups are run by discard. Those cleanups can submit new jobs,
+	// which end up in the injection queue now that there are no workers, and are discarded in the next pass.
+	bool discarded = true;
+	while (discarded)
+	{
+		std::vector<Job*> jobs;
+		jobs.insert(jobs.end(), ioQueue.begin(), ioQueue.end());
+		ioQueue.clear();
+
+		for (auto& worker : workers)
+		{
+			while (auto job = worker->m_Jobs.steal())
+			{
+				jobs.push_back(*job);
+			}
+		}
+
+		jobs.insert(jobs.end(), injectionQueue.begin() + static_cast<i64>(injectionQueueHead), injectionQueue.end());
+		injectionQueue.clear();
+		injectionQueueHead = 0;
+
+		// The completed jobs are discarded last, in the order their cleanups would have run.
+		for (Job* job = jobsCompleted.exchange(nullptr, std::memory_order_acquire); job; job = job->m_NextCompleted)
+		{
+			cleanupQueues[static_cast<u64>(job->m_Priority)].insert(job);
+		}
+		for (auto queue = cleanupQueues.rbegin(); queue != cleanupQueues.rend(); queue++)
+		{
+			jobs.insert(jobs.end(), queue->jobs.begin() + static_cast<i64>(queue->head), queue->jobs.end());
+			queue->jobs.clear();
+			queue->head = 0;
+		}
+
+		for (Job* job : jobs)
+		{
+			discard(job);
+		}
+		discarded = !jobs.empty();
+	}
+	workers.clear();
+	pendingJobsCount = 0;
+	processStats = {};
+
+	// The caches of the workers have been returned to the pool when their threads exited.
+	for (Job* job : jobPoolCache.jobs)
+	{
+		delete job;
+	}
+	jobPoolCache.jobs.clear();
+
+	for (Job* job : jobPool)
+	{
+		delete job;
+	}
+	jobPool.clear();
+}
+
+void Job::process()
+{
+	// The list is in reverse order of completion, which is close to the order of submission.
+	Job* completed = nullptr;
+	for (Job* job = jobsCompleted.exchange(nullptr, std::memory_order_acquire); job;)
+	{
+		Job* next = job->m_NextCompleted;
+		job->m_NextCompleted = completed;
+		completed = job;
+		job = next;
+	}
+	for (Job* job = completed; job; job = job->m_NextCompleted)
+	{
+		cleanupQueues[static_cast<u64>(job->m_Priority)].insert(job);
+	}
+
+	SystemTimer timer;
+	f32 elapsed = 0.0f;
+	u64 processedCount = 0;
+	while (true)
+	{
+		// The highest priority first.
+		auto queue = std::find_if(cleanupQueues.rbegin(), cleanupQueues.rend(), [](const CleanupQueue& queue) {
+			return !queue.isEmpty();
+		});
+		if (queue == cleanupQueues.rend()) break;
+
+		Job* job = queue->jobs[queue->head];
+
+		bool outOfBudget = processBudget > 0.0f && elapsed >= processBudget;
+		if (outOfBudget && processedCount > 0 && job->m_Priority != JobPriority::HIGH) break;
+
+		queue->head++;
+
+		bool traced = tracing.load(std::memory_order_relaxed);
+		u64 start = traced ? getTime() : 0;
+		job->cleanupExecute();
+		if (traced) recordTraceEvent("Cleanup", job->m_Sequence, start, getTime(), 0);
+
+		job->destroyPayload();
+		job->release();
+
+		processedCount++;
+		// Without a budget the clock is only read once all the cleanups have run.
+		if (processBudget > 0.0f) elapsed = static_cast<f32>(timer.elapsed(TimeUnit::MICROSECOND)) / 1000.0f;
+	}
+	if (processBudget <= 0.0f) elapsed = static_cast<f32>(timer.elapsed(TimeUnit::MICROSECOND)) / 1000.0f;
+
+	processStats.pendingCleanups = 0;
+	for (auto& queue : cleanupQueues)
+	{
+		processStats.pendingCleanups += queue.getSize();
+	}
+	processStats.processedCleanups = processedCount;
+	processStats.processTime = elapsed;
+	if (processBudget > 0.0f && elapsed > processBudget)
+	{
+		processStats.budgetOverruns++;
+	}
+}
+
+void CleanupQueue::insert(Job* job)
+{
+	if (head > 0 && head * 2 >= jobs.size())
+	{
+		jobs.erase(jobs.begin(), jobs.begin() + static_cast<i64>(head));
+		head = 0;
+	}
+
+	// Jobs mostly complete in the order they were submitted, so the insertion usually stops at once.
+	jobs.push_back(job);
+	for (u64 i = jobs.size() - 1; i > head && jobs[i - 1]->m_Sequence > job->m_Sequence; i--)
+	{
+		std::swap(jobs[i - 1], jobs[i]);
+	}
+}
+
+void Job::execute()
+{
+	// Jobs can be nested when a thread runs other jobs while waiting.
+	Job* previousJob = std::exchange(currentJob, this);
+	try
+	{
+		m_Result = m_Execute(m_Payload);
+	}
+	catch (const std::exception&)
+	{
+		m_Result = false;
+	}
+	currentJob = previousJob;
+
+	// The work may have observed the cancellation and returned early.
+	if (m_Cancelled.load(std::memory_order_relaxed)) m_Result = false;
+}
+
+void Job::cleanupExecute()
+{
+	Job* previousJob = std::exchange(currentJob, this);
+	try
+	{
+		// Cancellations requested after the work completed are reported as well.
+		m_Finish(m_Payload, m_Result && !m_Cancelled.load(std::memory_order_relaxed));
+	}
+	catch (const std::exception& e)
+	{
+		VUERROR("Un exception was thrown during job processing.\nMessage: %s.", e.what());
+	}
+	currentJob = previousJob;
+}
+
+void Job::destroyPayload()
+{
+	if (!m_Payload) return;
+
+	m_Destroy(m_Payload, m_Payload == m_Storage);
+	m_Payload = nullptr;
+}
+
+void Job::acquire()
+{
+	m_ReferenceCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Job::release()
+{
+	if (m_ReferenceCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+	{
+		recycle(this);
+	}
+}
+
+Job* Job::allocate()
+{
+	auto& cache = jobPoolCache.jobs;
+	if (cache.empty())
+	{
+		std::scoped_lock lock{ jobPoolMutex };
+		u64 count = std::min(JOB_POOL_BATCH_SIZE, static_cast<u64>(jobPool.size()));
+		cache.insert(cache.end(), jobPool.end() - static_cast<i64>(count), jobPool.end());
+		jobPool.resize(jobPool.size() - count);
+	}
+
+	if (cache.empty()) return new Job();
+
+	Job* job = cache.back();
+	cache.pop_back();
+	return job;
+}
+
+void Job::recycle(Job* job)
+{
+	job->destroyPayload();
+
+	// Handles released after the shutdown would otherwise leak their jobs.
+	if (!running)
+	{
+		delete job;
+		return;
+	}
+
+	job->m_ReferenceCount.store(1, std::memory_order_relaxed);
+	job->m_PendingDependencies.store(0, std::memory_order_relaxed);
+	job->m_Done.store(false, std::memory_order_relaxed);
+	job->m_Cancelled.store(false, std::memory_order_relaxed);
+	job->m_Claimed.store(false, std::memory_order_relaxed);
+	job->m_HasCleanup = false;
+	job->m_Revocable = false;
+	job->m_Result = false;
+	job->m_Priority = JobPriority::NORMAL;
+	job->m_Queue = JobQueue::COMPUTE;
+
+	auto& cache = jobPoolCache.jobs;
+	cache.push_back(job);
+
+	// Threads that mostly release jobs hand them back to the ones that allocate them.
+	if (cache.size() >= 2 * JOB_POOL_BATCH_SIZE)
+	{
+		std::scoped_lock lock{ jobPoolMutex };
+		jobPool.insert(jobPool.end(), cache.end() - static_cast<i64>(JOB_POOL_BATCH_SIZE), cache.end());
+		cache.resize(cache.size() - JOB_POOL_BATCH_SIZE);
+	}
+}
+
+JobHandle::JobHandle(Job* job) :
+	m_Job(job)
+{
+	if (m_Job) m_Job->acquire();
+}
+
+JobHandle::JobHandle(const JobHandle& other) :
+	JobHandle(other.m_Job)
+{}
+
+JobHandle::JobHandle(JobHandle&& other) noexcept :
+	m_Job(std::exchange(other.m_Job, nullptr))
 {}
 
+JobHandle& JobHandle::operator=(const JobHandle& other)
+{
+	if (this != &other)
+	{
+		if (other.m_Job) other.m_Job->acquire();
+		if (m_Job) m_Job->release();
+		m_Job = other.m_Job;
+	}
+	return *this;
+}
+
+JobHandle& JobHandle::operator=(JobHandle&& other) noexcept
+{
+	if (this != &other)
+	{
+		if (m_Job) m_Job->release();
+		m_Job = std::exchange(other.m_Job, nullptr);
+	}
+	return *this;
+}
+
+bool JobHandle::isDone() const
+{
+	return m_Job && m_Job->m_Done.load(std::memory_order_acquire);
+}
+
+bool JobHandle::getResult() const
+{
+	return isDone() && m_Job->m_Result;
+}
+
+void JobHandle::wait() const
+{
+	if (!m_Job) return;
+
+	while (!m_Job->m_Done.load(std::memory_order_acquire))
+	{
+		if (!Job::runPendingJob())
+		{
+			blockedWaitersCount.fetch_add(1, std::memory_order_seq_cst);
+			m_Job->m_Done.wait(false, std::memory_order_seq_cst);
+			blockedWaitersCount.fetch_sub(1, std::memory_order_relaxed);
+		}
+	}
+}
+
+void JobHandle::cancel() const
+{
+	if (m_Job) m_Job->m_Cancelled.store(true, std::memory_order_relaxed);
+}
+
+bool JobHandle::isCancelled() const
+{
+	return m_Job && m_Job->m_Cancelled.load(std::memory_order_relaxed);
+}
+
+JobHandle JobHandle::then(std::function<bool(void*)> jobCallback, void* data, std::function<void(bool, void*)> cleanupCallback) const
+{
+	return Job::submit(std::move(jobCallback), data, std::move(cleanupCallback), { *this });
+}
+
+JobHandle::~JobHandle()
+{
+	if (m_Job) m_Job->release();
+}
+
+Worker::Worker(u32 index, JobQueue queue, u64 affinity, bool lowPriority) :
+	m_Index(index), m_Queue(queue), m_Affinity(affinity), m_LowPriority(lowPriority)
+{}
+
+void Worker::start()
+{
+	m_Thread = std::jthread(std::bind_front(&Worker::operator(), this));
+}
+
 void Worker::stop()
 {
 	m_Thread.request_stop();
 }
 
+void Worker::join()
+{
+	if (m_Thread.joinable()) m_Thread.join();
+}
+
 int Worker::operator()(const std::stop_token& stopToken)
 {
-	Job job;
+	configureCurrentThread(m_Affinity, m_LowPriority);
+	// Builds the job pool cache now rather than on the first job recycled by this worker.
+	(void)jobPoolCache;
+
+	if (m_Queue == JobQueue::IO)
+		runIOJobs(stopToken);
+	else
+		runComputeJobs(stopToken);
+
+	return 0;
+}
+
+void Worker::runComputeJobs(const std::stop_token& stopToken)
+{
+	currentWorker = this;
+
+	bool woken = false;
 	while (!stopToken.stop_requested())
 	{
+		Job* job = Job::findJob(this);
+		if (!job)
+		{
+			// A wake up may have been requested while this worker was running, when nobody was left to wake.
+			wakingWorker.store(false, std::memory_order_seq_cst);
+			u32 signal = wakeSignal.load(std::memory_order_seq_cst);
+			sleepingWorkersCount.fetch_add(1, std::memory_order_seq_cst);
+			if (pendingJobsCount.load(std::memory_order_seq_cst) <= 0 && !stopToken.stop_requested())
+			{
+				wakeSignal.wait(signal, std::memory_order_seq_cst);
+			}
+			sleepingWorkersCount.fetch_sub(1, std::memory_order_relaxed);
+
+			// From now on the submitters have to wake a worker again, this one looks for jobs before sleeping.
+			wakingWorker.store(false, std::memory_order_seq_cst);
+			woken = true;
+
+			continue;
+		}
+
+		// The submitters woke only this worker, the others are woken one at a time while there is work left.
+		if (woken && pendingJobsCount.load(std::memory_order_relaxed) > 1)
 		{
-			std::unique_lock lock{ jobsQueueMutex };
+			Job::wakeWorker();
+		}
+		woken = false;
 
-			jobsQueueConditionVariable.wait(lock, [stopToken] {
-				return !jobsQueue.empty() || stopToken.stop_requested();
-			});
+		Job::run(job);
+	}
+}
 
+void Worker::runIOJobs(const std::stop_token& stopToken)
+{
+	currentIOWorker = this;
+
+	while (true)
+	{
+		Job* job = nullptr;
+		{
+			std::unique_lock lock{ ioQueueMutex };
+			ioConditionVariable.wait(lock, [stopToken] { return !ioQueue.empty() || stopToken.stop_requested(); });
 			if (stopToken.stop_requested()) break;
 
-			job = jobsQueue.front();
-			jobsQueue.pop();
+			job = ioQueue.front();
+			ioQueue.pop_front();
 		}
 
-		job.execute();
+		Job::run(job);
+	}
+}
+
+Job* Job::findJob(Worker* worker)
+{
+	// The most recent local job is the most likely to be hot in cache.
+	if (worker)
+	{
+		if (auto job = worker->m_Jobs.pop()) return *job;
+	}
 
+	{
+		std::scoped_lock lock{ injectionQueueMutex };
+		u64 available = injectionQueue.size() - injectionQueueHead;
+		if (available > 0)
 		{
-			std::scoped_lock lock{ jobsCompletedMutex };
-			jobsCompleted.push_back(job);
+			// A worker takes a share of the queue at once, so that it does not lock the queue for every job.
+			// The oldest job is run first, the others are pushed so that they are popped in order.
+			u64 count = worker ? std::clamp<u64>(available / workers.size(), 1, INJECTION_BATCH_SIZE) : 1;
+			Job* job = injectionQueue[injectionQueueHead];
+			for (u64 i = injectionQueueHead + count - 1; i > injectionQueueHead; i--)
+			{
+				worker->m_Jobs.push(injectionQueue[i]);
+			}
+			injectionQueueHead += count;
+			if (injectionQueueHead == injectionQueue.size())
+			{
+				injectionQueue.clear();
+				injectionQueueHead = 0;
+			}
+			return job;
 		}
 	}
-	return 0;
+
+	u32 count = static_cast<u32>(workers.size());
+	u32 first = worker ? worker->m_Index + 1 : 0;
+	for (u32 i = 0; i < count; i++)
+	{
+		Worker& victim = *workers[(first + i) % count];
+		if (&victim == worker) continue;
+
+		if (auto job = victim.m_Jobs.steal()) return *job;
+	}
+
+	return nullptr;
 }
 
 } // namespace vulture
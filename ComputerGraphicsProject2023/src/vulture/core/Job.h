@@ -2,11 +2,217 @@
 
 #include "vulture/core/Core.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <concepts>
+#include <coroutine>
+#include <cstddef>
 #include <functional>
+#include <mutex>
+#include <new>
+#include <initializer_list>
+#include <optional>
+#include <span>
 #include <thread>
+#include <type_traits>
+#include <vector>
 
 namespace vulture {
 
+class Job;
+class Worker;
+struct CleanupQueue;
+struct JobAwaiter;
+
+/**
+ * @brief Reference to a submitted job.
+ *
+ * A handle can be used to wait for the job, to read its result, or as a dependency of other jobs.
+ * The job is kept alive as long as a handle references it.
+ */
+class JobHandle
+{
+public:
+	JobHandle() = default;
+	JobHandle(const JobHandle& other);
+	JobHandle(JobHandle&& other) noexcept;
+	JobHandle& operator=(const JobHandle& other);
+	JobHandle& operator=(JobHandle&& other) noexcept;
+
+	/**
+	 * @brief Checks whether the handle references a job.
+	 */
+	inline bool isValid() const { return m_Job != nullptr; }
+
+	/**
+	 * @brief Checks whether the work of the job has been executed.
+	 * The cleanup callback may still be waiting to be run on the main thread.
+	 */
+	bool isDone() const;
+
+	/**
+	 * @brief Gets the value returned by the work of the job.
+	 * The result is meaningful only after the job is done.
+	 */
+	bool getResult() const;
+
+	/**
+	 * @brief Blocks until the work of the job has been executed.
+	 * While waiting, the calling thread executes other queued jobs.
+	 */
+	void wait() const;
+
+	/**
+	 * @brief Requests the cancellation of the job.
+	 * If the job is still queued its work is skipped, otherwise the work can observe the request
+	 * through its JobStopToken. Either way the job is done with a false result, typed cleanups are
+	 * not called and std::function cleanups are called with a false result.
+	 */
+	void cancel() const;
+
+	/**
+	 * @brief Checks whether the cancellation of the job has been requested.
+	 */
+	bool isCancelled() const;
+
+	/**
+	 * @brief Submits a job that starts on a worker as soon as this job is done.
+	 *
+	 * @param jobCallback: the work to do asynchronously.
+	 * @param data: the data produced by the job.
+	 * @param cleanupCallback: the callback used to finish the job. This is executed on the main thread.
+	 *
+	 * @return the handle to the continuation.
+	 */
+	JobHandle then(std::function<bool(void*)> jobCallback, void* data = nullptr, std::function<void(bool, void*)> cleanupCallback = nullptr) const;
+
+	/**
+	 * @brief Suspends the calling coroutine until the job is done, resuming it on a worker.
+	 * The result of the expression is the result of the job.
+	 */
+	JobAwaiter operator co_await() const;
+
+	~JobHandle();
+
+	friend class Job;
+private:
+	explicit JobHandle(Job* job);
+
+	Job* m_Job = nullptr;
+};
+
+/**
+ * @brief Allows the work of a job to check whether it has been cancelled.
+ * A default constructed token never requests a stop.
+ */
+class JobStopToken
+{
+public:
+	JobStopToken() = default;
+
+	inline bool stopRequested() const { return m_Job.isCancelled(); }
+
+	friend class Job;
+private:
+	explicit JobStopToken(JobHandle job) : m_Job(std::move(job)) {}
+
+	JobHandle m_Job;
+};
+
+/**
+ * @brief The order in which the cleanups of completed jobs are run on the main thread.
+ * HIGH cleanups are always run in the frame their job completes, the others can be postponed
+ * to the following frames when the processing budget is exhausted.
+ */
+enum class JobPriority
+{
+	LOW, NORMAL, HIGH
+};
+
+/**
+ * @brief The workers a job is run on.
+ * COMPUTE jobs are run by the compute workers, which are meant to be always busy.
+ * IO jobs are run by the I/O workers, which are allowed to block on files and are usually at a lower priority.
+ */
+enum class JobQueue
+{
+	COMPUTE, IO
+};
+
+/**
+ * @brief Configuration of the threads of the job system.
+ * An affinity is a bit mask of the logical CPUs a thread can run on, 0 leaves the choice to the OS.
+ */
+struct JobSystemConfig
+{
+	u32 computeWorkers = 0;     // 0 uses one worker for each logical CPU but the main thread.
+	u32 ioWorkers = 1;          // 0 runs the IO jobs on the compute workers.
+	u64 computeAffinity = 0;
+	u64 ioAffinity = 0;
+	bool lowPriorityIO = true;  // Runs the I/O workers below the normal thread priority.
+};
+
+/**
+ * @brief Counters describing the state of the job system.
+ */
+struct JobStats
+{
+	u64 queuedJobs = 0;       // Jobs waiting for a worker.
+	u64 pendingCleanups = 0;  // Cleanups postponed to the next frames.
+	u64 processedCleanups = 0; // Cleanups run during the last frame.
+	u64 budgetOverruns = 0;   // Frames in which the cleanups took longer than the budget.
+	f32 processTime = 0.0f;   // Time spent running the cleanups during the last frame, in milliseconds.
+};
+
+/**
+ * @brief Activity of a single worker since the metrics were last reset.
+ */
+struct WorkerMetrics
+{
+	u64 executedJobs = 0;
+	f64 busyTime = 0.0;    // Milliseconds spent running jobs.
+	f64 idleTime = 0.0;    // Milliseconds spent looking for jobs or sleeping.
+	f32 utilization = 0.0f; // busyTime / (busyTime + idleTime).
+	JobQueue queue = JobQueue::COMPUTE;
+};
+
+/**
+ * @brief Activity of the job system since the metrics were last reset.
+ */
+struct JobMetrics
+{
+	u64 submittedJobs = 0;
+	u64 executedJobs = 0;
+	u64 queuedJobs = 0;
+	f64 jobsPerSecond = 0.0;
+	f64 averageWaitTime = 0.0; // Milliseconds between the scheduling and the start of a job.
+	f64 maxWaitTime = 0.0;
+	f64 averageRunTime = 0.0;  // Milliseconds spent in the work of a job.
+	f64 maxRunTime = 0.0;
+	std::vector<WorkerMetrics> workers; // The compute workers followed by the I/O workers.
+};
+
+/**
+ * @brief Non-owning list of job handles, used to pass dependencies without allocating.
+ * It can be built from a braced list, a vector or a single handle and must not outlive them.
+ */
+class JobList
+{
+public:
+	JobList() = default;
+	JobList(std::initializer_list<JobHandle> jobs) : m_Jobs(jobs.begin(), jobs.size()) {}
+	JobList(const std::vector<JobHandle>& jobs) : m_Jobs(jobs) {}
+	JobList(std::span<const JobHandle> jobs) : m_Jobs(jobs) {}
+	JobList(const JobHandle& job) : m_Jobs(&job, 1) {}
+
+	inline auto begin() const { return m_Jobs.begin(); }
+	inline auto end() const { return m_Jobs.end(); }
+	inline u64 size() const { return m_Jobs.size(); }
+private:
+	std::span<const JobHandle> m_Jobs;
+};
+
 /**
  * @brief This class allows to submit jobs to the job system.
  *
@@ -14,36 +220,511 @@ namespace vulture {
  * The first is executed on a different thread asynchronously and returns a boolean.
  * The second is executed on the main thread after the work is completed and should be
  * used to cleanup all the resources used by the job.
+ *
+ * Jobs can also be submitted as typed callables: the work returns a value that is handed to the cleanup
+ * on the main thread. The callables and the value are stored inline in pooled job objects, so in the
+ * steady state such a submission does not allocate as long as they fit in INLINE_STORAGE_SIZE bytes.
+ *
+ * The cleanups run in Job::process within a per-frame time budget, ordered by priority and then by
+ * submission; the ones that do not fit are carried over to the next frame.
+ *
+ * A job can depend on other jobs: it is queued only once all of its dependencies are done,
+ * so multi-stage work can be chained on the workers without going through the main thread.
+ * The result of a dependency does not prevent the execution of its dependents.
+ *
+ * Each worker owns a work-stealing deque: jobs submitted by a worker are pushed to its own deque,
+ * while jobs submitted from any other thread go through a shared injection queue.
+ * Idle workers steal from the others before going to sleep.
+ *
+ * Jobs that block on files should be submitted to JobQueue::IO, which is served by a separate
+ * set of workers with a FIFO queue, so that they do not hold up the compute workers.
  */
 class Job
 {
 public:
+	NO_COPY(Job)
+
 	/**
 	 * @brief Enqueues a new job.
 	 *
 	 * @param jobCallback: the work to do asynchronously.
 	 * @param data: the data produced by the job.
 	 * @param cleanupCallback: the callback used to finish the job. This is executed on the main thread.
+	 * @param dependencies: the jobs that must be done before this job can start.
+	 * @param priority: the priority of the cleanup callback.
+	 * @param queue: the workers the job is run on.
+	 *
+	 * @return the handle to the new job.
+	 */
+	static JobHandle submit(std::function<bool(void*)> jobCallback, void* data, std::function<void(bool, void*)> cleanupCallback,
+		JobList dependencies = {}, JobPriority priority = JobPriority::NORMAL, JobQueue queue = JobQueue::COMPUTE);
+
+	/**
+	 * @brief Enqueues a new job made of typed callables.
+	 * The callables and the value returned by the work are stored inline in the job when small enough.
+	 *
+	 * @param work: the work to do asynchronously, with signature T() or T(JobStopToken). If it throws or the job
+	 *              is cancelled, the job result is false and the cleanup is not called.
+	 * @param cleanup: the callback used to finish the job, with signature void(T&&), or void() if T is void.
+	 *                 This is executed on the main thread. Can be nullptr.
+	 * @param dependencies: the jobs that must be done before this job can start.
+	 * @param priority: the priority of the cleanup callback.
+	 * @param queue: the workers the job is run on.
+	 *
+	 * @return the handle to the new job.
 	 */
-	static void submit(std::function<bool(void*)> jobCallback, void* data, std::function<void(bool, void*)> cleanupCallback);
+	template <class Work, class Cleanup = std::nullptr_t>
+		requires std::invocable<Work&> || std::invocable<Work&, JobStopToken>
+	static JobHandle submit(Work work, Cleanup cleanup = nullptr, JobList dependencies = {},
+		JobPriority priority = JobPriority::NORMAL, JobQueue queue = JobQueue::COMPUTE)
+	{
+		using Payload = TypedPayload<Work, Cleanup>;
+
+		Job* job = allocate();
+		job->emplacePayload<Payload>(std::move(work), std::move(cleanup));
+		job->m_HasCleanup = !std::is_same_v<Cleanup, std::nullptr_t>;
+		job->m_Priority = priority;
+		job->m_Queue = queue;
+		return enqueue(job, dependencies);
+	}
+
+	/**
+	 * @brief Blocks until the work of all the given jobs has been executed.
+	 * While waiting, the calling thread executes other queued jobs.
+	 *
+	 * @param jobs: the jobs to wait for.
+	 */
+	static void join(JobList jobs);
+
+	/**
+	 * @brief Calls a function for every index in [begin, end), splitting the range across the workers.
+	 * The calling thread takes part in the work and the call returns once every index has been processed.
+	 * It only waits for the threads already working on the range, it never runs unrelated jobs meanwhile.
+	 * The range is handed out in chunks that start large and shrink down to the grain size,
+	 * so that uneven iterations are balanced between the threads.
+	 *
+	 * @param begin: the first index.
+	 * @param end: one past the last index.
+	 * @param grain: the minimum number of indices processed by a single chunk.
+	 * @param function: the function to call, with signature void(u64 index). It must not throw.
+	 */
+	template <class Function>
+	static void parallelFor(u64 begin, u64 end, u64 grain, Function&& function)
+	{
+		auto forEach = [&function](u64 first, u64 last, u32) {
+			for (u64 i = first; i < last; i++)
+			{
+				function(i);
+			}
+		};
+		parallelForRange(begin, end, grain, forEach);
+	}
+
+	/**
+	 * @brief Calls a function for chunks of [begin, end), splitting the range across the workers as in parallelFor.
+	 * The function also receives the index of the thread running the chunk, less than getParallelism(),
+	 * so that each thread can write to its own data without synchronization.
+	 *
+	 * @param begin: the first index.
+	 * @param end: one past the last index.
+	 * @param grain: the minimum number of indices processed by a single chunk.
+	 * @param function: the function to call, with signature void(u64 first, u64 last, u32 participant). It must not throw.
+	 */
+	template <class Function>
+	static void parallelForChunks(u64 begin, u64 end, u64 grain, Function&& function)
+	{
+		parallelForRange(begin, end, grain, function);
+	}
+
+	/**
+	 * @brief Maps every index in [begin, end) to a value and combines the values, splitting the range across the workers.
+	 * The calling thread takes part in the work, the chunks are distributed as in parallelFor.
+	 *
+	 * @param begin: the first index.
+	 * @param end: one past the last index.
+	 * @param grain: the minimum number of indices processed by a single chunk.
+	 * @param identity: the identity value of the reduction.
+	 * @param map: the function producing the value of an index, with signature T(u64 index). It must not throw.
+	 * @param reduce: the function combining two values, with signature T(T, T). It must be associative and commutative.
+	 *
+	 * @return the combined value, or identity if the range is empty.
+	 */
+	template <class T, class Map, class Reduce>
+	static T parallelReduce(u64 begin, u64 end, u64 grain, T identity, Map&& map, Reduce&& reduce)
+	{
+		// One partial value for each participant, on the stack: T may not be default constructible.
+		u32 participantsCount = getParallelism();
+		alignas(T) std::byte storage[MAX_PARALLEL_FOR_PARTICIPANTS * sizeof(T)];
+		T* partials = std::launder(reinterpret_cast<T*>(storage));
+		for (u32 i = 0; i < participantsCount; i++)
+		{
+			new (&partials[i]) T(identity);
+		}
+
+		auto accumulate = [&](u64 first, u64 last, u32 participant) {
+			T partial = identity;
+			for (u64 i = first; i < last; i++)
+			{
+				partial = reduce(partial, map(i));
+			}
+			partials[participant] = reduce(partials[participant], partial);
+		};
+		parallelForRange(begin, end, grain, accumulate);
+
+		T result = identity;
+		for (u32 i = 0; i < participantsCount; i++)
+		{
+			result = reduce(result, partials[i]);
+			partials[i].~T();
+		}
+		return result;
+	}
+
+	/**
+	 * @brief Sets the time that Job::process can spend running cleanups each frame.
+	 * At least one cleanup is run every frame, regardless of the budget.
+	 *
+	 * @param milliseconds: the budget, a non positive value disables it.
+	 */
+	static void setProcessBudget(f32 milliseconds);
+
+	/**
+	 * @brief Gets the current counters of the job system.
+	 */
+	static JobStats getStats();
+
+	/**
+	 * @brief Gets the activity of the job system since the last call to resetMetrics.
+	 * The wait and run times are only measured while the metrics are enabled or a trace is recorded.
+	 */
+	static JobMetrics getMetrics();
+
+	/**
+	 * @brief Enables the measurement of the wait and run time of every job.
+	 * It reads the clock three times for each job, so it is disabled by default.
+	 */
+	static void setMetricsEnabled(bool enabled);
+
+	/**
+	 * @brief Restarts the collection of the metrics returned by getMetrics.
+	 */
+	static void resetMetrics();
+
+	/**
+	 * @brief Starts recording the spans of the executed jobs and cleanups.
+	 * Any previous recording is discarded.
+	 */
+	static void beginTrace();
+
+	/**
+	 * @brief Stops the recording started by beginTrace and writes it in the Chrome trace event format,
+	 * which can be opened in chrome://tracing or Perfetto.
+	 *
+	 * @param path: the path of the JSON file to write.
+	 *
+	 * @return true if the file has been written, false otherwise.
+	 */
+	static bool endTrace(const String& path);
+
+	/**
+	 * @brief Gets an awaitable that moves the calling coroutine to the main thread.
+	 * The coroutine is resumed by Job::process as the cleanup of a job with the given priority;
+	 * if it is already running on the main thread it continues immediately.
+	 *
+	 * @param priority: the priority of the resumption among the other cleanups.
+	 */
+	static auto mainThread(JobPriority priority = JobPriority::NORMAL)
+	{
+		struct Awaiter
+		{
+			JobPriority priority;
+
+			bool await_ready() const { return isMainThread(); }
+			void await_suspend(std::coroutine_handle<> coroutine) const
+			{
+				submit([]() {}, [coroutine]() { coroutine.resume(); }, {}, priority);
+			}
+			void await_resume() const {}
+		};
+		return Awaiter{ priority };
+	}
+
+	/**
+	 * @brief Gets an awaitable that moves the calling coroutine to a compute worker.
+	 * If it is already running on a compute worker it continues immediately.
+	 */
+	static auto worker()
+	{
+		struct Awaiter
+		{
+			bool await_ready() const { return isWorkerThread(); }
+			void await_suspend(std::coroutine_handle<> coroutine) const
+			{
+				submit([coroutine]() { coroutine.resume(); });
+			}
+			void await_resume() const {}
+		};
+		return Awaiter{};
+	}
+
+	/**
+	 * @brief Gets an awaitable that moves the calling coroutine to an I/O worker, where it can block on files.
+	 * If it is already running on an I/O worker it continues immediately.
+	 */
+	static auto io()
+	{
+		struct Awaiter
+		{
+			bool await_ready() const { return isIOThread(); }
+			void await_suspend(std::coroutine_handle<> coroutine) const
+			{
+				submit([coroutine]() { coroutine.resume(); }, nullptr, {}, JobPriority::NORMAL, JobQueue::IO);
+			}
+			void await_resume() const {}
+		};
+		return Awaiter{};
+	}
+
+	/**
+	 * @brief Checks whether the calling thread is the one that initialized the job system.
+	 */
+	static bool isMainThread();
+
+	/**
+	 * @brief Checks whether the calling thread is a compute worker of the job system.
+	 */
+	static bool isWorkerThread();
+
+	/**
+	 * @brief Checks whether the calling thread is an I/O worker of the job system.
+	 */
+	static bool isIOThread();
+
+	/**
+	 * @brief Gets the stop token of the job running on the calling thread.
+	 * It can be used by std::function jobs, both in the work and in the cleanup callback.
+	 *
+	 * @return the stop token, or a token that never requests a stop if no job is running.
+	 */
+	static JobStopToken getStopToken();
+
+	/**
+	 * @brief Gets the maximum number of threads taking part in a parallelFor, including the calling thread.
+	 * The I/O workers do not take part in it.
+	 * It is capped to MAX_PARALLEL_FOR_PARTICIPANTS.
+	 */
+	static u32 getParallelism();
+
+	/**
+	 * @brief The number of bytes available in a job to store its callables and result without allocating.
+	 */
+	static constexpr u64 INLINE_STORAGE_SIZE = 128;
+
+	/**
+	 * @brief The maximum number of threads taking part in a single parallelFor.
+	 */
+	static constexpr u32 MAX_PARALLEL_FOR_PARTICIPANTS = 64;
+
+	/**
+	 * @brief The default time that Job::process can spend running cleanups each frame, in milliseconds.
+	 */
+	static constexpr f32 DEFAULT_PROCESS_BUDGET = 4.0f;
 
 	friend class Application;
 	friend class Worker;
+	friend class JobHandle;
+	friend struct CleanupQueue;
 private:
-	Job();
-	Job(std::function<bool(void*)> jobCallback, void* data, std::function<void(bool, void*)> cleanupCallback);
+	Job() = default;
+
+	template <class Work, class Cleanup>
+	struct TypedPayload
+	{
+		static constexpr bool TAKES_STOP_TOKEN = std::invocable<Work&, JobStopToken>;
+
+		using Result = typename std::conditional_t<TAKES_STOP_TOKEN,
+			std::invoke_result<Work&, JobStopToken>, std::invoke_result<Work&>>::type;
+		using Storage = std::conditional_t<std::is_void_v<Result>, bool, Result>;
+
+		Work work;
+		Cleanup cleanup;
+		std::optional<Storage> result{};
+
+		Result invoke()
+		{
+			if constexpr (TAKES_STOP_TOKEN)
+				return work(Job::getStopToken());
+			else
+				return work();
+		}
+
+		static bool execute(void* payload)
+		{
+			auto* self = static_cast<TypedPayload*>(payload);
+			if constexpr (std::is_void_v<Result>)
+			{
+				self->invoke();
+				self->result.emplace(true);
+			}
+			else
+			{
+				self->result.emplace(self->invoke());
+			}
+			return true;
+		}
+
+		static void finish(void* payload, bool result)
+		{
+			auto* self = static_cast<TypedPayload*>(payload);
+			if constexpr (!std::is_same_v<Cleanup, std::nullptr_t>)
+			{
+				if (!result || !self->result) return;
 
-	std::function<bool(void*)> m_WorkCallback;
-	std::function<void(bool, void*)> m_CleanupCallback;
-	void* m_Data;
+				if constexpr (std::is_void_v<Result>)
+					self->cleanup();
+				else
+					self->cleanup(std::move(*self->result));
+			}
+		}
+	};
+
+	// Type erased callables, either in m_Storage or on the heap when too large.
+	alignas(std::max_align_t) std::byte m_Storage[INLINE_STORAGE_SIZE];
+	void* m_Payload = nullptr;
+	bool (*m_Execute)(void*) = nullptr;
+	void (*m_Finish)(void*, bool) = nullptr;
+	void (*m_Destroy)(void*, bool) = nullptr;
+	bool m_HasCleanup = false;
 	bool m_Result = false;
+	bool m_Revocable = false; // A parallelFor helper, which its caller can take back while it is queued.
+	JobPriority m_Priority = JobPriority::NORMAL;
+	JobQueue m_Queue = JobQueue::COMPUTE;
+	u64 m_Sequence = 0;
+	u64 m_ScheduleTime = 0;
+	Job* m_NextCompleted = nullptr;
+
+	std::atomic<u32> m_ReferenceCount = 1;
+	std::atomic<u32> m_PendingDependencies = 0;
+	std::atomic<bool> m_Done = false;
+	std::atomic<bool> m_Cancelled = false;
+	std::atomic<bool> m_Claimed = false; // Set by the first of the worker and the caller of a parallelFor helper.
+	std::mutex m_ContinuationsMutex;
+	std::vector<Job*> m_Continuations;
 
 	void execute();
 	void cleanupExecute();
 
-	static bool init();
+	template <class Payload, class ...Args>
+	void emplacePayload(Args&& ...args)
+	{
+		constexpr bool inlined = sizeof(Payload) <= INLINE_STORAGE_SIZE && alignof(Payload) <= alignof(std::max_align_t);
+		if constexpr (inlined)
+			m_Payload = new (m_Storage) Payload{ std::forward<Args>(args)... };
+		else
+			m_Payload = new Payload{ std::forward<Args>(args)... };
+
+		m_Execute = &Payload::execute;
+		m_Finish = &Payload::finish;
+		m_Destroy = [](void* payload, bool inlined) {
+			if (inlined)
+				static_cast<Payload*>(payload)->~Payload();
+			else
+				delete static_cast<Payload*>(payload);
+		};
+	}
+
+	void destroyPayload();
+
+	void acquire();
+	void release();
+
+	static Job* allocate();
+	static void recycle(Job* job);
+	static JobHandle enqueue(Job* job, JobList dependencies);
+
+	static void schedule(Job* job);
+	static void run(Job* job);
+	static void finish(Job* job);
+	static void discard(Job* job);
+	static Job* findJob(Worker* worker);
+	static bool runPendingJob();
+	static void wakeWorker();
+
+	// The function is called directly, without being wrapped in a std::function, so that it does not allocate.
+	template <class Function>
+	static void parallelForRange(u64 begin, u64 end, u64 grain, Function& function)
+	{
+		if (begin >= end) return;
+
+		grain = std::max(grain, 1ULL);
+		u64 chunksCount = (end - begin + grain - 1) / grain;
+		u32 participantsCount = static_cast<u32>(std::min<u64>(getParallelism(), chunksCount));
+
+		if (participantsCount <= 1)
+		{
+			function(begin, end, 0);
+			return;
+		}
+
+		std::atomic<u64> next = begin;
+		auto participate = [&](u32 participant) {
+			u64 first = next.load(std::memory_order_relaxed);
+			while (first < end)
+			{
+				// Guided scheduling: large chunks first, down to the grain size near the end of the range.
+				u64 remaining = end - first;
+				u64 size = std::min(remaining, std::max(grain, remaining / (2ULL * participantsCount)));
+
+				if (next.compare_exchange_weak(first, first + size, std::memory_order_relaxed))
+				{
+					function(first, first + size, participant);
+					first = next.load(std::memory_order_relaxed);
+				}
+			}
+		};
+
+		std::array<JobHandle, MAX_PARALLEL_FOR_PARTICIPANTS - 1> helpers;
+		for (u32 participant = 1; participant < participantsCount; participant++)
+		{
+			auto help = [&participate, participant]() { participate(participant); };
+
+			Job* job = allocate();
+			job->emplacePayload<TypedPayload<decltype(help), std::nullptr_t>>(std::move(help), nullptr);
+			job->m_Revocable = true;
+			helpers[participant - 1] = enqueue(job, {});
+		}
+
+		participate(0);
+
+		// The helpers reference the state on this stack frame.
+		joinHelpers(std::span<const JobHandle>(helpers.data(), participantsCount - 1));
+	}
+
+	static void joinHelpers(std::span<const JobHandle> helpers);
+
+	static bool init(const JobSystemConfig& config = {});
 	static void cleanup();
 	static void process();
 };
 
+/**
+ * @brief Awaiter returned by co_await on a JobHandle.
+ */
+struct JobAwaiter
+{
+	JobHandle job;
+
+	bool await_ready() const { return !job.isValid() || job.isDone(); }
+	void await_suspend(std::coroutine_handle<> coroutine) const
+	{
+		Job::submit([coroutine]() { coroutine.resume(); }, nullptr, job);
+	}
+	bool await_resume() const { return job.getResult(); }
+};
+
+inline JobAwaiter JobHandle::operator co_await() const
+{
+	return JobAwaiter{ *this };
+}
+
 } // namespace vulture
@@ -0,0 +1,203 @@
+#pragma once
+
+#include "vulture/core/Job.h"
+#include "vulture/core/Logger.h"
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+
+namespace vulture {
+
+template <class T>
+class Task;
+
+/**
+ * @brief State shared by the promises of all the tasks.
+ */
+class TaskPromiseBase
+{
+public:
+	struct FinalAwaiter
+	{
+		bool await_ready() noexcept { return false; }
+
+		template <class Promise>
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> coroutine) noexcept
+		{
+			TaskPromiseBase& promise = coroutine.promise();
+			if (promise.m_Continuation) return promise.m_Continuation;
+
+			if (promise.m_Detached)
+			{
+				if (promise.m_Exception)
+				{
+					try
+					{
+						std::rethrow_exception(promise.m_Exception);
+					}
+					catch (const std::exception& e)
+					{
+						VUERROR("Un exception was thrown by a detached task.\nMessage: %s.", e.what());
+					}
+					catch (...)
+					{
+						VUERROR("Un exception was thrown by a detached task.");
+					}
+				}
+				coroutine.destroy();
+			}
+			return std::noop_coroutine();
+		}
+
+		void await_resume() noexcept {}
+	};
+
+	std::suspend_always initial_suspend() noexcept { return {}; }
+	FinalAwaiter final_suspend() noexcept { return {}; }
+
+	void unhandled_exception() { m_Exception = std::current_exception(); }
+
+	template <class>
+	friend class Task;
+protected:
+	std::coroutine_handle<> m_Continuation;
+	std::exception_ptr m_Exception;
+	bool m_Detached = false;
+
+	void rethrowIfFailed() const
+	{
+		if (m_Exception) std::rethrow_exception(m_Exception);
+	}
+};
+
+template <class T>
+class TaskPromise : public TaskPromiseBase
+{
+public:
+	Task<T> get_return_object();
+
+	template <class Value>
+	void return_value(Value&& value) { m_Value.emplace(std::forward<Value>(value)); }
+
+	T takeValue()
+	{
+		rethrowIfFailed();
+		return std::move(*m_Value);
+	}
+private:
+	std::optional<T> m_Value;
+};
+
+template <>
+class TaskPromise<void> : public TaskPromiseBase
+{
+public:
+	Task<void> get_return_object();
+
+	void return_void() {}
+
+	void takeValue() { rethrowIfFailed(); }
+};
+
+/**
+ * @brief Lazily started coroutine producing a value of type T.
+ *
+ * A task starts when it is awaited, or when it is detached, and runs on the calling thread
+ * until it suspends. Co-awaiting Job::worker() or Job::mainThread() moves it between threads,
+ * so that a loader can be written as straight-line code:
+ *
+ *     Task<Ref<Texture>> load(String name)
+ *     {
+ *         co_await Job::worker();
+ *         auto pixels = decode(name);   // On a worker.
+ *         co_await Job::mainThread();
+ *         co_return upload(pixels);     // On the main thread.
+ *     }
+ *
+ * When the task completes, the coroutine awaiting it is resumed on the same thread.
+ */
+template <class T = void>
+class Task
+{
+public:
+	using promise_type = TaskPromise<T>;
+
+	NO_COPY(Task)
+
+	Task() = default;
+	Task(Task&& other) noexcept : m_Coroutine(std::exchange(other.m_Coroutine, nullptr)) {}
+
+	Task& operator=(Task&& other) noexcept
+	{
+		if (this != &other)
+		{
+			if (m_Coroutine) m_Coroutine.destroy();
+			m_Coroutine = std::exchange(other.m_Coroutine, nullptr);
+		}
+		return *this;
+	}
+
+	inline bool isValid() const { return static_cast<bool>(m_Coroutine); }
+
+	/**
+	 * @brief Starts the task without waiting for it.
+	 * The task frees itself when it completes; exceptions escaping from it are logged.
+	 */
+	void detach() &&
+	{
+		if (!m_Coroutine) return;
+
+		auto coroutine = std::exchange(m_Coroutine, nullptr);
+		coroutine.promise().m_Detached = true;
+		coroutine.resume();
+	}
+
+	/**
+	 * @brief Starts the task and suspends the awaiting coroutine until it completes.
+	 * The result is the value returned by the task, or its exception is rethrown.
+	 */
+	auto operator co_await() && noexcept
+	{
+		struct Awaiter
+		{
+			std::coroutine_handle<promise_type> coroutine;
+
+			bool await_ready() const noexcept { return !coroutine || coroutine.done(); }
+
+			std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+			{
+				coroutine.promise().m_Continuation = awaiting;
+				return coroutine;
+			}
+
+			T await_resume() { return coroutine.promise().takeValue(); }
+		};
+		return Awaiter{ m_Coroutine };
+	}
+
+	~Task()
+	{
+		if (m_Coroutine) m_Coroutine.destroy();
+	}
+
+	friend class TaskPromise<T>;
+private:
+	explicit Task(std::coroutine_handle<promise_type> coroutine) : m_Coroutine(coroutine) {}
+
+	std::coroutine_handle<promise_type> m_Coroutine;
+};
+
+template <class T>
+Task<T> TaskPromise<T>::get_return_object()
+{
+	return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object()
+{
+	return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+} // namespace vulture
@@ -0,0 +1,155 @@
+#pragma once
+
+#include "vulture/core/Core.h"
+#include "vulture/util/Types.h"
+
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace vulture {
+
+/**
+ * @brief Chase-Lev work-stealing deque.
+ *
+ * The owner thread pushes and pops at the bottom, while any other thread can steal from the top.
+ * The memory orderings follow "Correct and Efficient Work-Stealing for Weak Memory Models" (Le et al. 2013).
+ * The buffer grows when full; the old buffers are kept alive until the deque is destroyed
+ * because a concurrent thief may still be reading from them.
+ *
+ * @tparam T: a trivially copyable type, usually a pointer.
+ */
+template <class T>
+class WorkStealingDeque
+{
+public:
+	NO_COPY(WorkStealingDeque)
+
+	/**
+	 * @brief Constructs an empty deque.
+	 *
+	 * @param capacity: the initial capacity, must be a power of two.
+	 */
+	explicit WorkStealingDeque(i64 capacity = 1024)
+	{
+		m_Buffers.push_back(std::make_unique<Buffer>(capacity));
+		m_Buffer.store(m_Buffers.back().get(), std::memory_order_relaxed);
+	}
+
+	/**
+	 * @brief Pushes an item at the bottom of the deque. Must be called only by the owner thread.
+	 */
+	void push(T item)
+	{
+		i64 bottom = m_Bottom.load(std::memory_order_relaxed);
+		i64 top = m_Top.load(std::memory_order_acquire);
+		Buffer* buffer = m_Buffer.load(std::memory_order_relaxed);
+
+		if (bottom - top > buffer->capacity - 1)
+		{
+			buffer = grow(buffer, bottom, top);
+		}
+
+		buffer->put(bottom, item);
+		std::atomic_thread_fence(std::memory_order_release);
+		m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+	}
+
+	/**
+	 * @brief Pops the most recently pushed item. Must be called only by the owner thread.
+	 *
+	 * @return the item, or an empty optional if the deque is empty.
+	 */
+	std::optional<T> pop()
+	{
+		i64 bottom = m_Bottom.load(std::memory_order_relaxed) - 1;
+		Buffer* buffer = m_Buffer.load(std::memory_order_relaxed);
+		m_Bottom.store(bottom, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		i64 top = m_Top.load(std::memory_order_relaxed);
+
+		if (top > bottom)
+		{
+			m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+			return std::nullopt;
+		}
+
+		T item = buffer->get(bottom);
+		if (top == bottom)
+		{
+			// Last item: race against the thieves.
+			bool won = m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+			m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+			if (!won) return std::nullopt;
+		}
+		return item;
+	}
+
+	/**
+	 * @brief Steals the oldest item. Can be called by any thread.
+	 *
+	 * @return the item, or an empty optional if the deque is empty or the steal lost a race.
+	 */
+	std::optional<T> steal()
+	{
+		i64 top = m_Top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		i64 bottom = m_Bottom.load(std::memory_order_acquire);
+
+		if (top >= bottom) return std::nullopt;
+
+		Buffer* buffer = m_Buffer.load(std::memory_order_acquire);
+		T item = buffer->get(top);
+		if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		{
+			return std::nullopt;
+		}
+		return item;
+	}
+
+	/**
+	 * @brief Gets an approximation of the number of items in the deque.
+	 */
+	inline i64 size() const
+	{
+		i64 bottom = m_Bottom.load(std::memory_order_relaxed);
+		i64 top = m_Top.load(std::memory_order_relaxed);
+		return bottom > top ? bottom - top : 0;
+	}
+
+	inline bool empty() const { return size() == 0; }
+private:
+	struct Buffer
+	{
+		i64 capacity;
+		i64 mask;
+		std::unique_ptr<std::atomic<T>[]> items;
+
+		explicit Buffer(i64 _capacity) :
+			capacity(_capacity), mask(_capacity - 1), items(std::make_unique<std::atomic<T>[]>(static_cast<u64>(_capacity)))
+		{}
+
+		inline T get(i64 index) const { return items[index & mask].load(std::memory_order_relaxed); }
+		inline void put(i64 index, T item) { items[index & mask].store(item, std::memory_order_relaxed); }
+	};
+
+	std::atomic<i64> m_Top = 0;
+	std::atomic<i64> m_Bottom = 0;
+	std::atomic<Buffer*> m_Buffer;
+	std::vector<std::unique_ptr<Buffer>> m_Buffers; // Only accessed by the owner.
+
+	Buffer* grow(Buffer* buffer, i64 bottom, i64 top)
+	{
+		m_Buffers.push_back(std::make_unique<Buffer>(buffer->capacity * 2));
+		Buffer* newBuffer = m_Buffers.back().get();
+		for (i64 i = top; i < bottom; i++)
+		{
+			newBuffer->put(i, buffer->get(i));
+		}
+		m_Buffer.store(newBuffer, std::memory_order_release);
+		return newBuffer;
+	}
+};
+
+} // namespace vulture
@@ -26,9 +26,11 @@ CommandBuffer::CommandBuffer(CommandBuffer &&other) noexcept
 {
 	m_Handle = other.m_Handle;
 	m_SingleTime = other.m_SingleTime;
+	m_Fence = other.m_Fence;
 
 	other.m_Handle = VK_NULL_HANDLE;
 	other.m_SingleTime = false;
+	other.m_Fence = VK_NULL_HANDLE;
 }
 
 CommandBuffer::CommandBuffer(bool singleTime)
@@ -83,9 +85,11 @@ CommandBuffer &CommandBuffer::operator=(CommandBuffer &&other) noexcept
 
 		m_Handle = other.m_Handle;
 		m_SingleTime = other.m_SingleTime;
+		m_Fence = other.m_Fence;
 
 		other.m_Handle = VK_NULL_HANDLE;
 		other.m_SingleTime = false;
+		other.m_Fence = VK_NULL_HANDLE;
 	}
 
 	return *this;
@@ -143,6 +147,26 @@ void CommandBuffer::bindDescriptorSet(const Pipeline &pipeline, VkDescriptorSet
 	vkCmdBindDescriptorSets(m_Handle, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline.getLayout(), set, 1, &descriptorSet, 0, nullptr);
 }
 
+void CommandBuffer::bindPipeline(const ComputePipeline &pipeline)
+{
+	vkCmdBindPipeline(m_Handle, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline.getHandle());
+}
+
+void CommandBuffer::bindDescriptorSet(const ComputePipeline &pipeline, VkDescriptorSet descriptorSet, u32 set)
+{
+	vkCmdBindDescriptorSets(m_Handle, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline.getLayout(), set, 1, &descriptorSet, 0, nullptr);
+}
+
+void CommandBuffer::pushConstants(const ComputePipeline &pipeline, const void *data, u32 size)
+{
+	vkCmdPushConstants(m_Handle, pipeline.getLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, size, data);
+}
+
+void CommandBuffer::dispatch(u32 groupCountX, u32 groupCountY, u32 groupCountZ)
+{
+	vkCmdDispatch(m_Handle, groupCountX, groupCountY, groupCountZ);
+}
+
 void CommandBuffer::bindVertexBuffer(const Buffer &buffer)
 {
 	VkBuffer vertexBuffers[] = {buffer.getHandle()};
@@ -155,9 +179,9 @@ void CommandBuffer::bindIndexBuffer(const Buffer &buffer)
 	vkCmdBindIndexBuffer(m_Handle, buffer.getHandle(), 0, VK_INDEX_TYPE_UINT32);
 }
 
-void CommandBuffer::drawIndexed(u32 indexCount)
+void CommandBuffer::drawIndexed(u32 indexCount, u32 instanceCount)
 {
-	vkCmdDrawIndexed(m_Handle, indexCount, 1, 0, 0, 0);
+	vkCmdDrawIndexed(m_Handle, indexCount, instanceCount, 0, 0, 0);
 }
 
 void CommandBuffer::endRenderPass()
@@ -170,6 +194,21 @@ void CommandBuffer::end()
 	ASSERT_VK_SUCCESS(vkEndCommandBuffer(m_Handle), "Failed to record command buffer!");
 }
 
+void CommandBuffer::submit(const Fence& fence)
+{
+	end();
+
+	VkSubmitInfo submitInfo = { VK_STRUCTURE_TYPE_SUBMIT_INFO };
+	submitInfo.pNext = nullptr;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &m_Handle;
+
+	ASSERT_VK_SUCCESS(vkQueueSubmit(vulkanData.graphicsQueue, 1, &submitInfo, fence.getHandle()), "Failed to submit command buffer!");
+
+	m_SingleTime = false;
+	m_Fence = fence.getHandle();
+}
+
 CommandBuffer::~CommandBuffer()
 {
 	cleanup();
@@ -195,7 +234,10 @@ void CommandBuffer::cleanup() noexcept
 
 			vkQueueSubmit(vulkanData.graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
 		}
-		vkQueueWaitIdle(vulkanData.graphicsQueue);
+		if (m_Fence != VK_NULL_HANDLE)
+			vkWaitForFences(vulkanData.device, 1, &m_Fence, VK_TRUE, UINT64_MAX);
+		else
+			vkQueueWaitIdle(vulkanData.graphicsQueue);
 		vkFreeCommandBuffers(vulkanData.device, vulkanData.commandPool, 1, &m_Handle);
 	}
 }
@@ -219,7 +261,7 @@ Image::Image(Image &&other) noexcept
 	other.m_Height = -1;
 }
 
-VkImageView createImageView(VkImage image, const ImageCreationInfo& info)
+VkImageView createImageView(VkImage image, const ImageCreationInfo& info, u32 baseMipLevel = 0, u32 levelCount = 1)
 {
 	VkImageView view;
 
@@ -231,8 +273,8 @@ VkImageView createImageView(VkImage image, const ImageCreationInfo& info)
 	viewInfo.format = info.format;
 	// viewInfo.components;
 	viewInfo.subresourceRange.aspectMask = info.aspectFlags;
-	viewInfo.subresourceRange.baseMipLevel = 0;
-	viewInfo.subresourceRange.levelCount = 1;
+	viewInfo.subresourceRange.baseMipLevel = baseMipLevel;
+	viewInfo.subresourceRange.levelCount = levelCount;
 	viewInfo.subresourceRange.baseArrayLayer = 0;
 	viewInfo.subresourceRange.layerCount = info.arrayLayers;
 
@@ -314,7 +356,11 @@ inline bool hasStencilComponent(VkFormat format)
 void Image::transitionLayout(VkImageLayout newLayout, const ImageCreationInfo& info, u32 baseArrayLayer)
 {
 	CommandBuffer commandBuffer(true);
+	transitionLayout(commandBuffer, newLayout, info, baseArrayLayer);
+}
 
+void Image::transitionLayout(CommandBuffer& commandBuffer, VkImageLayout newLayout, const ImageCreationInfo& info, u32 baseArrayLayer)
+{
 	VkPipelineStageFlags sourceStage;
 	VkPipelineStageFlags destinationStage;
 
@@ -366,6 +412,22 @@ void Image::transitionLayout(VkImageLayout newLayout, const ImageCreationInfo& i
 		sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
 		destinationStage = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
 	}
+	else if (m_Layout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_GENERAL)
+	{
+		barrier.srcAccessMask = 0;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+
+		sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+		destinationStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	}
+	else if (m_Layout == VK_IMAGE_LAYOUT_GENERAL && newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL)
+	{
+		barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_READ_BIT;
+		barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_TRANSFER_READ_BIT;
+
+		sourceStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT;
+		destinationStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+	}
 	else
 	{
 		VUERROR("Trying to transition the layout of an image from %i to %i!", m_Layout, newLayout);
@@ -412,7 +474,60 @@ void Image::copyFromBuffer(const Buffer &buffer, const ImageCreationInfo& info)
 		&region);
 }
 
+void Image::copyToBuffer(const Buffer &buffer, const ImageCreationInfo& info)
+{
+	CommandBuffer commandBuffer(true);
+	copyToBuffer(commandBuffer, buffer, info);
+}
+
+void Image::copyToBuffer(CommandBuffer& commandBuffer, const Buffer &buffer, const ImageCreationInfo& info)
+{
+	// Makes the writes of the previous commands, e.g. compute shaders, visible to the copy.
+	VkMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+	vkCmdPipelineBarrier(
+		commandBuffer.getHandle(),
+		VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+		0,
+		1, &barrier,
+		0, nullptr,
+		0, nullptr);
+
+	VkBufferImageCopy region{};
+	region.bufferOffset = 0;
+	region.bufferRowLength = 0;
+	region.bufferImageHeight = 0;
+
+	region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	region.imageSubresource.mipLevel = 0;
+	region.imageSubresource.baseArrayLayer = 0;
+	region.imageSubresource.layerCount = info.arrayLayers;
+
+	region.imageOffset = {0, 0, 0};
+	region.imageExtent = {
+		static_cast<u32>(m_Width),
+		static_cast<u32>(m_Height),
+		1};
+
+	vkCmdCopyImageToBuffer(
+		commandBuffer.getHandle(),
+		m_Handle,
+		m_Layout,
+		buffer.getHandle(),
+		1,
+		&region);
+}
+
 void Image::generateMipmaps(u32 mipLevels, u32 layerCount)
+{
+	CommandBuffer commandBuffer(true);
+	generateMipmaps(commandBuffer, mipLevels, layerCount);
+}
+
+void Image::generateMipmaps(CommandBuffer& commandBuffer, u32 mipLevels, u32 layerCount)
 {
 	VkFormatProperties formatProperties;
 	vkGetPhysicalDeviceFormatProperties(vulkanData.physicalDevice, m_Format, &formatProperties);
@@ -422,8 +537,6 @@ void Image::generateMipmaps(u32 mipLevels, u32 layerCount)
 		throw std::runtime_error("Texture image format does not support linear blitting!");
 	}
 
-	CommandBuffer commandBuffer(true);
-
 	VkImageMemoryBarrier barrier{};
 	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
 	barrier.image = m_Handle;
@@ -548,6 +661,44 @@ void Image::cleanup() noexcept
 	}
 }
 
+ImageView::ImageView(const Image& image, const ImageCreationInfo& info, u32 baseMipLevel, u32 levelCount)
+{
+	m_Handle = createImageView(image.getHandle(), info, baseMipLevel, levelCount);
+}
+
+ImageView::~ImageView()
+{
+	if (m_Handle == VK_NULL_HANDLE)
+		return;
+
+	vkDestroyImageView(vulkanData.device, m_Handle, vulkanData.allocator);
+}
+
+Fence::Fence()
+{
+	VkFenceCreateInfo fenceInfo = { VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
+	fenceInfo.pNext = nullptr;
+	fenceInfo.flags = 0;
+
+	ASSERT_VK_SUCCESS(vkCreateFence(vulkanData.device, &fenceInfo, vulkanData.allocator, &m_Handle), "Failed to create fence!");
+}
+
+bool Fence::isSignaled() const
+{
+	return vkGetFenceStatus(vulkanData.device, m_Handle) == VK_SUCCESS;
+}
+
+void Fence::wait() const
+{
+	vkWaitForFences(vulkanData.device, 1, &m_Handle, VK_TRUE, UINT64_MAX);
+}
+
+Fence::~Fence()
+{
+	if (m_Handle != VK_NULL_HANDLE)
+		vkDestroyFence(vulkanData.device, m_Handle, vulkanData.allocator);
+}
+
 Buffer::Buffer(Buffer &&other) noexcept
 {
 	m_Handle = other.m_Handle;
@@ -607,6 +758,36 @@ void Buffer::map() const
 	map(m_Data);
 }
 
+void Buffer::map(const void *data, VkDeviceSize offset, VkDeviceSize size) const
+{
+	if (!data)
+	{
+		VUWARN("Trying to map a null pointer.");
+		return;
+	}
+
+	void *tmp;
+
+	vkMapMemory(vulkanData.device, m_Memory, offset, size, 0, &tmp);
+	memcpy(tmp, data, size);
+	vkUnmapMemory(vulkanData.device, m_Memory);
+}
+
+void Buffer::read(void *data) const
+{
+	if (!data)
+	{
+		VUWARN("Trying to read into a null pointer.");
+		return;
+	}
+
+	void *tmp;
+
+	vkMapMemory(vulkanData.device, m_Memory, 0, m_Size, 0, &tmp);
+	memcpy(data, tmp, m_Size);
+	vkUnmapMemory(vulkanData.device, m_Memory);
+}
+
 void Buffer::copyToBuffer(VkDeviceSize size, const Buffer &destination) const
 {
 	CommandBuffer commandBuffer(true);
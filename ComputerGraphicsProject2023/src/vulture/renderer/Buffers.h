@@ -11,9 +11,11 @@
 namespace vulture {
 
 class Pipeline;
+class ComputePipeline;
 class DescriptorSet;
 class Buffer;
 class SwapChain;
+class Fence;
 
 class CommandBuffer
 {
@@ -35,16 +37,29 @@ public:
 	void beginRenderPass(const RenderPass& renderPass, VkFramebuffer frameBuffer, VkExtent2D extent);
 	void bindPipeline(const Pipeline& pipeline, const SwapChain& swapChain);
 	void bindDescriptorSet(const Pipeline& pipeline, VkDescriptorSet descriptorSet, u32 set);
+	void bindPipeline(const ComputePipeline& pipeline);
+	void bindDescriptorSet(const ComputePipeline& pipeline, VkDescriptorSet descriptorSet, u32 set);
+	void pushConstants(const ComputePipeline& pipeline, const void* data, u32 size);
+	void dispatch(u32 groupCountX, u32 groupCountY, u32 groupCountZ = 1);
 	void bindVertexBuffer(const Buffer& buffer);
 	void bindIndexBuffer(const Buffer& buffer);
-	void drawIndexed(u32 indexCount);
+	void drawIndexed(u32 indexCount, u32 instanceCount = 1);
 	void endRenderPass();
 	void end();
 
+	/**
+	 * @brief Submits a single time command buffer without waiting for its completion.
+	 * The command buffer must be kept alive until the fence is signaled, its destructor waits for it.
+	 *
+	 * @param fence The unsignaled fence signaled once the commands complete.
+	 */
+	void submit(const Fence& fence);
+
 	~CommandBuffer();
 private:
 	VkCommandBuffer m_Handle = VK_NULL_HANDLE;
 	bool m_SingleTime = false;
+	VkFence m_Fence = VK_NULL_HANDLE; // Set once submitted without waiting.
 
 	void cleanup() noexcept;
 };
@@ -81,8 +96,14 @@ public:
 
 	void transitionLayout(VkImageLayout newLayout, const ImageCreationInfo& info = ImageCreationInfo::defaultImageCreateInfo, u32 baseArrayLayer = 0);
 	void copyFromBuffer(const Buffer& buffer, const ImageCreationInfo& info = ImageCreationInfo::defaultImageCreateInfo);
+	void copyToBuffer(const Buffer& buffer, const ImageCreationInfo& info = ImageCreationInfo::defaultImageCreateInfo);
 	void generateMipmaps(u32 mipLevels, u32 layerCount = 1);
 
+	// The same operations recorded in a command buffer submitted by the caller.
+	void transitionLayout(CommandBuffer& commandBuffer, VkImageLayout newLayout, const ImageCreationInfo& info = ImageCreationInfo::defaultImageCreateInfo, u32 baseArrayLayer = 0);
+	void copyToBuffer(CommandBuffer& commandBuffer, const Buffer& buffer, const ImageCreationInfo& info = ImageCreationInfo::defaultImageCreateInfo);
+	void generateMipmaps(CommandBuffer& commandBuffer, u32 mipLevels, u32 layerCount = 1);
+
 	Image operator=(const Image& other) = delete;
 	Image& operator=(Image&& other) noexcept;
 
@@ -100,6 +121,63 @@ private:
 	void cleanup() noexcept;
 };
 
+/**
+ * @brief A view of a range of mip levels of an image, destroyed together with the object.
+ * The view must not outlive the image, nor be in use by the GPU when destroyed.
+ */
+class ImageView
+{
+public:
+	/**
+	 * @brief Creates a view of some mip levels of an image.
+	 *
+	 * @param image The viewed image.
+	 * @param info The creation info of the image.
+	 * @param baseMipLevel The first viewed mip level.
+	 * @param levelCount The number of viewed mip levels.
+	 */
+	ImageView(const Image& image, const ImageCreationInfo& info, u32 baseMipLevel, u32 levelCount = 1);
+	ImageView(const ImageView& other) = delete;
+
+	inline VkImageView getHandle() const { return m_Handle; }
+
+	ImageView operator=(const ImageView& other) = delete;
+
+	~ImageView();
+private:
+	VkImageView m_Handle = VK_NULL_HANDLE;
+};
+
+/**
+ * @brief A fence signaled by the GPU once a command buffer submitted with CommandBuffer::submit completes.
+ */
+class Fence
+{
+public:
+	NO_COPY(Fence)
+
+	/**
+	 * @brief Creates an unsignaled fence.
+	 */
+	Fence();
+
+	inline VkFence getHandle() const { return m_Handle; }
+
+	/**
+	 * @brief Checks whether the fence has been signaled, without blocking.
+	 */
+	bool isSignaled() const;
+
+	/**
+	 * @brief Blocks until the fence is signaled.
+	 */
+	void wait() const;
+
+	~Fence();
+private:
+	VkFence m_Handle = VK_NULL_HANDLE;
+};
+
 class Buffer
 {
 public:
@@ -115,6 +193,8 @@ public:
 
 	void map(void* data) const;
 	void map() const;
+	void map(const void* data, VkDeviceSize offset, VkDeviceSize size) const;
+	void read(void* data) const;
 	void copyToBuffer(VkDeviceSize size, const Buffer& destination) const;
 
 	Buffer& operator=(const Buffer& other) = delete;
@@ -61,13 +61,13 @@ VkWriteDescriptorSet DescriptorWrite::getWriteDescriptorSet(VkDescriptorSet desc
 	write.dstArrayElement = 0;
 	if (m_TextureInfo)
 	{
-		write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		write.descriptorType = m_ImageType;
 		write.descriptorCount = 1;
 		write.pImageInfo = &(*m_TextureInfo);
 	}
 	else
 	{
-		write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		write.descriptorType = m_BufferType;
 		write.descriptorCount = 1;
 		write.pBufferInfo = &m_UniformInfos[index];
 	}
@@ -77,7 +77,11 @@ VkWriteDescriptorSet DescriptorWrite::getWriteDescriptorSet(VkDescriptorSet desc
 
 void DescriptorWrite::map(u32 index) const
 {
-	if (m_UniformBuffers != nullptr)
+	if (m_MapFunction)
+	{
+		m_MapFunction(index);
+	}
+	else if (m_UniformBuffers != nullptr)
 	{
 		(*m_UniformBuffers)[index].map();
 	}
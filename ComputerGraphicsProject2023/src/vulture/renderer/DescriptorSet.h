@@ -6,6 +6,9 @@
 #include <vector>
 #include <unordered_set>
 #include <optional>
+#include <functional>
+#include <algorithm>
+#include <span>
 
 namespace vulture {
 
@@ -120,6 +123,81 @@ private:
 	Type* m_LocalData = nullptr;
 };
 
+/**
+ * @class StorageBuffer
+ *
+ * @brief Represents an array of elements stored in storage buffers, one for every frame.
+ *        Only the elements modified since the last time a frame was mapped are copied to its buffer.
+ */
+template <class Type>
+class StorageBuffer
+{
+public:
+	StorageBuffer() = default;
+	StorageBuffer(const StorageBuffer& other) = delete;
+	StorageBuffer(StorageBuffer&& other) noexcept = default;
+
+	StorageBuffer(u32 count, u64 size) :
+		m_LocalData(size), m_DirtyRanges(count, { 0, size })
+	{
+		m_Buffers.reserve(count);
+
+		for (u64 i = 0; i < count; i++)
+		{
+			m_Buffers.emplace_back(sizeof(Type) * size,
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+		}
+	}
+
+	inline const std::vector<Buffer>* getBuffers() const { return &m_Buffers; }
+
+	inline u64 getSize() const { return m_LocalData.size(); }
+
+	inline const Type& operator[](u64 index) const { return m_LocalData[index]; }
+
+	/**
+	 * @brief Sets a range of elements, which are copied to the buffers the next time they are mapped.
+	 *
+	 * @param first The index of the first element to set.
+	 * @param values The new values of the elements.
+	 */
+	void set(u64 first, std::span<const Type> values)
+	{
+		std::copy(values.begin(), values.end(), m_LocalData.begin() + first);
+
+		u64 last = first + values.size();
+		for (auto& [begin, end] : m_DirtyRanges)
+		{
+			begin = begin < end ? std::min(begin, first) : first;
+			end = std::max(end, last);
+		}
+	}
+
+	/**
+	 * @brief Copies the elements modified since the last call to the buffer of a frame.
+	 *
+	 * @param index The index of the buffer (frame) to update.
+	 */
+	void map(u32 index)
+	{
+		auto& [begin, end] = m_DirtyRanges[index];
+		if (begin >= end) return;
+
+		m_Buffers[index].map(m_LocalData.data() + begin, begin * sizeof(Type), (end - begin) * sizeof(Type));
+		begin = 0;
+		end = 0;
+	}
+
+	StorageBuffer& operator=(const StorageBuffer& other) = delete;
+	StorageBuffer& operator=(StorageBuffer&& other) noexcept = default;
+private:
+	std::vector<Buffer> m_Buffers;
+	std::vector<Type> m_LocalData;
+	// The range [begin, end) of elements to be copied to each buffer.
+	std::vector<std::pair<u64, u64>> m_DirtyRanges;
+};
+
 class DescriptorWrite
 {
 public:
@@ -139,6 +217,25 @@ public:
 		}
 	}
 
+	template <class T>
+	inline DescriptorWrite(StorageBuffer<T>& storageBuffer) :
+		m_BufferType(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)
+	{
+		m_UniformBuffers = storageBuffer.getBuffers();
+
+		m_UniformInfos.reserve(m_UniformBuffers->size());
+		for (auto& buffer : (*m_UniformBuffers))
+		{
+			VkDescriptorBufferInfo bufferInfo{};
+			bufferInfo.buffer = buffer.getHandle();
+			bufferInfo.offset = 0;
+			bufferInfo.range = buffer.getSize();
+			m_UniformInfos.push_back(bufferInfo);
+		}
+
+		m_MapFunction = [&storageBuffer](u32 index) { storageBuffer.map(index); };
+	}
+
 	inline DescriptorWrite(const TextureSampler& sampler) :
 		m_UniformBuffers(nullptr)
 	{
@@ -150,6 +247,22 @@ public:
 		m_TextureInfo = imageInfo;
 	}
 
+	/**
+	 * @brief Constructs the write of a storage image, which must be in the general layout when used.
+	 *
+	 * @param storageView The view of the single mip level written or read by the shaders.
+	 */
+	inline DescriptorWrite(const ImageView& storageView) :
+		m_UniformBuffers(nullptr), m_ImageType(VK_DESCRIPTOR_TYPE_STORAGE_IMAGE)
+	{
+		VkDescriptorImageInfo imageInfo{};
+		imageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+		imageInfo.imageView = storageView.getHandle();
+		imageInfo.sampler = VK_NULL_HANDLE;
+
+		m_TextureInfo = imageInfo;
+	}
+
 	/**
 	 * @brief Gets the Vulkan write descriptor set structure for the descriptor set update.
 	 *
@@ -172,6 +285,10 @@ private:
 	std::vector<Buffer> const* m_UniformBuffers;
 	std::vector<VkDescriptorBufferInfo> m_UniformInfos;
 	std::optional<VkDescriptorImageInfo> m_TextureInfo;
+	VkDescriptorType m_ImageType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	VkDescriptorType m_BufferType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	// Used instead of mapping the whole buffers when set.
+	std::function<void(u32)> m_MapFunction;
 };
 
 /**
@@ -35,13 +35,13 @@ void FrameContext::bindDescriptorSet(const Pipeline& pipeline, const DescriptorS
 	m_CommandBuffer->bindDescriptorSet(pipeline, descriptorSet.getHandle(m_ImageIndex), set);
 }
 
-void FrameContext::drawModel(const Model& model)
+void FrameContext::drawModel(const Model& model, u32 instanceCount)
 {
 	m_CommandBuffer->bindVertexBuffer(model.getVertexBuffer());
 
 	m_CommandBuffer->bindIndexBuffer(model.getIndexBuffer());
 
-	m_CommandBuffer->drawIndexed(model.getIndexCount());
+	m_CommandBuffer->drawIndexed(model.getIndexCount(), instanceCount);
 }
 
 void FrameContext::bindVertexBuffer(const Buffer& buffer)
@@ -54,9 +54,9 @@ void FrameContext::bindIndexBuffer(const Buffer& buffer)
 	m_CommandBuffer->bindIndexBuffer(buffer);
 }
 
-void FrameContext::drawIndexed(u32 count)
+void FrameContext::drawIndexed(u32 count, u32 instanceCount)
 {
-	m_CommandBuffer->drawIndexed(count);
+	m_CommandBuffer->drawIndexed(count, instanceCount);
 }
 
 FrameContext::~FrameContext()
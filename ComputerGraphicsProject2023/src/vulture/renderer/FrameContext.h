@@ -76,8 +76,9 @@ public:
 	 * @brief Draws the specified model during rendering commands.
 	 *
 	 * @param model The model to be drawn.
+	 * @param instanceCount The number of instances to draw (default is 1).
 	 */
-	void drawModel(const Model& model);
+	void drawModel(const Model& model, u32 instanceCount = 1);
 
 	/**
 	 * @brief Binds the specified vertex buffer for rendering commands.
@@ -97,8 +98,9 @@ public:
 	 * @brief Draws indexed primitives during rendering commands.
 	 *
 	 * @param count The number of indices to draw.
+	 * @param instanceCount The number of instances to draw (default is 1).
 	 */
-	void drawIndexed(u32 count);
+	void drawIndexed(u32 count, u32 instanceCount = 1);
 
 	/**
 	 * @brief Destructor for the FrameContext class.
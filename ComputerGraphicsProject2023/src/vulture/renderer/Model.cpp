@@ -61,7 +61,7 @@ Ref<Model> Model::get(const String& name, const glm::mat4& loadTransform)
 	return result;
 }
 
-Ref<Model> Model::getPlane(u32 hCount, u32 vCount)
+Ref<Model> Model::getPlane(u32 hCount, u32 vCount, f32 skirtDepth)
 {
 	if (hCount == 0) hCount = 1;
 	if (vCount == 0) vCount = 1;
@@ -92,6 +92,37 @@ Ref<Model> Model::getPlane(u32 hCount, u32 vCount)
 		}
 	}
 
+	if (skirtDepth > 0.0f)
+	{
+		// Every border segment is extruded downwards.
+		// Skirts are double sided as they can be seen from both sides through the cracks.
+		auto addSkirtSegment = [&vertices, &indices, skirtDepth](u32 a, u32 b) {
+			u32 offset = static_cast<u32>(vertices.size());
+
+			Vertex lowA = vertices[a];
+			Vertex lowB = vertices[b];
+			lowA.pos.y -= skirtDepth;
+			lowB.pos.y -= skirtDepth;
+			vertices.push_back(lowA);
+			vertices.push_back(lowB);
+
+			indices.insert(indices.end(), { a, b, offset + 1, a, offset + 1, offset });
+			indices.insert(indices.end(), { a, offset + 1, b, a, offset, offset + 1 });
+		};
+
+		u32 rowSize = hCount + 1;
+		for (u32 x = 0; x < hCount; x++)
+		{
+			addSkirtSegment(x, x + 1);
+			addSkirtSegment(vCount * rowSize + x, vCount * rowSize + x + 1);
+		}
+		for (u32 z = 0; z < vCount; z++)
+		{
+			addSkirtSegment(z * rowSize, (z + 1) * rowSize);
+			addSkirtSegment(z * rowSize + hCount, (z + 1) * rowSize + hCount);
+		}
+	}
+
 	return Ref<Model>(new Model(vertices, indices));
 }
 
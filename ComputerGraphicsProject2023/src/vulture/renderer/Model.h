@@ -38,11 +38,15 @@ public:
 	/**
 	 * @brief Static function to create a plane model with the specified horizontal and vertical counts.
 	 *
+	 * If `skirtDepth` is greater than zero, a vertical strip of that depth is added along the border of the plane.
+	 * Skirts hide the cracks between adjacent planes whose borders are displaced differently.
+	 *
 	 * @param hCount The number of horizontal segments.
 	 * @param vCount The number of vertical segments.
+	 * @param skirtDepth The depth of the skirt below the plane.
 	 * @return A reference to the plane model.
 	 */
-	static Ref<Model> getPlane(u32 hCount = 1, u32 vCount = 1);
+	static Ref<Model> getPlane(u32 hCount = 1, u32 vCount = 1, f32 skirtDepth = 0.0f);
 
 	/**
 	 * @brief Gets the vertex buffer associated with the model.
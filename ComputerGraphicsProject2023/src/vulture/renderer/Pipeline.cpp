@@ -246,4 +246,59 @@ Pipeline::~Pipeline()
 	vkDestroyPipelineLayout(vulkanData.device, m_Layout, vulkanData.allocator);
 }
 
+ComputePipeline::ComputePipeline(
+	const String& computeShader,
+	const std::vector<DescriptorSetLayout*>& descriptorSetLayouts,
+	u32 pushConstantsSize)
+{
+	Shader shader(computeShader);
+
+	std::vector<VkDescriptorSetLayout> dsls(descriptorSetLayouts.size());
+	for (size_t i = 0; i < dsls.size(); i++)
+	{
+		dsls[i] = descriptorSetLayouts[i]->getHandle();
+	}
+
+	VkPushConstantRange pushConstantRange{};
+	pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	pushConstantRange.offset = 0;
+	pushConstantRange.size = pushConstantsSize;
+
+	VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+	pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(dsls.size());
+	pipelineLayoutInfo.pSetLayouts = dsls.data();
+	pipelineLayoutInfo.pushConstantRangeCount = pushConstantsSize > 0 ? 1 : 0;
+	pipelineLayoutInfo.pPushConstantRanges = pushConstantsSize > 0 ? &pushConstantRange : nullptr;
+
+	VkResult result = vkCreatePipelineLayout(vulkanData.device, &pipelineLayoutInfo, vulkanData.allocator, &m_Layout);
+
+	if (result != VK_SUCCESS)
+	{
+		VUERROR("Failed to create compute pipeline layout!");
+		return;
+	}
+
+	VkComputePipelineCreateInfo pipelineInfo{};
+	pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+	pipelineInfo.stage = shader.getStage(VK_SHADER_STAGE_COMPUTE_BIT);
+	pipelineInfo.layout = m_Layout;
+	pipelineInfo.basePipelineHandle = VK_NULL_HANDLE; // Optional
+	pipelineInfo.basePipelineIndex = -1;			  // Optional
+
+	result = vkCreateComputePipelines(vulkanData.device, VK_NULL_HANDLE, 1, &pipelineInfo, vulkanData.allocator, &m_Handle);
+
+	if (result != VK_SUCCESS)
+	{
+		VUERROR("Failed to create compute pipeline!");
+		return;
+	}
+}
+
+ComputePipeline::~ComputePipeline()
+{
+	vkDestroyPipeline(vulkanData.device, m_Handle, vulkanData.allocator);
+	vkDestroyPipelineLayout(vulkanData.device, m_Layout, vulkanData.allocator);
+}
+
 } // namespace vulture
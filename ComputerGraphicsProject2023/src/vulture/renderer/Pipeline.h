@@ -134,4 +134,43 @@ private:
 	VkPipelineLayout m_Layout = VK_NULL_HANDLE;
 };
 
+/**
+ * @class ComputePipeline
+ *
+ * @brief Represents a Vulkan compute pipeline.
+ */
+class ComputePipeline
+{
+public:
+	NO_COPY(ComputePipeline)
+
+	/**
+	 * @brief Constructor for the ComputePipeline class.
+	 *
+	 * @param computeShader The name of the compute shader used in the pipeline.
+	 * @param descriptorSetLayouts A vector of DescriptorSetLayout pointers used in the pipeline.
+	 * @param pushConstantsSize The size in bytes of the push constants used by the shader (default is 0).
+	 */
+	ComputePipeline(const String& computeShader, const std::vector<DescriptorSetLayout*>& descriptorSetLayouts, u32 pushConstantsSize = 0);
+
+	/**
+	 * @brief Gets the Vulkan handle of the pipeline.
+	 *
+	 * @return The Vulkan handle of the pipeline.
+	 */
+	inline VkPipeline getHandle() const { return m_Handle; }
+
+	/**
+	 * @brief Gets the Vulkan handle of the pipeline layout.
+	 *
+	 * @return The Vulkan handle of the pipeline layout.
+	 */
+	inline VkPipelineLayout getLayout() const { return m_Layout; }
+
+	~ComputePipeline();
+private:
+	VkPipeline m_Handle = VK_NULL_HANDLE;
+	VkPipelineLayout m_Layout = VK_NULL_HANDLE;
+};
+
 } // namespace vulture
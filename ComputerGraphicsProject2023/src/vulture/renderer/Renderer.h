@@ -92,6 +92,15 @@ public:
 	 */
 	template <class T> static inline Uniform<T> makeUniform() { return Uniform<T>(getImageCount()); }
 
+	/**
+	 * @brief Creates a StorageBuffer for the Renderer with the specified element type and size.
+	 *
+	 * @tparam T Type of the elements stored in the buffer.
+	 * @param size The number of elements.
+	 * @return StorageBuffer instance created with the Renderer's swap chain image count.
+	 */
+	template <class T> static inline StorageBuffer<T> makeStorageBuffer(u64 size) { return StorageBuffer<T>(getImageCount(), size); }
+
 	/**
 	 * @brief Gets the default VertexLayout used by the Renderer .
 	 *
@@ -34,8 +34,8 @@ bool loadTexture2DPixels(const String& name, u8** pixels, u32& width, u32& heigh
 
 void populateArrayGenerator(f32* pixels, u32 width, u32 height, glm::vec2 position, glm::vec2 dimension, std::function<glm::vec4(f32, f32)> generator)
 {
-	for (u64 y = 0; y < height; y++)
-	{
+	// The generator is expected to be thread safe, rows are filled in parallel.
+	Job::parallelFor(0, height, 8, [&](u64 y) {
 		for (u64 x = 0; x < width; x++)
 		{
 			f32 noiseX = dimension.x * static_cast<f32>(x) / (width - 1);
@@ -48,7 +48,7 @@ void populateArrayGenerator(f32* pixels, u32 width, u32 height, glm::vec2 positi
 			pixels[(y * width + x) * 4 + 1] = color.g; // g
 			pixels[(y * width + x) * 4 + 0] = color.b; // b
 		}
-	}
+	});
 }
 
 Ref<Texture> Texture::get(const String& name)
@@ -123,99 +123,96 @@ Ref<Texture> Texture::make(u32 width, u32 height, glm::vec2 position, glm::vec2
 	return result;
 }
 
-struct AsyncTextureLoadingData
+Ref<Texture> Texture::make(u32 width, u32 height, f32* pixels)
 {
-	u8* pixels = nullptr;
-	u32 width = 0;
-	u32 height = 0;
-};
+	return Ref<Texture>(new Texture(width, height, pixels));
+}
+
+Ref<PendingTexture> Texture::generate(u32 width, u32 height, const TextureComputeInfo& computeInfo, bool readback)
+{
+	Ref<PendingTexture> pending(new PendingTexture);
+	if (readback)
+	{
+		VkDeviceSize imageSize = width * 4LL * height * sizeof(f32);
+		pending->m_ReadbackBuffer = Buffer(imageSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+	}
+
+	pending->m_Texture = Ref<Texture>(new Texture(width, height, computeInfo, *pending));
+	return pending;
+}
 
-void Texture::getAsync(const String& name, std::function<void(Ref<Texture>)> callback)
+Task<Ref<Texture>> Texture::load(String name)
 {
 	auto it = s_Textures.find(name);
 	if (it != s_Textures.end())
 	{
 		auto& wref = it->second;
 		if (!wref.expired())
-		{
-			callback(wref.lock());
-			return;
-		}
+			co_return wref.lock();
 		else
 			s_Textures.erase(it);
 	}
 
-	AsyncTextureLoadingData* data = new AsyncTextureLoadingData;
-	Job::submit([name](void* _data) -> bool
+	u8* pixels = nullptr;
+	u32 width = 0, height = 0;
+
+	co_await Job::io();
+	bool loaded = loadTexture2DPixels(name, &pixels, width, height);
+	co_await Job::mainThread();
+
+	Ref<Texture> result;
+	if (loaded)
 	{
-		AsyncTextureLoadingData* loadingData = reinterpret_cast<AsyncTextureLoadingData*>(_data);
-		return loadTexture2DPixels(name, &loadingData->pixels, loadingData->width, loadingData->height);
-	}, data, [name, callback](bool result, void* _data)
+		result = Ref<Texture>(new Texture(width, height, pixels, false));
+		s_Textures.insert({ name, result });
+	}
+	else
 	{
-		AsyncTextureLoadingData* loadingData = reinterpret_cast<AsyncTextureLoadingData*>(_data);
-		Ref<Texture> texture;
-		if (result)
-		{
-			texture = Ref<Texture>(new Texture(loadingData->width, loadingData->height, loadingData->pixels, false));
-			s_Textures.insert({ name, texture });
-		}
-		else
-		{
-			texture = s_Default2D;
-		}
-
-		callback(texture);
-		delete[] loadingData->pixels;
-		delete loadingData;
+		result = s_Default2D;
 	}
-	);
+
+	delete[] pixels;
+	co_return result;
 }
 
-void Texture::getCubemapAsync(const String& name, std::function<void(Ref<Texture>)> callback)
+Task<Ref<Texture>> Texture::loadCubemap(String name)
 {
 	auto it = s_CubemapTextures.find(name);
 	if (it != s_CubemapTextures.end())
 	{
 		auto& wref = it->second;
 		if (!wref.expired())
-		{
-			callback(wref.lock());
-			return;
-		}
+			co_return wref.lock();
 		else
 			s_CubemapTextures.erase(it);
 	}
 
-	AsyncTextureLoadingData* data = new AsyncTextureLoadingData;
-	Job::submit([name](void* _data) -> bool
+	u8* pixels = nullptr;
+	u32 width = 0, height = 0;
+
+	co_await Job::io();
+	bool loaded = loadCubemapPixels(name, &pixels, width, height);
+	co_await Job::mainThread();
+
+	Ref<Texture> result;
+	if (loaded)
 	{
-		AsyncTextureLoadingData* loadingData = reinterpret_cast<AsyncTextureLoadingData*>(_data);
-		return loadCubemapPixels(name, &loadingData->pixels, loadingData->width, loadingData->height);
-	}, data, [name, callback](bool result, void* _data)
+		result = Ref<Texture>(new Texture(width, height, pixels, true));
+		s_CubemapTextures.insert({ name, result });
+	}
+	else
 	{
-		AsyncTextureLoadingData* loadingData = reinterpret_cast<AsyncTextureLoadingData*>(_data);
-		Ref<Texture> texture;
-		if (result)
-		{
-			texture = Ref<Texture>(new Texture(loadingData->width, loadingData->height, loadingData->pixels, true));
-			s_CubemapTextures.insert({ name, texture });
-		}
-		else
-		{
-			texture = s_DefaultCubemap;
-		}
-
-		callback(texture);
-		delete[] loadingData->pixels;
-		delete loadingData;
+		result = s_DefaultCubemap;
 	}
-	);
+
+	delete[] pixels;
+	co_return result;
 }
 
-void Texture::makeAsync(u32 width, u32 height, glm::vec2 position, glm::vec2 dimension, std::function<glm::vec4(f32, f32)> generator, std::function<void(Ref<Texture>)> callback)
+JobHandle Texture::makeAsync(u32 width, u32 height, glm::vec2 position, glm::vec2 dimension, std::function<glm::vec4(f32, f32)> generator, std::function<void(Ref<Texture>)> callback)
 {
 	f32* data = new f32[width * 4LL * height];
-	Job::submit([width, height, position, dimension, generator](void* _data) -> bool
+	return Job::submit([width, height, position, dimension, generator](void* _data) -> bool
 	{
 		f32* pixels = reinterpret_cast<f32*>(_data);
 		populateArrayGenerator(pixels, width, height, position, dimension, generator);
@@ -223,6 +220,12 @@ void Texture::makeAsync(u32 width, u32 height, glm::vec2 position, glm::vec2 dim
 	}, data, [width, height, callback](bool result, void* _data)
 	{
 		f32* pixels = reinterpret_cast<f32*>(_data);
+		if (Job::getStopToken().stopRequested())
+		{
+			delete[] pixels;
+			return;
+		}
+
 		Ref<Texture> texture;
 		if (result)
 		{
@@ -315,12 +318,65 @@ Texture::Texture(u32 width, u32 height, f32* pixels)
 	m_Image.generateMipmaps(m_MipLevels);
 }
 
+Texture::Texture(u32 width, u32 height, const TextureComputeInfo& computeInfo, PendingTexture& pending)
+{
+	m_MipLevels = static_cast<u32>(std::floor(std::log2(std::max(width, height)))) + 1;
+
+	ImageCreationInfo info{};
+	info.mipLevels = m_MipLevels;
+	info.format = VK_FORMAT_R32G32B32A32_SFLOAT;
+
+	m_Image = Image(width, height,
+					VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+					info);
+
+	// Only the first mip level is written, the others are generated from it afterwards.
+	pending.m_StorageView = makeRef<ImageView>(m_Image, info, 0);
+	pending.m_StorageSet = s_StorageImagePool->getDescriptorSet(s_StorageImageLayout, { DescriptorWrite(*pending.m_StorageView) });
+
+	// Everything is recorded in a single command buffer, submitted without waiting.
+	pending.m_CommandBuffer = CommandBuffer(true);
+	CommandBuffer& commandBuffer = pending.m_CommandBuffer;
+	m_Image.transitionLayout(commandBuffer, VK_IMAGE_LAYOUT_GENERAL, info);
+
+	commandBuffer.bindPipeline(*computeInfo.pipeline);
+	commandBuffer.bindDescriptorSet(*computeInfo.pipeline, pending.m_StorageSet->getHandle(0), 0);
+	if (computeInfo.descriptorSet)
+		commandBuffer.bindDescriptorSet(*computeInfo.pipeline, computeInfo.descriptorSet->getHandle(0), 1);
+	if (computeInfo.pushConstants)
+		commandBuffer.pushConstants(*computeInfo.pipeline, computeInfo.pushConstants, computeInfo.pushConstantsSize);
+
+	u32 groupSize = std::max(computeInfo.workGroupSize, 1u);
+	commandBuffer.dispatch((width + groupSize - 1) / groupSize, (height + groupSize - 1) / groupSize);
+
+	if (pending.m_ReadbackBuffer.getHandle() != VK_NULL_HANDLE)
+		m_Image.copyToBuffer(commandBuffer, pending.m_ReadbackBuffer, info);
+
+	m_Image.transitionLayout(commandBuffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, info);
+	m_Image.generateMipmaps(commandBuffer, m_MipLevels);
+
+	commandBuffer.submit(pending.m_Fence);
+}
+
 Texture::~Texture() = default;
 
+void PendingTexture::read(f32* pixels) const
+{
+	if (m_ReadbackBuffer.getHandle() == VK_NULL_HANDLE)
+	{
+		VUWARN("Trying to read a texture generated without readback.");
+		return;
+	}
+
+	m_ReadbackBuffer.read(pixels);
+}
+
 std::unordered_map<String, WRef<Texture>> Texture::s_Textures = {};
 std::unordered_map<String, WRef<Texture>> Texture::s_CubemapTextures = {};
 Ref<Texture> Texture::s_Default2D;
 Ref<Texture> Texture::s_DefaultCubemap;
+Ref<DescriptorSetLayout> Texture::s_StorageImageLayout;
+Ref<DescriptorPool> Texture::s_StorageImagePool;
 
 void Texture::makeDefaultTexture2D()
 {
@@ -399,6 +455,14 @@ bool Texture::init()
 	makeDefaultTexture2D();
 	makeDefaultCubemap();
 
+	s_StorageImageLayout = makeRef<DescriptorSetLayout>();
+	s_StorageImageLayout->addBinding(VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT);
+	if (!s_StorageImageLayout->create())
+		return false;
+
+	// Every generation has its own set, kept until its commands complete, so one handle per set is enough.
+	s_StorageImagePool = makeRef<DescriptorPool>(1);
+
 	return true;
 }
 
@@ -409,6 +473,9 @@ void Texture::cleanup()
 
 	s_Default2D.reset();
 	s_DefaultCubemap.reset();
+
+	s_StorageImagePool.reset();
+	s_StorageImageLayout.reset();
 }
 
 TextureSampler::TextureSampler(const Texture& texture, const TextureSamplerConfig& config)
@@ -1,9 +1,32 @@
 #pragma once
 
 #include "Buffers.h"
+#include "vulture/core/Job.h"
+#include "vulture/core/Task.h"
 
 namespace vulture {
 
+class ComputePipeline;
+class DescriptorSet;
+class DescriptorSetLayout;
+class DescriptorPool;
+class PendingTexture;
+
+/**
+ * @brief Structure describing the compute dispatch that writes the pixels of a texture.
+ *
+ * The shader receives the texture as a `rgba32f` storage image at binding 0 of set 0,
+ * whose layout is given by Texture::getStorageImageLayout, and is dispatched with one invocation per pixel.
+ */
+struct TextureComputeInfo
+{
+	const ComputePipeline* pipeline = nullptr; /**< The pipeline to dispatch. */
+	const DescriptorSet* descriptorSet = nullptr; /**< An optional descriptor set bound to set 1. */
+	const void* pushConstants = nullptr; /**< The optional push constants data. */
+	u32 pushConstantsSize = 0; /**< The size in bytes of the push constants data. */
+	u32 workGroupSize = 16; /**< The local size of the shader along both axes. */
+};
+
 /**
  * @brief Enumeration representing the type of texture.
  */
@@ -61,20 +84,59 @@ public:
 	static Ref<Texture> make(u32 width, u32 height, glm::vec2 position, glm::vec2 dimension, std::function<glm::vec4(f32, f32)> generator);
 
 	/**
-	 * @brief Static function to asynchronously retrieve a reference to the specified 2D texture and call a user-provided callback function.
+	 * @brief Static function to create a new floating-point texture from an array of BGRA pixels.
+	 *
+	 * @param width The width of the texture.
+	 * @param height The height of the texture.
+	 * @param pixels A pointer to `width * height * 4` floating-point values.
+	 * @return A reference to the newly created texture.
+	 */
+	static Ref<Texture> make(u32 width, u32 height, f32* pixels);
+
+	/**
+	 * @brief Static function to create a new floating-point texture whose pixels are written by a compute shader.
+	 *
+	 * The commands are submitted without waiting for the GPU, the texture must not be used before the
+	 * returned object is ready.
+	 *
+	 * @param width The width of the texture.
+	 * @param height The height of the texture.
+	 * @param computeInfo The compute dispatch generating the pixels.
+	 * @param readback Whether the generated pixels are copied back to be read by the CPU.
+	 * @return The texture being generated.
+	 */
+	static Ref<PendingTexture> generate(u32 width, u32 height, const TextureComputeInfo& computeInfo, bool readback = false);
+
+	/**
+	 * @brief Gets the layout of the descriptor set binding the texture written by a compute shader.
+	 *
+	 * @return A reference to the descriptor set layout, to be used as the first layout of the compute pipelines.
+	 */
+	static inline Ref<DescriptorSetLayout> getStorageImageLayout() { return s_StorageImageLayout; }
+
+	/**
+	 * @brief Coroutine retrieving a reference to the specified 2D texture.
+	 *
+	 * The pixels are decoded on a worker thread and the texture is created on the main thread,
+	 * where the awaiting coroutine is resumed.
 	 *
 	 * @param name The unique identifier of the 2D texture to retrieve.
-	 * @param callback The user-provided callback function to be called with the reference to the texture.
+	 *
+	 * @return A task producing the texture, or the default texture if `name` is invalid.
 	 */
-	static void getAsync(const String& name, std::function<void(Ref<Texture>)> callback);
+	static Task<Ref<Texture>> load(String name);
 
 	/**
-	 * @brief Static function to asynchronously retrieve a reference to the specified cube map texture and call a user-provided callback function.
+	 * @brief Coroutine retrieving a reference to the specified cube map texture.
+	 *
+	 * The pixels are decoded on a worker thread and the texture is created on the main thread,
+	 * where the awaiting coroutine is resumed.
 	 *
 	 * @param name The unique identifier of the cube map texture to retrieve.
-	 * @param callback The user-provided callback function to be called with the reference to the texture.
+	 *
+	 * @return A task producing the texture, or the default cube map texture if `name` is invalid.
 	 */
-	static void getCubemapAsync(const String& name, std::function<void(Ref<Texture>)> callback);
+	static Task<Ref<Texture>> loadCubemap(String name);
 
 	/**
 	 * @brief Static function to asynchronously create a new texture with the specified parameters and a user-provided pixel data generator,
@@ -86,8 +148,11 @@ public:
 	 * @param dimension The dimension of the texture in 2D space.
 	 * @param generator The user-provided function to generate pixel data for the texture.
 	 * @param callback The user-provided callback function to be called with the reference to the texture.
+	 *                 It is not called if the returned job is cancelled.
+	 *
+	 * @return The generation job.
 	 */
-	static void makeAsync(u32 width, u32 height, glm::vec2 position, glm::vec2 dimension, std::function<glm::vec4(f32, f32)> generator, std::function<void(Ref<Texture>)> callback);
+	static JobHandle makeAsync(u32 width, u32 height, glm::vec2 position, glm::vec2 dimension, std::function<glm::vec4(f32, f32)> generator, std::function<void(Ref<Texture>)> callback);
 
 	/**
 	 * @brief Gets the ImageView associated with the texture.
@@ -149,6 +214,16 @@ private:
 	 */
 	Texture(u32 width, u32 height, f32* pixels);
 
+	/**
+	 * @brief Constructor for the `Texture` class, recording the commands creating the texture with a compute shader.
+	 *
+	 * @param width The width of the texture.
+	 * @param height The height of the texture.
+	 * @param computeInfo The compute dispatch generating the pixels.
+	 * @param pending Receives the commands and the resources they use, and submits them.
+	 */
+	Texture(u32 width, u32 height, const TextureComputeInfo& computeInfo, PendingTexture& pending);
+
 	/**
 	 * @brief Helper function to load the texture from a pixel array.
 	 *
@@ -178,11 +253,62 @@ private:
 	static std::unordered_map<String, WRef<Texture>> s_CubemapTextures;
 	static Ref<Texture> s_Default2D;
 	static Ref<Texture> s_DefaultCubemap;
+	static Ref<DescriptorSetLayout> s_StorageImageLayout;
+	static Ref<DescriptorPool> s_StorageImagePool;
 
 	static void makeDefaultTexture2D();
 	static void makeDefaultCubemap();
 };
 
+/**
+ * @brief Texture whose pixels are being written by a compute shader, see Texture::generate.
+ *
+ * The GPU works while the CPU goes on, isReady polls it without blocking.
+ * Destroying the object before it is ready waits for the GPU.
+ */
+class PendingTexture
+{
+public:
+	NO_COPY(PendingTexture)
+
+	/**
+	 * @brief Checks whether the GPU has finished generating the texture, without blocking.
+	 */
+	inline bool isReady() const { return m_Fence.isSignaled(); }
+
+	/**
+	 * @brief Blocks until the GPU has finished generating the texture.
+	 */
+	inline void wait() const { m_Fence.wait(); }
+
+	/**
+	 * @brief Gets the generated texture, which must not be used before it is ready.
+	 */
+	inline const Ref<Texture>& getTexture() const { return m_Texture; }
+
+	/**
+	 * @brief Copies the generated pixels, once ready.
+	 *
+	 * @param pixels Receives the `width * height * 4` generated values, only if the texture was generated with readback.
+	 */
+	void read(f32* pixels) const;
+
+	~PendingTexture() = default;
+private:
+	friend class Texture;
+
+	PendingTexture() = default;
+
+	Ref<Texture> m_Texture;
+	Fence m_Fence;
+	// The resources used by the commands, released once they complete.
+	Ref<ImageView> m_StorageView;
+	Ref<DescriptorSet> m_StorageSet;
+	Buffer m_ReadbackBuffer;
+	// Destroyed first, waiting for the fence.
+	CommandBuffer m_CommandBuffer;
+};
+
 /**
  * @brief Structure representing the configuration of a texture sampler.
  */
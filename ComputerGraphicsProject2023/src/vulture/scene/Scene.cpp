@@ -5,8 +5,8 @@
 
 namespace vulture {
 
-RenderableObject::RenderableObject(Ref<Model> model, Ref<DescriptorSet> descriptorSet) :
-	m_Model(model), m_DescriptorSet(descriptorSet)
+RenderableObject::RenderableObject(Ref<Model> model, Ref<DescriptorSet> descriptorSet, u32 instanceCount) :
+	m_Model(model), m_DescriptorSet(descriptorSet), m_InstanceCount(instanceCount)
 {}
 
 SceneObjectList::SceneObjectList(const String& vertexShader,
@@ -27,9 +27,10 @@ void SceneObjectList::removeObject(ObjectHandle handle)
 	m_Objects.erase(it);
 }
 
-Scene::Scene() :
+Scene::Scene(BroadphaseType broadphase) :
 	m_DescriptorsPool(Renderer::makeDescriptorPool()),
-	m_Camera(m_DescriptorsPool), m_Skybox(m_DescriptorsPool), m_UIHandler(m_DescriptorsPool), m_World(m_DescriptorsPool)
+	m_Camera(m_DescriptorsPool), m_Skybox(m_DescriptorsPool), m_UIHandler(m_DescriptorsPool), m_World(m_DescriptorsPool),
+	m_CollisionEngine(broadphase)
 {
 	// Create the default Phong GameObject DSL.
 	m_GameObjectDSL = Ref<DescriptorSetLayout>(new DescriptorSetLayout());
@@ -154,14 +155,14 @@ PipelineHandle Scene::makePipeline(const String& vertexShader, const String& fra
 	return handle;
 }
 
-ObjectHandle Scene::addObject(PipelineHandle pipeline, Ref<Model> model, Ref<DescriptorSet> descriptorSet)
+ObjectHandle Scene::addObject(PipelineHandle pipeline, Ref<Model> model, Ref<DescriptorSet> descriptorSet, u32 instanceCount)
 {
 	auto p = m_ObjectLists.find(pipeline);
 	if(p != m_ObjectLists.end())
 	{
 		auto handle = GameObject::s_NextHandle++;
 
-		p->second.addObject(handle, RenderableObject(model, descriptorSet));
+		p->second.addObject(handle, RenderableObject(model, descriptorSet, instanceCount));
 
 		setModified();
 		return handle;
@@ -285,7 +286,7 @@ void Scene::recordCommandBuffer(FrameContext& target)
 		{
 			target.bindDescriptorSet(pipeline, object.getDescriptorSet(), 0);
 
-			target.drawModel(object.getModel());
+			target.drawModel(object.getModel(), object.getInstanceCount());
 		}
 	}
 
@@ -29,8 +29,9 @@ public:
 	 *
 	 * @param model The model associated with the renderable object.
 	 * @param descriptorSet The descriptor set associated with the renderable object.
+	 * @param instanceCount The number of instances drawn with a single draw call.
 	 */
-	RenderableObject(Ref<Model> model, Ref<DescriptorSet> descriptorSet);
+	RenderableObject(Ref<Model> model, Ref<DescriptorSet> descriptorSet, u32 instanceCount = 1);
 
 	/**
 	 * @brief Gets the descriptor set associated with the renderable object.
@@ -45,9 +46,17 @@ public:
 	 * @return The reference to the model associated with the renderable object.
 	 */
 	inline const Model& getModel() { return *m_Model.get(); }
+
+	/**
+	 * @brief Gets the number of instances of the model drawn.
+	 *
+	 * @return The number of instances.
+	 */
+	inline u32 getInstanceCount() const { return m_InstanceCount; }
 private:
 	Ref<Model> m_Model;
 	Ref<DescriptorSet> m_DescriptorSet;
+	u32 m_InstanceCount;
 };
 
 /**
@@ -115,7 +124,12 @@ private:
 class Scene
 {
 public:
-	Scene();
+	/**
+	 * @brief Constructs an empty scene.
+	 *
+	 * @param broadphase The algorithm used by the collision engine to find the candidate pairs of colliding hit boxes.
+	 */
+	explicit Scene(BroadphaseType broadphase = BroadphaseType::SPATIAL_HASH_GRID);
 
 	/**
 	 * @brief Renders the scene using the provided frame context and delta time.
@@ -161,9 +175,10 @@ public:
 	 * @param pipeline The handle of the rendering pipeline to use for the object.
 	 * @param model The model associated with the object.
 	 * @param descriptorSet The descriptor set associated with the object.
+	 * @param instanceCount The number of instances of the model to draw, the shaders can tell them apart by gl_InstanceIndex.
 	 * @return The handle of the newly added object.
 	 */
-	ObjectHandle addObject(PipelineHandle pipeline, Ref<Model> model, Ref<DescriptorSet> descriptorSet);
+	ObjectHandle addObject(PipelineHandle pipeline, Ref<Model> model, Ref<DescriptorSet> descriptorSet, u32 instanceCount = 1);
 
 	/**
 	 * @brief Removes an object from the scene.
@@ -232,6 +247,13 @@ public:
 	 */
 	inline void removeHitbox(Ref<HitBox> hitbox) { m_CollisionEngine.removeHitbox(hitbox); }
 
+	/**
+	 * @brief Recomputes the bounds of a static hitbox whose shapes changed, without ending its contacts.
+	 *
+	 * @param hitbox The reference to the hitbox to be updated.
+	 */
+	inline void updateStaticHitbox(Ref<HitBox> hitbox) { m_CollisionEngine.updateStaticHitbox(hitbox); }
+
 	/**
 	 * @brief Gets a pointer to the camera used in the scene.
 	 *
@@ -260,6 +282,13 @@ public:
 	 */
 	DescriptorPool* getDescriptorPool() { return &m_DescriptorsPool; }
 
+	/**
+	 * @brief Gets a pointer to the collision engine used in the scene, which also answers the spatial queries.
+	 *
+	 * @return A pointer to the collision engine used in the scene.
+	 */
+	CollisionEngine* getCollisionEngine() { return &m_CollisionEngine; }
+
 	inline Ref<DescriptorSetLayout> getDefaultDSL() { return m_GameObjectDSL; }
 
 	inline void setPaused(bool paused) { m_Paused = paused; }
@@ -77,25 +77,36 @@ void Skybox::set(const String& name)
 {
 	if (m_CurrentName != name)
 	{
+		// A texture still loading must not replace the new one.
+		(*m_LoadGeneration)++;
+
 		if (name.isEmpty())
 		{
 			m_DescriptorSet.reset();
 		}
 		else
 		{
-			Texture::getCubemapAsync(name, [this](Ref<Texture> texture) {
-				m_Texture = texture;
-				m_TextureSampler = makeRef<TextureSampler>(*m_Texture);
-				m_DescriptorSet.reset();
-				m_DescriptorSet = m_DescriptorPool->getDescriptorSet(m_DSLayout, { m_Uniform, *m_TextureSampler });
-				emit(SkyboxRecreated{});
-			});
+			loadTexture(name, m_LoadGeneration, *m_LoadGeneration).detach();
 		}
 		m_CurrentName = name;
 		emit(SkyboxRecreated{});
 	}
 }
 
+Task<> Skybox::loadTexture(String name, WRef<u32> loadGeneration, u32 generation)
+{
+	Ref<Texture> texture = co_await Texture::loadCubemap(name);
+
+	auto currentGeneration = loadGeneration.lock();
+	if (!currentGeneration || *currentGeneration != generation) co_return;
+
+	m_Texture = texture;
+	m_TextureSampler = makeRef<TextureSampler>(*m_Texture);
+	m_DescriptorSet.reset();
+	m_DescriptorSet = m_DescriptorPool->getDescriptorSet(m_DSLayout, { m_Uniform, *m_TextureSampler });
+	emit(SkyboxRecreated{});
+}
+
 void Skybox::recordCommandBuffer(FrameContext& target)
 {
 	if (m_DescriptorSet)
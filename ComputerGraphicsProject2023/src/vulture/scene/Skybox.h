@@ -2,6 +2,7 @@
 #include "vulture/renderer/FrameContext.h"
 #include "vulture/scene/Camera.h"
 #include "vulture/event/Event.h"
+#include "vulture/core/Task.h"
 
 namespace vulture {
 
@@ -32,6 +33,9 @@ private:
 	Skybox(DescriptorPool& descriptorsPool);
 
 	String m_CurrentName = "";
+	// Incremented by every set: a texture still loading is only used if no other was set meanwhile.
+	// The loads hold it weakly, so that they do not use a destroyed skybox either.
+	Ref<u32> m_LoadGeneration = makeRef<u32>(0);
 
 	DescriptorPool* m_DescriptorPool;
 
@@ -48,6 +52,8 @@ private:
 	Buffer m_IndexBuffer;
 	constexpr static u32 c_IndexCount = 36;
 
+	Task<> loadTexture(String name, WRef<u32> loadGeneration, u32 generation);
+
 	void recordCommandBuffer(FrameContext& target);
 	void updateUniforms(FrameContext& target, const Camera& camera);
 
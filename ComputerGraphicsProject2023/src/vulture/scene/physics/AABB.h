@@ -0,0 +1,105 @@
+#pragma once
+
+#include "vulture/util/Types.h"
+
+#include <algorithm> // std::min, std::max
+
+namespace vulture {
+
+/**
+ * @brief Axis aligned bounding box.
+ */
+struct AABB
+{
+	glm::vec3 min = glm::vec3(0.0f);
+	glm::vec3 max = glm::vec3(0.0f);
+
+	/**
+	 * @brief Checks whether this box and another one intersect, touching boxes included.
+	 */
+	inline bool overlaps(const AABB& other) const
+	{
+		return min.x <= other.max.x && max.x >= other.min.x &&
+			min.y <= other.max.y && max.y >= other.min.y &&
+			min.z <= other.max.z && max.z >= other.min.z;
+	}
+
+	/**
+	 * @brief Checks whether another box is entirely inside this box.
+	 */
+	inline bool contains(const AABB& other) const
+	{
+		return min.x <= other.min.x && min.y <= other.min.y && min.z <= other.min.z &&
+			max.x >= other.max.x && max.y >= other.max.y && max.z >= other.max.z;
+	}
+
+	/**
+	 * @brief Computes the smallest box containing both this box and another one.
+	 */
+	inline AABB merge(const AABB& other) const
+	{
+		return AABB{ glm::min(min, other.min), glm::max(max, other.max) };
+	}
+
+	/**
+	 * @brief Computes the box grown by the same amount in every direction.
+	 */
+	inline AABB expand(f32 amount) const
+	{
+		return AABB{ min - glm::vec3(amount), max + glm::vec3(amount) };
+	}
+
+	/**
+	 * @brief Computes the surface area of the box.
+	 */
+	inline f32 getSurfaceArea() const
+	{
+		glm::vec3 size = max - min;
+		return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+	}
+
+	/**
+	 * @brief Computes the squared distance between a point and the box, 0 if the point is inside.
+	 */
+	inline f32 getDistanceSquared(glm::vec3 point) const
+	{
+		glm::vec3 offset = glm::max(glm::max(min - point, point - max), glm::vec3(0.0f));
+		return glm::dot(offset, offset);
+	}
+
+	/**
+	 * @brief Intersects a ray with the box using the slab method.
+	 *
+	 * @param origin The origin of the ray.
+	 * @param inverseDirection The component-wise inverse of the direction of the ray.
+	 * @param maxDistance The length of the ray.
+	 * @param distance Receives the distance at which the ray enters the box, 0 if the origin is inside.
+	 *
+	 * @return true if the ray hits the box within maxDistance, false otherwise.
+	 */
+	inline bool intersectsRay(glm::vec3 origin, glm::vec3 inverseDirection, f32 maxDistance, f32& distance) const
+	{
+		glm::vec3 t0 = (min - origin) * inverseDirection;
+		glm::vec3 t1 = (max - origin) * inverseDirection;
+		glm::vec3 tMin = glm::min(t0, t1);
+		glm::vec3 tMax = glm::max(t0, t1);
+
+		f32 enter = std::max(std::max(tMin.x, tMin.y), std::max(tMin.z, 0.0f));
+		f32 exit = std::min(std::min(tMax.x, tMax.y), std::min(tMax.z, maxDistance));
+
+		distance = enter;
+		return enter <= exit;
+	}
+};
+
+/**
+ * @brief Pair of indices of two objects whose bounding boxes overlap.
+ * Within a single set of objects the first index is always the smaller one.
+ */
+struct CollisionPair
+{
+	u32 first;
+	u32 second;
+};
+
+} // namespace vulture
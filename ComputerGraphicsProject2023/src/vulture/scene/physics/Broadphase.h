@@ -0,0 +1,82 @@
+#pragma once
+
+#include "vulture/core/Core.h"
+#include "AABB.h"
+
+#include <vector>
+
+namespace vulture {
+
+/**
+ * @brief The algorithms available to find the candidate pairs of colliding hit boxes.
+ *
+ *   - SPATIAL_HASH_GRID: rebuilds a uniform grid over the XZ plane every frame.
+ *   - SWEEP_AND_PRUNE: keeps the boxes sorted along one axis between the frames.
+ *   - DYNAMIC_TREE: keeps the boxes in a bounding volume hierarchy, also used for the spatial queries.
+ */
+enum class BroadphaseType
+{
+	SPATIAL_HASH_GRID,
+	SWEEP_AND_PRUNE,
+	DYNAMIC_TREE
+};
+
+/**
+ * @brief Base class for the algorithms finding the pairs of overlapping bounding boxes.
+ *
+ * The boxes are identified by their index in a dense array owned by the caller, which notifies
+ * the broadphase when a box is added at the end or when one is removed by moving the last box in its place.
+ * Whenever the boxes change the caller updates the broadphase with the current boxes, then every frame
+ * it finds the pairs among them, or between them and another set of boxes, passing the same boxes again.
+ */
+class Broadphase
+{
+public:
+	/**
+	 * @brief Brings the broadphase up to date with the current boxes.
+	 *
+	 * @param bounds The boxes, identified by their index.
+	 */
+	virtual void update(const std::vector<AABB>& bounds) = 0;
+
+	/**
+	 * @brief Finds all the pairs of overlapping boxes.
+	 *
+	 * @param bounds The boxes passed to the last update.
+	 * @param pairs The vector the pairs are appended to.
+	 */
+	virtual void findPairs(const std::vector<AABB>& bounds, std::vector<CollisionPair>& pairs) = 0;
+
+	/**
+	 * @brief Finds all the pairs made of one of the boxes and an overlapping box of another set.
+	 * The boxes of the other set are not tested against each other.
+	 *
+	 * @param bounds The boxes passed to the last update.
+	 * @param others The other boxes, identified by their index.
+	 * @param pairs The vector the pairs are appended to, with first the index in bounds and second the index in others.
+	 */
+	virtual void findPairs(const std::vector<AABB>& bounds, const std::vector<AABB>& others, std::vector<CollisionPair>& pairs) = 0;
+
+	/**
+	 * @brief Notifies the broadphase that a box has been added.
+	 *
+	 * @param index The index of the new box, equal to the previous number of boxes.
+	 */
+	virtual void onAdded(u32 index) = 0;
+
+	/**
+	 * @brief Notifies the broadphase that a box has been removed.
+	 *
+	 * @param index The index of the removed box.
+	 * @param lastIndex The index of the box that has been moved in place of the removed one.
+	 *                  It is equal to index if the removed box was the last one.
+	 */
+	virtual void onRemoved(u32 index, u32 lastIndex) = 0;
+
+	/**
+	 * @brief Virtual destructor for proper cleanup of derived classes.
+	 */
+	virtual ~Broadphase() = default;
+};
+
+} // namespace vulture
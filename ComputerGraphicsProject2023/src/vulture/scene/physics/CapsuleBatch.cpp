@@ -0,0 +1,220 @@
+#include "CapsuleBatch.h"
+
+#if defined(__AVX__)
+#define VU_CAPSULE_BATCH_AVX
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VU_CAPSULE_BATCH_SSE2
+#include <emmintrin.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+
+namespace vulture {
+
+/*
+ * Each set of lanes provides the same operations, so that the test is written once.
+ * A mask is the result of a comparison, with one bit per lane in getBits.
+ */
+
+struct ScalarLanes
+{
+	using Float = f32;
+	using Mask = bool;
+	static constexpr u32 WIDTH = 1;
+
+	static inline Float gather(const f32* values, const u32* indices) { return values[indices[0]]; }
+	static inline Float set(f32 value) { return value; }
+	static inline Float add(Float a, Float b) { return a + b; }
+	static inline Float sub(Float a, Float b) { return a - b; }
+	static inline Float mul(Float a, Float b) { return a * b; }
+	static inline Float div(Float a, Float b) { return a / b; }
+	static inline Float sqrt(Float a) { return std::sqrt(a); }
+	static inline Float clamp01(Float a) { return std::clamp(a, 0.0f, 1.0f); }
+	static inline Mask less(Float a, Float b) { return a < b; }
+	static inline Mask lessEqual(Float a, Float b) { return a <= b; }
+	static inline Mask either(Mask a, Mask b) { return a || b; }
+	static inline Float select(Mask mask, Float a, Float b) { return mask ? a : b; }
+	static inline u32 getBits(Mask mask) { return mask ? 1 : 0; }
+};
+
+#if defined(VU_CAPSULE_BATCH_AVX)
+
+struct AVXLanes
+{
+	using Float = __m256;
+	using Mask = __m256;
+	static constexpr u32 WIDTH = 8;
+
+	static inline Float gather(const f32* values, const u32* indices)
+	{
+		return _mm256_setr_ps(values[indices[0]], values[indices[1]], values[indices[2]], values[indices[3]],
+			values[indices[4]], values[indices[5]], values[indices[6]], values[indices[7]]);
+	}
+	static inline Float set(f32 value) { return _mm256_set1_ps(value); }
+	static inline Float add(Float a, Float b) { return _mm256_add_ps(a, b); }
+	static inline Float sub(Float a, Float b) { return _mm256_sub_ps(a, b); }
+	static inline Float mul(Float a, Float b) { return _mm256_mul_ps(a, b); }
+	static inline Float div(Float a, Float b) { return _mm256_div_ps(a, b); }
+	static inline Float sqrt(Float a) { return _mm256_sqrt_ps(a); }
+	static inline Float clamp01(Float a) { return _mm256_max_ps(_mm256_min_ps(a, _mm256_set1_ps(1.0f)), _mm256_setzero_ps()); }
+	static inline Mask less(Float a, Float b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+	static inline Mask lessEqual(Float a, Float b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+	static inline Mask either(Mask a, Mask b) { return _mm256_or_ps(a, b); }
+	static inline Float select(Mask mask, Float a, Float b) { return _mm256_blendv_ps(b, a, mask); }
+	static inline u32 getBits(Mask mask) { return static_cast<u32>(_mm256_movemask_ps(mask)); }
+};
+
+using WideLanes = AVXLanes;
+
+#elif defined(VU_CAPSULE_BATCH_SSE2)
+
+struct SSE2Lanes
+{
+	using Float = __m128;
+	using Mask = __m128;
+	static constexpr u32 WIDTH = 4;
+
+	static inline Float gather(const f32* values, const u32* indices)
+	{
+		return _mm_setr_ps(values[indices[0]], values[indices[1]], values[indices[2]], values[indices[3]]);
+	}
+	static inline Float set(f32 value) { return _mm_set1_ps(value); }
+	static inline Float add(Float a, Float b) { return _mm_add_ps(a, b); }
+	static inline Float sub(Float a, Float b) { return _mm_sub_ps(a, b); }
+	static inline Float mul(Float a, Float b) { return _mm_mul_ps(a, b); }
+	static inline Float div(Float a, Float b) { return _mm_div_ps(a, b); }
+	static inline Float sqrt(Float a) { return _mm_sqrt_ps(a); }
+	static inline Float clamp01(Float a) { return _mm_max_ps(_mm_min_ps(a, _mm_set1_ps(1.0f)), _mm_setzero_ps()); }
+	static inline Mask less(Float a, Float b) { return _mm_cmplt_ps(a, b); }
+	static inline Mask lessEqual(Float a, Float b) { return _mm_cmple_ps(a, b); }
+	static inline Mask either(Mask a, Mask b) { return _mm_or_ps(a, b); }
+	static inline Float select(Mask mask, Float a, Float b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+	static inline u32 getBits(Mask mask) { return static_cast<u32>(_mm_movemask_ps(mask)); }
+};
+
+using WideLanes = SSE2Lanes;
+
+#else
+
+using WideLanes = ScalarLanes;
+
+#endif
+
+const u32 CapsuleBatch::LANES = WideLanes::WIDTH;
+
+template <class L>
+struct LaneVec3
+{
+	typename L::Float x, y, z;
+
+	static inline LaneVec3 gather(const std::vector<f32>& x, const std::vector<f32>& y, const std::vector<f32>& z, const u32* indices)
+	{
+		return { L::gather(x.data(), indices), L::gather(y.data(), indices), L::gather(z.data(), indices) };
+	}
+
+	inline LaneVec3 operator+(const LaneVec3& o) const { return { L::add(x, o.x), L::add(y, o.y), L::add(z, o.z) }; }
+	inline LaneVec3 operator-(const LaneVec3& o) const { return { L::sub(x, o.x), L::sub(y, o.y), L::sub(z, o.z) }; }
+	inline LaneVec3 operator*(typename L::Float s) const { return { L::mul(x, s), L::mul(y, s), L::mul(z, s) }; }
+
+	inline typename L::Float dot(const LaneVec3& o) const
+	{
+		return L::add(L::add(L::mul(x, o.x), L::mul(y, o.y)), L::mul(z, o.z));
+	}
+
+	static inline LaneVec3 select(typename L::Mask mask, const LaneVec3& a, const LaneVec3& b)
+	{
+		return { L::select(mask, a.x, b.x), L::select(mask, a.y, b.y), L::select(mask, a.z, b.z) };
+	}
+};
+
+// Same as closestPointOnLineSegment, lane by lane.
+template <class L>
+static inline LaneVec3<L> closestPoint(const LaneVec3<L>& a, const LaneVec3<L>& b, const LaneVec3<L>& point)
+{
+	LaneVec3<L> AB = b - a;
+	typename L::Float lengthSquared = AB.dot(AB);
+	typename L::Float t = L::div((point - a).dot(AB), lengthSquared);
+	t = L::select(L::lessEqual(lengthSquared, L::set(0.0f)), L::set(0.0f), L::clamp01(t));
+	return a + AB * t;
+}
+
+template <class L>
+void CapsuleBatch::testRange(const std::vector<CapsulePair>& pairs, u64 begin, u64 end, std::vector<u8>& results) const
+{
+	constexpr u32 W = L::WIDTH;
+
+	u32 first[W];
+	u32 second[W];
+
+	for (u64 p = begin; p + W <= end; p += W)
+	{
+		for (u32 lane = 0; lane < W; lane++)
+		{
+			first[lane] = pairs[p + lane].first;
+			second[lane] = pairs[p + lane].second;
+		}
+
+		using V = LaneVec3<L>;
+		V c0A = V::gather(m_AX, m_AY, m_AZ, first);
+		V c0B = V::gather(m_BX, m_BY, m_BZ, first);
+		V c1A = V::gather(m_AX, m_AY, m_AZ, second);
+		V c1B = V::gather(m_BX, m_BY, m_BZ, second);
+
+		V v0 = c1A - c0A;
+		V v1 = c1B - c0A;
+		V v2 = c1A - c0B;
+		V v3 = c1B - c0B;
+
+		typename L::Float d0 = v0.dot(v0);
+		typename L::Float d1 = v1.dot(v1);
+		typename L::Float d2 = v2.dot(v2);
+		typename L::Float d3 = v3.dot(v3);
+
+		typename L::Mask useB = L::either(L::either(L::less(d2, d0), L::less(d2, d1)), L::either(L::less(d3, d0), L::less(d3, d1)));
+		V bestC0 = V::select(useB, c0B, c0A);
+
+		V bestC1 = closestPoint<L>(c1A, c1B, bestC0);
+		bestC0 = closestPoint<L>(c0A, c0B, bestC1);
+
+		V penetration = bestC0 - bestC1;
+		typename L::Float length = L::sqrt(penetration.dot(penetration));
+		typename L::Float radii = L::add(L::gather(m_Radius.data(), first), L::gather(m_Radius.data(), second));
+
+		u32 bits = L::getBits(L::less(length, radii));
+		for (u32 lane = 0; lane < W; lane++)
+		{
+			results[p + lane] = static_cast<u8>((bits >> lane) & 1);
+		}
+	}
+}
+
+void CapsuleBatch::clear()
+{
+	m_AX.clear(); m_AY.clear(); m_AZ.clear();
+	m_BX.clear(); m_BY.clear(); m_BZ.clear();
+	m_Radius.clear();
+}
+
+u32 CapsuleBatch::add(glm::vec3 a, glm::vec3 b, f32 radius)
+{
+	m_AX.push_back(a.x); m_AY.push_back(a.y); m_AZ.push_back(a.z);
+	m_BX.push_back(b.x); m_BY.push_back(b.y); m_BZ.push_back(b.z);
+	m_Radius.push_back(radius);
+	return static_cast<u32>(m_Radius.size() - 1);
+}
+
+void CapsuleBatch::testPairs(const std::vector<CapsulePair>& pairs, u64 begin, u64 end, std::vector<u8>& results) const
+{
+	u64 wideEnd = end - (end - begin) % WideLanes::WIDTH;
+	testRange<WideLanes>(pairs, begin, wideEnd, results);
+	testRange<ScalarLanes>(pairs, wideEnd, end, results);
+}
+
+void CapsuleBatch::testPairsScalar(const std::vector<CapsulePair>& pairs, u64 begin, u64 end, std::vector<u8>& results) const
+{
+	testRange<ScalarLanes>(pairs, begin, end, results);
+}
+
+} // namespace vulture
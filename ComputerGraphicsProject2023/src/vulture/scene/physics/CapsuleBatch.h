@@ -0,0 +1,78 @@
+#pragma once
+
+#include "vulture/core/Core.h"
+
+#include <vector>
+
+namespace vulture {
+
+/**
+ * @brief Pair of indices of two capsules in a CapsuleBatch.
+ */
+struct CapsulePair
+{
+	u32 first;
+	u32 second;
+};
+
+/**
+ * @brief Capsules stored as a structure of arrays, so that many pairs can be tested with SIMD instructions.
+ *
+ * Each capsule is stored as the segment used by the narrowphase and its radius.
+ * The pairs are tested LANES at a time with the same algorithm as testCollisionCapsuleCapsule:
+ * 8 at a time when the engine is compiled with AVX, 4 with SSE2 (always available on x64)
+ * and one at a time otherwise.
+ */
+class CapsuleBatch
+{
+public:
+	/**
+	 * @brief Removes all the capsules.
+	 */
+	void clear();
+
+	/**
+	 * @brief Adds a capsule.
+	 *
+	 * @param a The first end of the segment.
+	 * @param b The second end of the segment.
+	 * @param radius The radius of the capsule.
+	 *
+	 * @return The index of the capsule.
+	 */
+	u32 add(glm::vec3 a, glm::vec3 b, f32 radius);
+
+	inline u32 getSize() const { return static_cast<u32>(m_Radius.size()); }
+
+	/**
+	 * @brief Tests a range of pairs of capsules using the widest instructions available.
+	 * Disjoint ranges of the same pairs can be tested by different threads at the same time.
+	 *
+	 * @param pairs The indices of the capsules to test.
+	 * @param begin The first pair to test.
+	 * @param end One past the last pair to test.
+	 * @param results Receives the result of each tested pair at its index, it must be as large as pairs.
+	 */
+	void testPairs(const std::vector<CapsulePair>& pairs, u64 begin, u64 end, std::vector<u8>& results) const;
+
+	/**
+	 * @brief Tests a range of pairs of capsules one at a time, the reference for testPairs.
+	 *
+	 * @param pairs The indices of the capsules to test.
+	 * @param begin The first pair to test.
+	 * @param end One past the last pair to test.
+	 * @param results Receives the result of each tested pair at its index, it must be as large as pairs.
+	 */
+	void testPairsScalar(const std::vector<CapsulePair>& pairs, u64 begin, u64 end, std::vector<u8>& results) const;
+
+	static const u32 LANES;
+private:
+	std::vector<f32> m_AX, m_AY, m_AZ;
+	std::vector<f32> m_BX, m_BY, m_BZ;
+	std::vector<f32> m_Radius;
+
+	template <class Lanes>
+	void testRange(const std::vector<CapsulePair>& pairs, u64 begin, u64 end, std::vector<u8>& results) const;
+};
+
+} // namespace vulture
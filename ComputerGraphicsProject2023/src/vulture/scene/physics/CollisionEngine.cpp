@@ -1,58 +1,593 @@
 #include "CollisionEngine.h"
 
+#include "SpatialHashGrid.h"
+#include "SweepAndPrune.h"
+#include "DynamicTreeBroadphase.h"
+
+#include <algorithm> // std::any_of, std::find_if, std::sort
+
 namespace vulture {
 
-void CollisionEngine::update(f32 dt)
+static Ref<Broadphase> makeBroadphase(BroadphaseType type)
 {
-	for (auto& hitbox : m_HitBoxes)
+	switch (type)
 	{
-		hitbox->applyTransform();
+	case BroadphaseType::SWEEP_AND_PRUNE:
+		return makeRef<SweepAndPrune>();
+	case BroadphaseType::DYNAMIC_TREE:
+		return makeRef<DynamicTreeBroadphase>();
+	case BroadphaseType::SPATIAL_HASH_GRID:
+	default:
+		return makeRef<SpatialHashGrid>();
 	}
+}
+
+bool CollisionEngine::precedes(const Contact& a, const Contact& b)
+{
+	return a.first < b.first || (a.first == b.first && a.second < b.second);
+}
 
-	auto outerIt = m_HitBoxes.begin();
-	while (outerIt != m_HitBoxes.end())
+CollisionEngine::CollisionEngine(BroadphaseType broadphase) :
+	c_BroadphaseType(broadphase), m_QueryTree(makeRef<DynamicTreeBroadphase>())
+{}
+
+void CollisionEngine::update(f32 dt)
+{
+	m_Updating = true;
+
+	m_Capsules.clear();
+	m_CapsuleRanges.resize(m_HitBoxes.size());
+	for (u32 i = 0; i < m_HitBoxes.size(); i++)
 	{
-		auto& hitbox1 = *outerIt;
-		auto innerIt = ++outerIt;
-		while (innerIt != m_HitBoxes.end())
+		auto& hitbox = m_HitBoxes[i];
+
+		// The layer mask and the static flag can be changed at any time.
+		const LayerBucket& bucket = m_Buckets[m_BucketSlots[i].bucket];
+		if (hitbox->layerMask != bucket.layerMask || isStatic(*hitbox) != bucket.isStatic)
 		{
-			auto& hitbox2 = *innerIt;
+			removeFromBucket(i);
+			addToBucket(i);
+		}
 
-			if ((hitbox1->collisionMask & hitbox2->layerMask) != 0 ||
-				(hitbox2->collisionMask & hitbox1->layerMask) != 0)
+		// The static hit boxes keep the bounds computed when they were added, the sleeping ones those of the previous update.
+		if (!isStatic(*hitbox) && hasMoved(i))
+		{
+			hitbox->applyTransform();
+			AABB bounds = hitbox->m_Bounds;
+
+			glm::vec3 position = hitbox->transform->getPosition();
+			m_Displacements[i] = hitbox->fast ? position - m_Positions[i] : glm::vec3(0.0f);
+			m_Positions[i] = position;
+			if (hitbox->fast)
 			{
-				for (auto& shape1 : *hitbox1)
+				// The broadphase must find the pairs along the whole movement.
+				bounds = bounds.merge(AABB{ bounds.min - m_Displacements[i], bounds.max - m_Displacements[i] });
+			}
+			setBounds(i, bounds);
+		}
+		else if (m_Displacements[i] != glm::vec3(0.0f))
+		{
+			// A fast hit box that stopped no longer needs its bounds to enclose a movement.
+			m_Displacements[i] = glm::vec3(0.0f);
+			setBounds(i, hitbox->m_Bounds);
+		}
+
+		m_CapsuleRanges[i] = packCapsules(*hitbox);
+	}
+
+	findPairs();
+
+	m_NarrowphasePairs.clear();
+	m_CapsulePairs.clear();
+	for (auto [first, second] : m_Pairs)
+	{
+		auto& hitbox1 = m_HitBoxes[first];
+		auto& hitbox2 = m_HitBoxes[second];
+
+		bool firstCollides = (hitbox1->collisionMask & hitbox2->layerMask) != 0;
+		bool secondCollides = (hitbox2->collisionMask & hitbox1->layerMask) != 0;
+		if (!firstCollides && !secondCollides) continue;
+
+		const CapsuleRange& range1 = m_CapsuleRanges[first];
+		const CapsuleRange& range2 = m_CapsuleRanges[second];
+
+		// The swept pairs are tested one by one.
+		bool swept = hitbox1->fast || hitbox2->fast;
+
+		u32 capsulePairsBegin = static_cast<u32>(m_CapsulePairs.size());
+		u32 capsulePairsEnd = CapsuleRange::NOT_BATCHED;
+		if (!swept && range1.count != CapsuleRange::NOT_BATCHED && range2.count != CapsuleRange::NOT_BATCHED)
+		{
+			for (u32 capsule1 = range1.first; capsule1 < range1.first + range1.count; capsule1++)
+			{
+				for (u32 capsule2 = range2.first; capsule2 < range2.first + range2.count; capsule2++)
 				{
-					for (auto& shape2 : *hitbox2)
-					{
- 						if (shape1->testCollision(shape2))
-						{
-							if ((hitbox1->collisionMask & hitbox2->layerMask) != 0)
-							{
-								hitbox1->registerCollidingHitbox(hitbox2);
-							}
-							if ((hitbox2->collisionMask & hitbox1->layerMask) != 0)
-							{
-								hitbox2->registerCollidingHitbox(hitbox1);
-							}
-						}
-					}
+					m_CapsulePairs.push_back({ capsule1, capsule2 });
 				}
 			}
-			hitbox1->update();
-			innerIt++;
+			capsulePairsEnd = static_cast<u32>(m_CapsulePairs.size());
+		}
+
+		m_NarrowphasePairs.push_back({ first, second, capsulePairsBegin, capsulePairsEnd, firstCollides, secondCollides, swept });
+	}
+	m_TestedPairsCount = m_NarrowphasePairs.size();
+
+	m_CapsuleResults.resize(m_CapsulePairs.size());
+	Job::parallelForChunks(0, m_CapsulePairs.size(), CAPSULE_PAIRS_GRAIN, [this](u64 begin, u64 end, u32) {
+		m_Capsules.testPairs(m_CapsulePairs, begin, end, m_CapsuleResults);
+	});
+
+	m_ContactBuffers.resize(Job::getParallelism());
+	for (auto& buffer : m_ContactBuffers)
+	{
+		buffer.clear();
+	}
+
+	Job::parallelForChunks(0, m_NarrowphasePairs.size(), NARROWPHASE_PAIRS_GRAIN, [this](u64 begin, u64 end, u32 participant) {
+		auto& contacts = m_ContactBuffers[participant];
+		for (u64 i = begin; i < end; i++)
+		{
+			const NarrowphasePair& pair = m_NarrowphasePairs[i];
+
+			bool collides;
+			f32 timeOfImpact = 1.0f;
+			if (pair.swept)
+			{
+				collides = m_HitBoxes[pair.first]->sweep(*m_HitBoxes[pair.second],
+					m_Displacements[pair.first], m_Displacements[pair.second], timeOfImpact);
+			}
+			else if (pair.capsulePairsEnd == CapsuleRange::NOT_BATCHED)
+			{
+				collides = m_HitBoxes[pair.first]->testCollision(*m_HitBoxes[pair.second]);
+			}
+			else
+			{
+				auto results = m_CapsuleResults.begin();
+				collides = std::any_of(results + pair.capsulePairsBegin, results + pair.capsulePairsEnd, [](u8 result) { return result != 0; });
+			}
+
+			if (collides)
+			{
+				contacts.push_back({ pair.first, pair.second, timeOfImpact, pair.firstCollides, pair.secondCollides });
+			}
 		}
+	});
+
+	// The split of the pairs between the threads changes from run to run,
+	// the contacts are sorted so that the events are always emitted in the same order.
+	m_Contacts.clear();
+	for (auto& buffer : m_ContactBuffers)
+	{
+		m_Contacts.insert(m_Contacts.end(), buffer.begin(), buffer.end());
 	}
+	std::sort(m_Contacts.begin(), m_Contacts.end(), precedes);
+
+	emitEvents();
+
+	m_Updating = false;
+
+	for (auto& hitbox : m_PendingRemovals)
+	{
+		eraseHitbox(hitbox);
+	}
+	m_PendingRemovals.clear();
+
+	for (auto& hitbox : m_PendingAdditions)
+	{
+		insertHitbox(hitbox);
+	}
+	m_PendingAdditions.clear();
+}
+
+void CollisionEngine::emitEvents()
+{
+	for (auto [index, data] : m_PendingExits)
+	{
+		m_HitBoxes[index]->emit(HitBoxExited{ data });
+	}
+	m_PendingExits.clear();
+
+	// Both the contacts are sorted, so a single pass finds the ones present in only one of them.
+	auto previous = m_PreviousContacts.begin();
+	auto current = m_Contacts.begin();
+	while (previous != m_PreviousContacts.end() || current != m_Contacts.end())
+	{
+		bool hasPrevious = previous != m_PreviousContacts.end() && (current == m_Contacts.end() || !precedes(*current, *previous));
+		bool hasCurrent = current != m_Contacts.end() && (previous == m_PreviousContacts.end() || !precedes(*previous, *current));
+
+		const Contact& contact = hasCurrent ? *current : *previous;
+		auto& hitbox1 = m_HitBoxes[contact.first];
+		auto& hitbox2 = m_HitBoxes[contact.second];
+
+		// The masks may have changed, so each side of a lasting contact is checked as well.
+		bool firstEntered = hasCurrent && current->firstCollides;
+		bool secondEntered = hasCurrent && current->secondCollides;
+		bool firstWasColliding = hasPrevious && previous->firstCollides;
+		bool secondWasColliding = hasPrevious && previous->secondCollides;
+
+		if (firstEntered && !firstWasColliding)
+			hitbox1->emit(HitBoxEntered{ hitbox2->data, hitbox2->layerMask, current->timeOfImpact });
+		else if (!firstEntered && firstWasColliding)
+			hitbox1->emit(HitBoxExited{ hitbox2->data });
+
+		if (secondEntered && !secondWasColliding)
+			hitbox2->emit(HitBoxEntered{ hitbox1->data, hitbox1->layerMask, current->timeOfImpact });
+		else if (!secondEntered && secondWasColliding)
+			hitbox2->emit(HitBoxExited{ hitbox1->data });
+
+		if (hasPrevious) previous++;
+		if (hasCurrent) current++;
+	}
+
+	std::swap(m_PreviousContacts, m_Contacts);
+}
+
+void CollisionEngine::findPairs()
+{
+	m_Pairs.clear();
+
+	for (auto& bucket : m_Buckets)
+	{
+		bucket.collisionMask = 0;
+		for (u32 index : bucket.hitboxes)
+		{
+			bucket.collisionMask |= m_HitBoxes[index]->collisionMask;
+		}
+	}
+
+	u32 bucketsCount = static_cast<u32>(m_Buckets.size());
+	m_BucketsInteract.assign(static_cast<u64>(bucketsCount) * bucketsCount, 0);
+	for (u32 a = 0; a < bucketsCount; a++)
+	{
+		LayerBucket& bucketA = m_Buckets[a];
+		if (bucketA.hitboxes.empty()) continue;
+
+		bool interacts = false;
+		for (u32 b = 0; b < bucketsCount; b++)
+		{
+			const LayerBucket& bucketB = m_Buckets[b];
+			if (bucketB.hitboxes.empty()) continue;
+
+			bool interact = (bucketA.collisionMask & bucketB.layerMask) != 0 || (bucketB.collisionMask & bucketA.layerMask) != 0;
+			interact = interact && !(bucketA.isStatic && bucketB.isStatic);
+			m_BucketsInteract[a * bucketsCount + b] = interact;
+			interacts = interacts || interact;
+		}
+
+		// The buckets that interact with none are left out of date until they do.
+		if (interacts && bucketA.dirty)
+		{
+			bucketA.broadphase->update(bucketA.bounds);
+			bucketA.dirty = false;
+		}
+	}
+
+	auto addPair = [this](u32 first, u32 second) {
+		m_Pairs.push_back(first < second ? CollisionPair{ first, second } : CollisionPair{ second, first });
+	};
+
+	for (u32 a = 0; a < bucketsCount; a++)
+	{
+		const LayerBucket& bucketA = m_Buckets[a];
+
+		if (m_BucketsInteract[a * bucketsCount + a])
+		{
+			m_BucketPairs.clear();
+			bucketA.broadphase->findPairs(bucketA.bounds, m_BucketPairs);
+			for (auto [i, j] : m_BucketPairs)
+			{
+				addPair(bucketA.hitboxes[i], bucketA.hitboxes[j]);
+			}
+		}
+
+		for (u32 b = a + 1; b < bucketsCount; b++)
+		{
+			if (!m_BucketsInteract[a * bucketsCount + b]) continue;
+
+			// The broadphase of the larger bucket is searched with the boxes of the smaller one.
+			const LayerBucket& bucketB = m_Buckets[b];
+			const LayerBucket& searched = bucketA.hitboxes.size() >= bucketB.hitboxes.size() ? bucketA : bucketB;
+			const LayerBucket& searching = &searched == &bucketA ? bucketB : bucketA;
+
+			m_BucketPairs.clear();
+			searched.broadphase->findPairs(searched.bounds, searching.bounds, m_BucketPairs);
+			for (auto [i, j] : m_BucketPairs)
+			{
+				addPair(searched.hitboxes[i], searching.hitboxes[j]);
+			}
+		}
+	}
+}
+
+bool CollisionEngine::isStatic(const HitBox& hitbox)
+{
+	return hitbox.isStatic || !hitbox.transform;
+}
+
+bool CollisionEngine::hasMoved(u32 index)
+{
+	const Transform* transform = m_HitBoxes[index]->transform.get();
+	TransformState& state = m_TransformStates[index];
+	if (state.transform == transform && state.version == transform->getVersion()) return false;
+
+	state = { transform, transform->getVersion() };
+	return true;
+}
+
+void CollisionEngine::setBounds(u32 index, const AABB& bounds)
+{
+	m_Bounds[index] = bounds;
+
+	auto [bucket, position] = m_BucketSlots[index];
+	m_Buckets[bucket].bounds[position] = bounds;
+	m_Buckets[bucket].dirty = true;
+	m_QueryTreeDirty = true;
+}
+
+void CollisionEngine::addToBucket(u32 index)
+{
+	u64 layerMask = m_HitBoxes[index]->layerMask;
+	bool isStaticHitbox = isStatic(*m_HitBoxes[index]);
+	auto it = std::find_if(m_Buckets.begin(), m_Buckets.end(), [layerMask, isStaticHitbox](const LayerBucket& bucket) {
+		return bucket.layerMask == layerMask && bucket.isStatic == isStaticHitbox;
+	});
+	if (it == m_Buckets.end())
+	{
+		m_Buckets.push_back({ layerMask, isStaticHitbox, 0, {}, {}, makeBroadphase(c_BroadphaseType), true });
+		it = m_Buckets.end() - 1;
+	}
+
+	u32 position = static_cast<u32>(it->hitboxes.size());
+	it->hitboxes.push_back(index);
+	it->bounds.push_back(m_Bounds[index]);
+	it->broadphase->onAdded(position);
+	it->dirty = true;
+
+	m_BucketSlots[index] = { static_cast<u32>(it - m_Buckets.begin()), position };
+}
+
+void CollisionEngine::removeFromBucket(u32 index)
+{
+	auto [bucketIndex, position] = m_BucketSlots[index];
+	LayerBucket& bucket = m_Buckets[bucketIndex];
+
+	// The last hit box of the bucket takes the place of the removed one.
+	u32 lastPosition = static_cast<u32>(bucket.hitboxes.size() - 1);
+	bucket.hitboxes[position] = bucket.hitboxes.back();
+	bucket.bounds[position] = bucket.bounds.back();
+	m_BucketSlots[bucket.hitboxes[position]].position = position;
+	bucket.hitboxes.pop_back();
+	bucket.bounds.pop_back();
+
+	bucket.broadphase->onRemoved(position, lastPosition);
+	bucket.dirty = true;
+}
+
+CollisionEngine::CapsuleRange CollisionEngine::packCapsules(const HitBox& hitbox)
+{
+	CapsuleRange range{ m_Capsules.getSize(), 0 };
+	for (auto& shape : hitbox.m_Shapes)
+	{
+		// Hit boxes with other shapes are tested shape by shape.
+		if (shape->c_Type != CollisionShapeType::CAPSULE)
+		{
+			range.count = CapsuleRange::NOT_BATCHED;
+			return range;
+		}
+
+		auto* capsule = static_cast<const CapsuleCollisionShape*>(shape.get());
+		glm::vec3 a, b;
+		capsule->getSegment(a, b);
+		m_Capsules.add(a, b, capsule->getRadius());
+		range.count++;
+	}
+	return range;
 }
 
 void CollisionEngine::addHitbox(Ref<HitBox> hitbox)
 {
-	m_HitBoxes.insert(hitbox);
+	if (m_Updating)
+		m_PendingAdditions.push_back(hitbox);
+	else
+		insertHitbox(hitbox);
 }
 
 void CollisionEngine::removeHitbox(Ref<HitBox> hitbox)
 {
-	m_HitBoxes.erase(hitbox);
+	if (m_Updating)
+	{
+		std::erase(m_PendingAdditions, hitbox);
+		m_PendingRemovals.push_back(hitbox);
+	}
+	else
+	{
+		eraseHitbox(hitbox);
+	}
+}
+
+void CollisionEngine::updateStaticHitbox(Ref<HitBox> hitbox)
+{
+	u32 index = hitbox->m_EngineIndex;
+	if (index >= m_HitBoxes.size() || m_HitBoxes[index] != hitbox) return;
+
+	hitbox->applyTransform();
+	setBounds(index, hitbox->m_Bounds);
+}
+
+void CollisionEngine::insertHitbox(const Ref<HitBox>& hitbox)
+{
+	if (hitbox->m_EngineIndex != HitBox::INVALID_ENGINE_INDEX) return;
+
+	// The bounds are needed by the queries made before the next update, and by the static colliders.
+	hitbox->applyTransform();
+
+	hitbox->m_EngineIndex = static_cast<u32>(m_HitBoxes.size());
+	m_HitBoxes.push_back(hitbox);
+	m_Bounds.push_back(hitbox->m_Bounds);
+	// The movement of a fast hit box is measured from where it is added.
+	m_Positions.push_back(hitbox->transform ? hitbox->transform->getPosition() : glm::vec3(0.0f));
+	m_Displacements.push_back(glm::vec3(0.0f));
+	// The hit box sleeps until its transform changes.
+	m_TransformStates.push_back({ hitbox->transform.get(), hitbox->transform ? hitbox->transform->getVersion() : 0 });
+	m_BucketSlots.emplace_back();
+	addToBucket(hitbox->m_EngineIndex);
+
+	m_QueryTree->onAdded(hitbox->m_EngineIndex);
+	m_QueryTreeDirty = true;
+}
+
+void CollisionEngine::eraseHitbox(const Ref<HitBox>& hitbox)
+{
+	u32 index = hitbox->m_EngineIndex;
+	if (index >= m_HitBoxes.size() || m_HitBoxes[index] != hitbox) return;
+
+	removeFromBucket(index);
+
+	// The contacts of the removed hit box end, and the hit boxes colliding with it exit at the next update.
+	std::erase_if(m_PendingExits, [index](const PendingExit& exit) { return exit.hitbox == index; });
+	std::erase_if(m_PreviousContacts, [this, index, &hitbox](const Contact& contact) {
+		if (contact.first != index && contact.second != index) return false;
+
+		if (contact.first == index && contact.secondCollides) m_PendingExits.push_back({ contact.second, hitbox->data });
+		if (contact.second == index && contact.firstCollides) m_PendingExits.push_back({ contact.first, hitbox->data });
+		return true;
+	});
+
+	// The last hit box takes the place of the removed one.
+	u32 lastIndex = static_cast<u32>(m_HitBoxes.size() - 1);
+	m_HitBoxes[index] = std::move(m_HitBoxes.back());
+	m_HitBoxes[index]->m_EngineIndex = index;
+	m_HitBoxes.pop_back();
+
+	m_Bounds[index] = m_Bounds.back();
+	m_Bounds.pop_back();
+
+	m_Positions[index] = m_Positions.back();
+	m_Positions.pop_back();
+	m_Displacements[index] = m_Displacements.back();
+	m_Displacements.pop_back();
+	m_TransformStates[index] = m_TransformStates.back();
+	m_TransformStates.pop_back();
+
+	m_BucketSlots[index] = m_BucketSlots.back();
+	m_BucketSlots.pop_back();
+	if (index != lastIndex)
+	{
+		auto [bucket, position] = m_BucketSlots[index];
+		m_Buckets[bucket].hitboxes[position] = index;
+		renumberContacts(lastIndex, index);
+	}
+
+	hitbox->m_EngineIndex = HitBox::INVALID_ENGINE_INDEX;
+	m_QueryTree->onRemoved(index, lastIndex);
+	m_QueryTreeDirty = true;
+}
+
+void CollisionEngine::renumberContacts(u32 from, u32 to)
+{
+	for (auto& exit : m_PendingExits)
+	{
+		if (exit.hitbox == from) exit.hitbox = to;
+	}
+
+	bool renumbered = false;
+	for (auto& contact : m_PreviousContacts)
+	{
+		if (contact.first != from && contact.second != from) continue;
+
+		if (contact.first == from) contact.first = to;
+		if (contact.second == from) contact.second = to;
+		if (contact.first > contact.second)
+		{
+			std::swap(contact.first, contact.second);
+			std::swap(contact.firstCollides, contact.secondCollides);
+		}
+		renumbered = true;
+	}
+
+	if (renumbered) std::sort(m_PreviousContacts.begin(), m_PreviousContacts.end(), precedes);
+}
+
+const DynamicAABBTree& CollisionEngine::getQueryTree()
+{
+	if (m_QueryTreeDirty)
+	{
+		m_QueryTree->update(m_Bounds);
+		m_QueryTreeDirty = false;
+	}
+	return m_QueryTree->getTree();
+}
+
+void CollisionEngine::queryBox(const AABB& box, std::vector<Ref<HitBox>>& result, u64 layerMask)
+{
+	result.clear();
+
+	const DynamicAABBTree& tree = getQueryTree();
+	tree.query(box, [&](u32 proxy) {
+		u32 index = tree.getUserData(proxy);
+		if ((m_HitBoxes[index]->layerMask & layerMask) != 0 && m_Bounds[index].overlaps(box))
+		{
+			result.push_back(m_HitBoxes[index]);
+		}
+		return true;
+	});
+}
+
+void CollisionEngine::querySphere(glm::vec3 center, f32 radius, std::vector<Ref<HitBox>>& result, u64 layerMask)
+{
+	result.clear();
+
+	const DynamicAABBTree& tree = getQueryTree();
+	tree.querySphere(center, radius, [&](u32 proxy) {
+		u32 index = tree.getUserData(proxy);
+		if ((m_HitBoxes[index]->layerMask & layerMask) != 0 && m_HitBoxes[index]->getDistance(center) <= radius)
+		{
+			result.push_back(m_HitBoxes[index]);
+		}
+		return true;
+	});
+}
+
+void CollisionEngine::queryNearest(glm::vec3 point, u32 count, std::vector<Ref<HitBox>>& result, u64 layerMask)
+{
+	const DynamicAABBTree& tree = getQueryTree();
+
+	std::vector<u32> proxies;
+	tree.queryNearest(point, count, [&](u32 proxy) {
+		u32 index = tree.getUserData(proxy);
+		if ((m_HitBoxes[index]->layerMask & layerMask) == 0) return -1.0f;
+		return m_HitBoxes[index]->getDistance(point);
+	}, proxies);
+
+	result.clear();
+	for (u32 proxy : proxies)
+	{
+		result.push_back(m_HitBoxes[tree.getUserData(proxy)]);
+	}
+}
+
+bool CollisionEngine::raycast(glm::vec3 origin, glm::vec3 direction, f32 maxDistance, RaycastHit& hit, u64 layerMask)
+{
+	direction = glm::normalize(direction);
+	hit.hitbox = nullptr;
+
+	const DynamicAABBTree& tree = getQueryTree();
+	tree.raycast(origin, direction, maxDistance, [&](u32 proxy, f32 distance) {
+		u32 index = tree.getUserData(proxy);
+		if ((m_HitBoxes[index]->layerMask & layerMask) == 0) return distance;
+
+		f32 hitDistance;
+		if (!m_HitBoxes[index]->raycast(origin, direction, distance, hitDistance)) return distance;
+
+		hit.hitbox = m_HitBoxes[index];
+		hit.distance = hitDistance;
+		return hitDistance;
+	});
+
+	if (!hit.hitbox) return false;
+
+	hit.point = origin + direction * hit.distance;
+	return true;
 }
 
 } // namespace vulture
@@ -1,7 +1,25 @@
 #pragma once
 
 #include "vulture/core/Core.h"
+#include "vulture/core/Job.h"
 #include "HitBox.h"
+#include "Broadphase.h"
+#include "DynamicTreeBroadphase.h"
+#include "CapsuleBatch.h"
+
+#include <vector>
+
+namespace vulture {
+
+/**
+ * @brief The result of a raycast against the hit boxes.
+ */
+struct RaycastHit
+{
+	Ref<HitBox> hitbox;
+	glm::vec3 point;
+	f32 distance;
+};
 
 /**
  * @brief Manages collision detection and response for hit boxes.
@@ -9,12 +27,28 @@
  * The CollisionEngine class is responsible for managing collision detection
  * and response for hit boxes. It tracks a collection of hit boxes and provides
  * functions to update the engine and add/remove hit boxes dynamically.
+ *
+ * Every update:
+ * - finds the candidate pairs with the broadphase chosen at construction, only among layers that interact;
+ * - tests the candidates shape by shape on the job workers, the capsules in SIMD batches;
+ * - emits the events on the calling thread, in an order that does not depend on the workers.
+ *
+ * The bounds of the static hit boxes, such as the ground, are computed when they are added or updated
+ * with updateStaticHitbox. The other hit boxes are skipped while their transform does not change.
+ * The fast hit boxes are tested along their movement since the previous update.
+ *
+ * Hit boxes added or removed by the event callbacks during an update are applied at its end.
  */
-namespace vulture {
-
 class CollisionEngine
 {
 public:
+	/**
+	 * @brief Constructs an empty collision engine.
+	 *
+	 * @param broadphase The algorithm used to find the candidate pairs of colliding hit boxes.
+	 */
+	explicit CollisionEngine(BroadphaseType broadphase = BroadphaseType::SPATIAL_HASH_GRID);
+
 	/**
 	 * @brief Updates the collision engine for a given time step.
 	 *
@@ -35,8 +69,201 @@ public:
 	 * @param hitbox The hit box to remove.
 	 */
 	void removeHitbox(Ref<HitBox> hitbox);
+
+	/**
+	 * @brief Recomputes the bounds of a static hit box whose shapes changed, keeping its contacts.
+	 * Unlike removing and adding it again, the hit boxes it is colliding with are not told it exited and entered.
+	 * Hit boxes not in the engine are ignored, they get their bounds when added.
+	 *
+	 * @param hitbox The hit box to update.
+	 */
+	void updateStaticHitbox(Ref<HitBox> hitbox);
+
+	/**
+	 * @brief Gets the number of hit boxes in the collision engine.
+	 */
+	inline u64 getHitboxCount() const { return m_HitBoxes.size(); }
+
+	/**
+	 * @brief Gets the number of pairs of hit boxes tested shape by shape during the last update.
+	 */
+	inline u64 getTestedPairCount() const { return m_TestedPairsCount; }
+
+	/**
+	 * @brief Gets the algorithm used to find the candidate pairs of colliding hit boxes.
+	 */
+	inline BroadphaseType getBroadphaseType() const { return c_BroadphaseType; }
+
+	/**
+	 * @brief Finds the hit boxes whose bounding box overlaps a box.
+	 * The queries use the positions of the hit boxes as of the last update, or as of their addition.
+	 *
+	 * @param box The box in world space.
+	 * @param result The vector the hit boxes are written to.
+	 * @param layerMask Only the hit boxes belonging to one of these layers are reported.
+	 */
+	void queryBox(const AABB& box, std::vector<Ref<HitBox>>& result, u64 layerMask = ~0ull);
+
+	/**
+	 * @brief Finds the hit boxes with a collision shape overlapping a sphere.
+	 *
+	 * @param center The center of the sphere.
+	 * @param radius The radius of the sphere.
+	 * @param result The vector the hit boxes are written to.
+	 * @param layerMask Only the hit boxes belonging to one of these layers are reported.
+	 */
+	void querySphere(glm::vec3 center, f32 radius, std::vector<Ref<HitBox>>& result, u64 layerMask = ~0ull);
+
+	/**
+	 * @brief Finds the hit boxes nearest to a point.
+	 *
+	 * @param point The point in world space.
+	 * @param count The maximum number of hit boxes to find.
+	 * @param result The vector the hit boxes are written to, from the nearest.
+	 * @param layerMask Only the hit boxes belonging to one of these layers are reported.
+	 */
+	void queryNearest(glm::vec3 point, u32 count, std::vector<Ref<HitBox>>& result, u64 layerMask = ~0ull);
+
+	/**
+	 * @brief Finds the first hit box hit by a ray.
+	 *
+	 * @param origin The origin of the ray.
+	 * @param direction The direction of the ray.
+	 * @param maxDistance The length of the ray.
+	 * @param hit Receives the hit box, the point and the distance of the hit.
+	 * @param layerMask Only the hit boxes belonging to one of these layers are tested.
+	 *
+	 * @return true if a hit box has been hit within maxDistance, false otherwise.
+	 */
+	bool raycast(glm::vec3 origin, glm::vec3 direction, f32 maxDistance, RaycastHit& hit, u64 layerMask = ~0ull);
 private:
-	std::unordered_set<Ref<HitBox>> m_HitBoxes;
+	// The hit boxes and their bounds, at the position stored in each hit box.
+	// The bounds of the fast hit boxes enclose their whole movement since the previous update.
+	std::vector<Ref<HitBox>> m_HitBoxes;
+	std::vector<AABB> m_Bounds;
+
+	// The position of each hit box as of the previous update and its translation since then.
+	// The translation is only kept for the fast hit boxes, whose pairs are tested along it.
+	std::vector<glm::vec3> m_Positions;
+	std::vector<glm::vec3> m_Displacements;
+
+	// The transform of each hit box and its version as of the previous update, to tell whether it moved.
+	// A hit box whose transform did not change sleeps: its bounds and its place in the broadphase are kept.
+	struct TransformState
+	{
+		const Transform* transform;
+		u64 version;
+	};
+
+	std::vector<TransformState> m_TransformStates;
+
+	const BroadphaseType c_BroadphaseType;
+	std::vector<CollisionPair> m_Pairs;
+	u64 m_TestedPairsCount = 0;
+
+	// The hit boxes sharing a layer mask and being static or not, by their index, with a broadphase of their own.
+	struct LayerBucket
+	{
+		u64 layerMask;
+		bool isStatic;
+		u64 collisionMask; // The union of the collision masks of the hit boxes, as of the last update.
+		std::vector<u32> hitboxes;
+		std::vector<AABB> bounds;
+		Ref<Broadphase> broadphase;
+		bool dirty; // Whether the bounds changed since the last update of the broadphase.
+	};
+
+	// The bucket of a hit box and its position in the bucket.
+	struct BucketSlot
+	{
+		u32 bucket;
+		u32 position;
+	};
+
+	// Only the pairs of buckets whose masks interact are searched for candidates, and two static buckets never are.
+	std::vector<LayerBucket> m_Buckets;
+	std::vector<BucketSlot> m_BucketSlots;
+	std::vector<u8> m_BucketsInteract; // For each pair of buckets, whether they can collide.
+	std::vector<CollisionPair> m_BucketPairs;
+
+	// The capsules of each hit box in m_Capsules, NOT_BATCHED if it has other shapes.
+	struct CapsuleRange
+	{
+		u32 first;
+		u32 count;
+
+		static constexpr u32 NOT_BATCHED = ~0u;
+	};
+
+	// A pair passing the mask test, with the range of its capsule pairs in m_CapsulePairs.
+	struct NarrowphasePair
+	{
+		u32 first;
+		u32 second;
+		u32 capsulePairsBegin;
+		u32 capsulePairsEnd;
+		bool firstCollides;
+		bool secondCollides;
+		bool swept;
+	};
+
+	// A pair of colliding hit boxes, found by the narrowphase, with first < second.
+	struct Contact
+	{
+		u32 first;
+		u32 second;
+		f32 timeOfImpact;
+		bool firstCollides;
+		bool secondCollides;
+	};
+
+	// The capsules of all the hit boxes, packed every update so that their pairs are tested in batches.
+	CapsuleBatch m_Capsules;
+	std::vector<CapsuleRange> m_CapsuleRanges;
+	std::vector<NarrowphasePair> m_NarrowphasePairs;
+	std::vector<CapsulePair> m_CapsulePairs;
+	std::vector<u8> m_CapsuleResults;
+
+	std::vector<std::vector<Contact>> m_ContactBuffers; // One for each thread taking part in the narrowphase.
+	// The contacts are sorted by hit box, so the ones starting and ending are found by merging them
+	// with the contacts of the previous update.
+	std::vector<Contact> m_Contacts;
+	std::vector<Contact> m_PreviousContacts;
+
+	// A hit box which was colliding with a removed one, told at the next update.
+	struct PendingExit
+	{
+		u32 hitbox;
+		void* data; // The data of the removed hit box.
+	};
+
+	std::vector<PendingExit> m_PendingExits;
+
+	static constexpr u64 CAPSULE_PAIRS_GRAIN = 1024;
+	static constexpr u64 NARROWPHASE_PAIRS_GRAIN = 256;
+
+	// The tree answering the spatial queries.
+	Ref<DynamicTreeBroadphase> m_QueryTree;
+	bool m_QueryTreeDirty = false;
+
+	// The hit boxes added or removed during an update, applied at its end.
+	bool m_Updating = false;
+	std::vector<Ref<HitBox>> m_PendingAdditions;
+	std::vector<Ref<HitBox>> m_PendingRemovals;
+
+	void insertHitbox(const Ref<HitBox>& hitbox);
+	void eraseHitbox(const Ref<HitBox>& hitbox);
+	CapsuleRange packCapsules(const HitBox& hitbox);
+	static bool isStatic(const HitBox& hitbox);
+	bool hasMoved(u32 index);
+	void setBounds(u32 index, const AABB& bounds);
+	void addToBucket(u32 index);
+	void removeFromBucket(u32 index);
+	void findPairs();
+	void emitEvents();
+	void renumberContacts(u32 from, u32 to);
+	static bool precedes(const Contact& a, const Contact& b);
+	const DynamicAABBTree& getQueryTree();
 };
 
 } // namespace vulture
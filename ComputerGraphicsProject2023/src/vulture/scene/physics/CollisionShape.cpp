@@ -1,10 +1,14 @@
 #include "CollisionShape.h"
+#include "HeightfieldCollisionShape.h"
 
 #include <algorithm>
+#include <cmath> // std::sqrt
 
 namespace vulture {
 
 bool testCollisionCapsuleCapsule(const CapsuleCollisionShape* c1, const CapsuleCollisionShape* c2);
+bool sweepCapsuleCapsule(const CapsuleCollisionShape* c1, glm::vec3 displacement1,
+	const CapsuleCollisionShape* c2, glm::vec3 displacement2, f32& timeOfImpact);
 
 CapsuleCollisionShape::CapsuleCollisionShape(f32 radius, f32 height) :
 	CollisionShape(CollisionShapeType::CAPSULE), m_Radius(radius)
@@ -36,25 +40,138 @@ bool CapsuleCollisionShape::testCollision(const Ref<CollisionShape> other) const
 		const CapsuleCollisionShape* otherCapsule = reinterpret_cast<CapsuleCollisionShape*>(other.get());
 		return testCollisionCapsuleCapsule(this, otherCapsule);
 	}
+	case CollisionShapeType::HEIGHTFIELD:
+	{
+		const HeightfieldCollisionShape* heightfield = reinterpret_cast<HeightfieldCollisionShape*>(other.get());
+		glm::vec3 a, b;
+		getSegment(a, b);
+		return heightfield->testCapsule(a, b, m_Radius);
+	}
+	default:
+	break;
+	}
+	return false;
+}
+
+bool CapsuleCollisionShape::sweep(glm::vec3 displacement, const Ref<CollisionShape> other, glm::vec3 otherDisplacement, f32& timeOfImpact) const
+{
+	switch (other->c_Type)
+	{
+	case CollisionShapeType::CAPSULE:
+	{
+		const CapsuleCollisionShape* otherCapsule = reinterpret_cast<CapsuleCollisionShape*>(other.get());
+		return sweepCapsuleCapsule(this, displacement, otherCapsule, otherDisplacement, timeOfImpact);
+	}
+	case CollisionShapeType::HEIGHTFIELD:
+	{
+		const HeightfieldCollisionShape* heightfield = reinterpret_cast<HeightfieldCollisionShape*>(other.get());
+		glm::vec3 a, b;
+		getSegment(a, b);
+		return heightfield->sweepCapsule(a, b, m_Radius, displacement - otherDisplacement, timeOfImpact);
+	}
 	default:
 	break;
 	}
 	return false;
 }
 
+AABB CapsuleCollisionShape::getBounds() const
+{
+	glm::vec3 a, b;
+	getSegment(a, b);
+
+	glm::vec3 extent(m_Radius);
+	return AABB{ glm::min(a, b) - extent, glm::max(a, b) + extent };
+}
+
 void CapsuleCollisionShape::setDimensions(f32 radius, f32 height)
 {
 	m_Radius = radius;
 	m_Height = std::max(height, m_Radius * 2 + 0.001f);
 }
 
+void CapsuleCollisionShape::getSegment(glm::vec3& a, glm::vec3& b) const
+{
+	// The same segment used by testCollisionCapsuleCapsule.
+	glm::vec3 lineEndOffset = glm::normalize(m_Tip - m_Base) * m_Radius;
+	a = m_Base + lineEndOffset;
+	b = m_Tip - lineEndOffset;
+}
+
 glm::vec3 closestPointOnLineSegment(glm::vec3 a, glm::vec3 b, glm::vec3 point)
 {
 	glm::vec3 AB = b - a;
-	f32 t = glm::dot(point - a, AB) / glm::dot(AB, AB);
+	f32 lengthSquared = glm::dot(AB, AB);
+	if (lengthSquared <= 0.0f) return a;
+
+	f32 t = glm::dot(point - a, AB) / lengthSquared;
 	return a + std::clamp(t, 0.0f, 1.0f) * AB;
 }
 
+f32 CapsuleCollisionShape::getDistance(glm::vec3 point) const
+{
+	glm::vec3 a, b;
+	getSegment(a, b);
+
+	return std::max(glm::length(point - closestPointOnLineSegment(a, b, point)) - m_Radius, 0.0f);
+}
+
+// https://iquilezles.org/articles/intersectors/
+bool CapsuleCollisionShape::raycast(glm::vec3 origin, glm::vec3 direction, f32 maxDistance, f32& distance) const
+{
+	if (getDistance(origin) <= 0.0f)
+	{
+		distance = 0.0f;
+		return true;
+	}
+
+	glm::vec3 a, b;
+	getSegment(a, b);
+
+	glm::vec3 ba = b - a;
+	glm::vec3 oa = origin - a;
+	f32 baba = glm::dot(ba, ba);
+	f32 bard = glm::dot(ba, direction);
+	f32 baoa = glm::dot(ba, oa);
+	f32 rdoa = glm::dot(direction, oa);
+	f32 oaoa = glm::dot(oa, oa);
+	f32 r2 = m_Radius * m_Radius;
+
+	// The origin is outside, so the nearest entry point among the cylinder and the two caps is the hit.
+	f32 t = maxDistance + 1.0f;
+
+	f32 qa = baba - bard * bard;
+	if (qa > 0.0f)
+	{
+		f32 qb = baba * rdoa - baoa * bard;
+		f32 qc = baba * oaoa - baoa * baoa - r2 * baba;
+		f32 h = qb * qb - qa * qc;
+		// The capsule is inside the infinite cylinder.
+		if (h < 0.0f) return false;
+
+		f32 tc = (-qb - std::sqrt(h)) / qa;
+		f32 y = baoa + tc * bard;
+		if (tc >= 0.0f && y > 0.0f && y < baba) t = tc;
+	}
+
+	for (glm::vec3 center : { a, b })
+	{
+		glm::vec3 oc = origin - center;
+		f32 sb = glm::dot(oc, direction);
+		f32 sc = glm::dot(oc, oc) - r2;
+		f32 h = sb * sb - sc;
+		if (h < 0.0f) continue;
+
+		f32 ts = -sb - std::sqrt(h);
+		if (ts >= 0.0f) t = std::min(t, ts);
+	}
+
+	if (t > maxDistance) return false;
+
+	distance = t;
+	return true;
+}
+
 // https://wickedengine.net/2020/04/26/capsule-collision-detection/
 bool testCollisionCapsuleCapsule(const CapsuleCollisionShape* c0, const CapsuleCollisionShape* c1)
 {
@@ -106,4 +223,104 @@ bool testCollisionCapsuleCapsule(const CapsuleCollisionShape* c0, const CapsuleC
 	return penetration_depth > 0;
 }
 
+// Real-Time Collision Detection, 5.1.9: the vector between the closest points of the segments p0p1 and q0q1.
+static glm::vec3 getSegmentsSeparation(glm::vec3 p0, glm::vec3 p1, glm::vec3 q0, glm::vec3 q1)
+{
+	glm::vec3 d1 = p1 - p0;
+	glm::vec3 d2 = q1 - q0;
+	glm::vec3 r = p0 - q0;
+	f32 a = glm::dot(d1, d1);
+	f32 e = glm::dot(d2, d2);
+	f32 f = glm::dot(d2, r);
+
+	f32 s = 0.0f;
+	f32 t = 0.0f;
+	if (a <= 0.0f && e <= 0.0f)
+	{
+		// Both segments are points.
+	}
+	else if (a <= 0.0f)
+	{
+		t = std::clamp(f / e, 0.0f, 1.0f);
+	}
+	else
+	{
+		f32 c = glm::dot(d1, r);
+		if (e <= 0.0f)
+		{
+			s = std::clamp(-c / a, 0.0f, 1.0f);
+		}
+		else
+		{
+			f32 b = glm::dot(d1, d2);
+			f32 denominator = a * e - b * b;
+			// Parallel segments: any point of the first one will do.
+			s = denominator > 0.0f ? std::clamp((b * f - c * e) / denominator, 0.0f, 1.0f) : 0.0f;
+
+			t = (b * s + f) / e;
+			if (t < 0.0f)
+			{
+				t = 0.0f;
+				s = std::clamp(-c / a, 0.0f, 1.0f);
+			}
+			else if (t > 1.0f)
+			{
+				t = 1.0f;
+				s = std::clamp((b - c) / a, 0.0f, 1.0f);
+			}
+		}
+	}
+
+	return (q0 + d2 * t) - (p0 + d1 * s);
+}
+
+// As the capsules only translate, the distance between their segments is a convex function of time,
+// so a Newton step from before the impact never passes it and a non decreasing distance never reaches it.
+bool sweepCapsuleCapsule(const CapsuleCollisionShape* c0, glm::vec3 displacement0,
+	const CapsuleCollisionShape* c1, glm::vec3 displacement1, f32& timeOfImpact)
+{
+	constexpr f32 TOLERANCE = 0.001f;
+	constexpr u32 MAX_ITERATIONS = 32;
+
+	// Capsule C0 at its previous position:
+	glm::vec3 c0A, c0B;
+	c0->getSegment(c0A, c0B);
+	c0A -= displacement0;
+	c0B -= displacement0;
+
+	// Capsule C1 at its previous position, moving relative to C0:
+	glm::vec3 c1A, c1B;
+	c1->getSegment(c1A, c1B);
+	c1A -= displacement1;
+	c1B -= displacement1;
+
+	glm::vec3 relativeDisplacement = displacement1 - displacement0;
+	f32 radii = c0->m_Radius + c1->m_Radius;
+
+	f32 t = 0.0f;
+	for (u32 i = 0; i < MAX_ITERATIONS; i++)
+	{
+		glm::vec3 offset = relativeDisplacement * t;
+		glm::vec3 separation = getSegmentsSeparation(c0A, c0B, c1A + offset, c1B + offset);
+		f32 length = glm::length(separation);
+		f32 distance = length - radii;
+		if (distance <= TOLERANCE)
+		{
+			timeOfImpact = t;
+			return true;
+		}
+
+		// The rate at which the distance shrinks.
+		f32 approachSpeed = -glm::dot(separation, relativeDisplacement) / length;
+		if (approachSpeed <= 0.0f) return false;
+
+		t += distance / approachSpeed;
+		if (t > 1.0f) return false;
+	}
+
+	// Not converged within the iterations: only the final positions are tested.
+	timeOfImpact = 1.0f;
+	return testCollisionCapsuleCapsule(c0, c1);
+}
+
 } // namespace vulture
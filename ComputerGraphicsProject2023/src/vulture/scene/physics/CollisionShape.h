@@ -2,6 +2,7 @@
 
 #include "vulture/core/Core.h"
 #include "vulture/util/Transform.h"
+#include "AABB.h"
 
 namespace vulture {
 
@@ -12,10 +13,12 @@ namespace vulture {
  * the type of collision shape used in collision detection and response.
  * Currently, the supported shape types are:
  *   - CAPSULE: Represents a capsule-shaped collision volume.
+ *   - HEIGHTFIELD: Represents the ground below a grid of height samples.
  */
 enum class CollisionShapeType
 {
-	CAPSULE
+	CAPSULE,
+	HEIGHTFIELD
 };
 
 /**
@@ -57,6 +60,47 @@ public:
 	 */
 	virtual void applyTransform(const Transform& transform) = 0;
 
+	/**
+	 * @brief Computes the bounding box of the shape, as of the last applied transformation.
+	 *
+	 * @return The world space bounding box.
+	 */
+	virtual AABB getBounds() const = 0;
+
+	/**
+	 * @brief Computes the distance between a point and the shape, as of the last applied transformation.
+	 *
+	 * @param point The point in world space.
+	 *
+	 * @return The distance from the surface of the shape, 0 if the point is inside.
+	 */
+	virtual f32 getDistance(glm::vec3 point) const = 0;
+
+	/**
+	 * @brief Intersects a ray with the shape, as of the last applied transformation.
+	 *
+	 * @param origin The origin of the ray.
+	 * @param direction The normalized direction of the ray.
+	 * @param maxDistance The length of the ray.
+	 * @param distance Receives the distance of the hit, 0 if the origin is inside the shape.
+	 *
+	 * @return true if the ray hits the shape within maxDistance, false otherwise.
+	 */
+	virtual bool raycast(glm::vec3 origin, glm::vec3 direction, f32 maxDistance, f32& distance) const = 0;
+
+	/**
+	 * @brief Tests collision between this shape and another shape along their movement since the previous positions.
+	 * Both shapes are at the end of their movement, as of the last applied transformation, and only translate.
+	 *
+	 * @param displacement The translation of this shape since its previous position.
+	 * @param other A reference to the other collision shape.
+	 * @param otherDisplacement The translation of the other shape since its previous position.
+	 * @param timeOfImpact Receives the fraction of the movement at which the shapes first touch.
+	 *
+	 * @return true if the shapes touch at any point of the movement, false otherwise.
+	 */
+	virtual bool sweep(glm::vec3 displacement, const Ref<CollisionShape> other, glm::vec3 otherDisplacement, f32& timeOfImpact) const = 0;
+
 	/**
 	 * @brief Virtual destructor for proper cleanup of derived classes.
 	 */
@@ -99,6 +143,46 @@ public:
 	 */
 	virtual bool testCollision(const Ref<CollisionShape> other) const;
 
+	/**
+	 * @brief Computes the bounding box of the capsule, as of the last applied transformation.
+	 *
+	 * @return The world space bounding box.
+	 */
+	virtual AABB getBounds() const;
+
+	/**
+	 * @brief Computes the distance between a point and the capsule, as of the last applied transformation.
+	 *
+	 * @param point The point in world space.
+	 *
+	 * @return The distance from the surface of the capsule, 0 if the point is inside.
+	 */
+	virtual f32 getDistance(glm::vec3 point) const;
+
+	/**
+	 * @brief Intersects a ray with the capsule, as of the last applied transformation.
+	 *
+	 * @param origin The origin of the ray.
+	 * @param direction The normalized direction of the ray.
+	 * @param maxDistance The length of the ray.
+	 * @param distance Receives the distance of the hit, 0 if the origin is inside the capsule.
+	 *
+	 * @return true if the ray hits the capsule within maxDistance, false otherwise.
+	 */
+	virtual bool raycast(glm::vec3 origin, glm::vec3 direction, f32 maxDistance, f32& distance) const;
+
+	/**
+	 * @brief Tests collision between this capsule and another collision shape along their movement since the previous positions.
+	 *
+	 * @param displacement The translation of this capsule since its previous position.
+	 * @param other A reference to the other collision shape.
+	 * @param otherDisplacement The translation of the other shape since its previous position.
+	 * @param timeOfImpact Receives the fraction of the movement at which the shapes first touch.
+	 *
+	 * @return true if the shapes touch at any point of the movement, false otherwise.
+	 */
+	virtual bool sweep(glm::vec3 displacement, const Ref<CollisionShape> other, glm::vec3 otherDisplacement, f32& timeOfImpact) const;
+
 	/**
 	 * @brief Sets the radius and height of the Capsule.
 	 * 
@@ -107,6 +191,16 @@ public:
 	*/
 	void setDimensions(f32 radius, f32 height);
 
+	/**
+	 * @brief Gets the segment whose points within the radius form the capsule, as of the last applied transformation.
+	 *
+	 * @param a Receives the first end of the segment.
+	 * @param b Receives the second end of the segment.
+	 */
+	void getSegment(glm::vec3& a, glm::vec3& b) const;
+
+	inline f32 getRadius() const { return m_Radius; }
+
 	/**
 	 * @brief Virtual destructor for proper cleanup of derived classes.
 	 */
@@ -118,6 +212,8 @@ private:
 	glm::vec3 m_Base;
 public:
 	friend bool testCollisionCapsuleCapsule(const CapsuleCollisionShape* c1, const CapsuleCollisionShape* c2);
+	friend bool sweepCapsuleCapsule(const CapsuleCollisionShape* c1, glm::vec3 displacement1,
+		const CapsuleCollisionShape* c2, glm::vec3 displacement2, f32& timeOfImpact);
 };
 
 } // namespace vulture
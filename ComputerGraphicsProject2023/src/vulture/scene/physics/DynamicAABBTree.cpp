@@ -0,0 +1,258 @@
+#include "DynamicAABBTree.h"
+
+#include <algorithm>
+
+namespace vulture {
+
+DynamicAABBTree::DynamicAABBTree(f32 margin) :
+	m_Margin(std::max(margin, 0.0f))
+{}
+
+u32 DynamicAABBTree::insert(const AABB& box, u32 userData)
+{
+	u32 proxy = allocateNode();
+	Node& node = m_Nodes[proxy];
+	node.box = box.expand(m_Margin);
+	node.userData = userData;
+	node.height = 0;
+
+	insertLeaf(proxy);
+	m_ProxyCount++;
+	return proxy;
+}
+
+void DynamicAABBTree::remove(u32 proxy)
+{
+	removeLeaf(proxy);
+	freeNode(proxy);
+	m_ProxyCount--;
+}
+
+bool DynamicAABBTree::move(u32 proxy, const AABB& box)
+{
+	if (m_Nodes[proxy].box.contains(box)) return false;
+
+	removeLeaf(proxy);
+	m_Nodes[proxy].box = box.expand(m_Margin);
+	insertLeaf(proxy);
+	return true;
+}
+
+void DynamicAABBTree::clear()
+{
+	m_Nodes.clear();
+	m_Root = NULL_NODE;
+	m_FreeList = NULL_NODE;
+	m_ProxyCount = 0;
+}
+
+u32 DynamicAABBTree::allocateNode()
+{
+	u32 index;
+	if (m_FreeList != NULL_NODE)
+	{
+		index = m_FreeList;
+		m_FreeList = m_Nodes[index].parent;
+	}
+	else
+	{
+		index = static_cast<u32>(m_Nodes.size());
+		m_Nodes.emplace_back();
+	}
+
+	Node& node = m_Nodes[index];
+	node.parent = NULL_NODE;
+	node.left = NULL_NODE;
+	node.right = NULL_NODE;
+	node.userData = 0;
+	node.height = 0;
+	return index;
+}
+
+void DynamicAABBTree::freeNode(u32 index)
+{
+	m_Nodes[index].parent = m_FreeList;
+	m_Nodes[index].height = -1;
+	m_FreeList = index;
+}
+
+void DynamicAABBTree::insertLeaf(u32 leaf)
+{
+	if (m_Root == NULL_NODE)
+	{
+		m_Root = leaf;
+		m_Nodes[leaf].parent = NULL_NODE;
+		return;
+	}
+
+	// Descend towards the sibling with the lowest cost, which is the area of the new parent
+	// plus the increase of area of all its ancestors.
+	AABB leafBox = m_Nodes[leaf].box;
+	u32 index = m_Root;
+	while (!m_Nodes[index].isLeaf())
+	{
+		const Node& node = m_Nodes[index];
+
+		f32 area = node.box.getSurfaceArea();
+		f32 combinedArea = node.box.merge(leafBox).getSurfaceArea();
+
+		// Cost of making the leaf a sibling of this node.
+		f32 cost = 2.0f * combinedArea;
+		// Cost of pushing the leaf further down.
+		f32 inheritanceCost = 2.0f * (combinedArea - area);
+
+		auto descendCost = [&](u32 child) {
+			const AABB& childBox = m_Nodes[child].box;
+			f32 newArea = childBox.merge(leafBox).getSurfaceArea();
+			if (m_Nodes[child].isLeaf()) return newArea + inheritanceCost;
+			return newArea - childBox.getSurfaceArea() + inheritanceCost;
+		};
+
+		f32 leftCost = descendCost(node.left);
+		f32 rightCost = descendCost(node.right);
+
+		if (cost < leftCost && cost < rightCost) break;
+
+		index = leftCost < rightCost ? node.left : node.right;
+	}
+
+	u32 sibling = index;
+	u32 oldParent = m_Nodes[sibling].parent;
+	u32 newParent = allocateNode();
+
+	m_Nodes[newParent].parent = oldParent;
+	m_Nodes[newParent].box = m_Nodes[sibling].box.merge(leafBox);
+	m_Nodes[newParent].height = m_Nodes[sibling].height + 1;
+	m_Nodes[newParent].left = sibling;
+	m_Nodes[newParent].right = leaf;
+	m_Nodes[sibling].parent = newParent;
+	m_Nodes[leaf].parent = newParent;
+
+	if (oldParent == NULL_NODE)
+	{
+		m_Root = newParent;
+	}
+	else if (m_Nodes[oldParent].left == sibling)
+	{
+		m_Nodes[oldParent].left = newParent;
+	}
+	else
+	{
+		m_Nodes[oldParent].right = newParent;
+	}
+
+	refitAncestors(m_Nodes[leaf].parent);
+}
+
+void DynamicAABBTree::removeLeaf(u32 leaf)
+{
+	if (leaf == m_Root)
+	{
+		m_Root = NULL_NODE;
+		return;
+	}
+
+	u32 parent = m_Nodes[leaf].parent;
+	u32 grandParent = m_Nodes[parent].parent;
+	u32 sibling = m_Nodes[parent].left == leaf ? m_Nodes[parent].right : m_Nodes[parent].left;
+
+	// The sibling takes the place of the parent.
+	m_Nodes[sibling].parent = grandParent;
+	freeNode(parent);
+
+	if (grandParent == NULL_NODE)
+	{
+		m_Root = sibling;
+		return;
+	}
+
+	if (m_Nodes[grandParent].left == parent)
+		m_Nodes[grandParent].left = sibling;
+	else
+		m_Nodes[grandParent].right = sibling;
+
+	refitAncestors(grandParent);
+}
+
+void DynamicAABBTree::refitAncestors(u32 index)
+{
+	while (index != NULL_NODE)
+	{
+		index = balance(index);
+
+		Node& node = m_Nodes[index];
+		const Node& left = m_Nodes[node.left];
+		const Node& right = m_Nodes[node.right];
+
+		node.height = 1 + std::max(left.height, right.height);
+		node.box = left.box.merge(right.box);
+
+		index = node.parent;
+	}
+}
+
+u32 DynamicAABBTree::balance(u32 indexA)
+{
+	// Rotates the taller child of A above it when the heights of the children differ by more than one.
+	Node& a = m_Nodes[indexA];
+	if (a.isLeaf() || a.height < 2) return indexA;
+
+	u32 indexB = a.left;
+	u32 indexC = a.right;
+	Node& b = m_Nodes[indexB];
+	Node& c = m_Nodes[indexC];
+
+	i32 balance = c.height - b.height;
+
+	// Makes child the parent of A, keeping the taller of its children and giving the other one to A.
+	auto rotate = [&](u32 indexChild, Node& child, Node& other, bool childIsRight) {
+		u32 indexF = child.left;
+		u32 indexG = child.right;
+		Node& f = m_Nodes[indexF];
+		Node& g = m_Nodes[indexG];
+
+		child.parent = a.parent;
+		a.parent = indexChild;
+
+		if (child.parent == NULL_NODE)
+			m_Root = indexChild;
+		else if (m_Nodes[child.parent].left == indexA)
+			m_Nodes[child.parent].left = indexChild;
+		else
+			m_Nodes[child.parent].right = indexChild;
+
+		u32 indexKept = f.height > g.height ? indexF : indexG;
+		u32 indexGiven = f.height > g.height ? indexG : indexF;
+		Node& kept = m_Nodes[indexKept];
+		Node& given = m_Nodes[indexGiven];
+
+		child.left = indexA;
+		child.right = indexKept;
+		if (childIsRight)
+			a.right = indexGiven;
+		else
+			a.left = indexGiven;
+		given.parent = indexA;
+
+		a.box = other.box.merge(given.box);
+		a.height = 1 + std::max(other.height, given.height);
+		child.box = a.box.merge(kept.box);
+		child.height = 1 + std::max(a.height, kept.height);
+	};
+
+	if (balance > 1)
+	{
+		rotate(indexC, c, b, true);
+		return indexC;
+	}
+
+	if (balance < -1)
+	{
+		rotate(indexB, b, c, false);
+		return indexB;
+	}
+
+	return indexA;
+}
+
+} // namespace vulture
@@ -0,0 +1,346 @@
+#pragma once
+
+#include "vulture/core/Core.h"
+#include "AABB.h"
+
+#include <queue>
+#include <utility>
+#include <vector>
+
+namespace vulture {
+
+/**
+ * @brief Bounding volume hierarchy of axis aligned boxes that can be updated incrementally.
+ *
+ * Every box is stored in a leaf, the proxy, whose box is enlarged by a margin (the fat box),
+ * so that a box moving by less than the margin does not change the tree.
+ * The leaves are inserted next to the sibling that minimizes the increase of surface area
+ * and the tree is kept balanced by rotations, as in the dynamic tree of Box2D.
+ *
+ * The queries visit the tree with an explicit stack and report the proxies whose fat box passes the test,
+ * the callbacks must test the actual object.
+ */
+class DynamicAABBTree
+{
+public:
+	/**
+	 * @brief Constructs an empty tree.
+	 *
+	 * @param margin The amount by which the boxes of the leaves are enlarged.
+	 */
+	explicit DynamicAABBTree(f32 margin = DEFAULT_MARGIN);
+
+	/**
+	 * @brief Inserts a box in the tree.
+	 *
+	 * @param box The box to insert.
+	 * @param userData A value stored in the leaf, usually the index of the object the box belongs to.
+	 *
+	 * @return The proxy identifying the leaf, valid until it is removed.
+	 */
+	u32 insert(const AABB& box, u32 userData);
+
+	/**
+	 * @brief Removes a leaf from the tree.
+	 *
+	 * @param proxy The proxy returned by insert.
+	 */
+	void remove(u32 proxy);
+
+	/**
+	 * @brief Updates the box of a leaf.
+	 * The leaf is reinserted only if the new box is not contained in its fat box.
+	 *
+	 * @param proxy The proxy returned by insert.
+	 * @param box The new box.
+	 *
+	 * @return true if the leaf has been reinserted, false otherwise.
+	 */
+	bool move(u32 proxy, const AABB& box);
+
+	/**
+	 * @brief Removes all the leaves.
+	 */
+	void clear();
+
+	inline u32 getUserData(u32 proxy) const { return m_Nodes[proxy].userData; }
+	inline void setUserData(u32 proxy, u32 userData) { m_Nodes[proxy].userData = userData; }
+	inline const AABB& getFatBounds(u32 proxy) const { return m_Nodes[proxy].box; }
+
+	/**
+	 * @brief Gets the height of the tree, 0 if it is empty or has a single leaf.
+	 */
+	inline u32 getHeight() const { return m_Root == NULL_NODE ? 0 : static_cast<u32>(m_Nodes[m_Root].height); }
+
+	inline u32 getProxyCount() const { return m_ProxyCount; }
+
+	/**
+	 * @brief Reports the proxies whose fat box overlaps a box.
+	 *
+	 * @param box The box to test.
+	 * @param callback Called as bool(u32 proxy), returning false stops the query.
+	 */
+	template <class Callback>
+	void query(const AABB& box, Callback&& callback) const
+	{
+		visit([&](const AABB& nodeBox) { return nodeBox.overlaps(box); }, callback);
+	}
+
+	/**
+	 * @brief Reports every pair of proxies whose fat boxes overlap, once.
+	 * The tree is descended against itself, so each subtree is visited once rather than once per proxy.
+	 *
+	 * @param callback Called as void(u32 proxy, u32 otherProxy).
+	 */
+	template <class Callback>
+	void queryPairs(Callback&& callback) const
+	{
+		if (m_Root == NULL_NODE) return;
+
+		// A pair of equal nodes stands for the pairs within a subtree.
+		std::vector<std::pair<u32, u32>> stack;
+		stack.push_back({ m_Root, m_Root });
+
+		while (!stack.empty())
+		{
+			auto [indexA, indexB] = stack.back();
+			stack.pop_back();
+
+			const Node& a = m_Nodes[indexA];
+			const Node& b = m_Nodes[indexB];
+
+			if (indexA == indexB)
+			{
+				if (a.isLeaf()) continue;
+
+				stack.push_back({ a.left, a.left });
+				stack.push_back({ a.right, a.right });
+				stack.push_back({ a.left, a.right });
+				continue;
+			}
+
+			if (!a.box.overlaps(b.box)) continue;
+
+			if (a.isLeaf() && b.isLeaf())
+			{
+				callback(indexA, indexB);
+			}
+			else if (b.isLeaf() || (!a.isLeaf() && a.height >= b.height))
+			{
+				stack.push_back({ a.left, indexB });
+				stack.push_back({ a.right, indexB });
+			}
+			else
+			{
+				stack.push_back({ indexA, b.left });
+				stack.push_back({ indexA, b.right });
+			}
+		}
+	}
+
+	/**
+	 * @brief Reports the proxies whose fat box overlaps a sphere.
+	 *
+	 * @param center The center of the sphere.
+	 * @param radius The radius of the sphere.
+	 * @param callback Called as bool(u32 proxy), returning false stops the query.
+	 */
+	template <class Callback>
+	void querySphere(glm::vec3 center, f32 radius, Callback&& callback) const
+	{
+		f32 radiusSquared = radius * radius;
+		visit([&](const AABB& nodeBox) { return nodeBox.getDistanceSquared(center) <= radiusSquared; }, callback);
+	}
+
+	/**
+	 * @brief Reports the proxies whose fat box is hit by a ray.
+	 *
+	 * @param origin The origin of the ray.
+	 * @param direction The normalized direction of the ray.
+	 * @param maxDistance The length of the ray.
+	 * @param callback Called as f32(u32 proxy, f32 maxDistance). It returns the distance of the hit
+	 *                 to clip the ray, maxDistance to ignore the proxy or 0 to stop the query.
+	 */
+	template <class Callback>
+	void raycast(glm::vec3 origin, glm::vec3 direction, f32 maxDistance, Callback&& callback) const
+	{
+		if (m_Root == NULL_NODE) return;
+
+		glm::vec3 inverseDirection = 1.0f / direction;
+
+		NodeStack stack;
+		stack.push(m_Root);
+
+		while (!stack.isEmpty())
+		{
+			u32 index = stack.pop();
+
+			const Node& node = m_Nodes[index];
+			f32 distance;
+			if (!node.box.intersectsRay(origin, inverseDirection, maxDistance, distance)) continue;
+
+			if (node.isLeaf())
+			{
+				maxDistance = callback(index, maxDistance);
+				if (maxDistance <= 0.0f) return;
+			}
+			else
+			{
+				stack.push(node.left);
+				stack.push(node.right);
+			}
+		}
+	}
+
+	/**
+	 * @brief Finds the proxies nearest to a point, visiting the nodes from the nearest.
+	 *
+	 * @param point The point.
+	 * @param count The maximum number of proxies to find.
+	 * @param distance Called as f32(u32 proxy), it returns the distance between the point and the object
+	 *                 of the proxy, which must not be smaller than the distance to its fat box,
+	 *                 or a negative value to ignore the proxy.
+	 * @param result The vector the proxies are written to, from the nearest.
+	 */
+	template <class Distance>
+	void queryNearest(glm::vec3 point, u32 count, Distance&& distance, std::vector<u32>& result) const
+	{
+		result.clear();
+		if (m_Root == NULL_NODE || count == 0) return;
+
+		using Candidate = std::pair<f32, u32>;
+
+		// Nodes ordered by the squared distance of their box, nearest first.
+		std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> nodes;
+		// The best proxies so far, farthest first.
+		std::priority_queue<Candidate> best;
+
+		nodes.push({ m_Nodes[m_Root].box.getDistanceSquared(point), m_Root });
+		while (!nodes.empty())
+		{
+			auto [nodeDistanceSquared, index] = nodes.top();
+			nodes.pop();
+
+			if (best.size() == count && nodeDistanceSquared >= best.top().first) break;
+
+			const Node& node = m_Nodes[index];
+			if (node.isLeaf())
+			{
+				f32 proxyDistance = distance(index);
+				if (proxyDistance < 0.0f) continue;
+
+				f32 proxyDistanceSquared = proxyDistance * proxyDistance;
+				if (best.size() < count)
+				{
+					best.push({ proxyDistanceSquared, index });
+				}
+				else if (proxyDistanceSquared < best.top().first)
+				{
+					best.pop();
+					best.push({ proxyDistanceSquared, index });
+				}
+			}
+			else
+			{
+				nodes.push({ m_Nodes[node.left].box.getDistanceSquared(point), node.left });
+				nodes.push({ m_Nodes[node.right].box.getDistanceSquared(point), node.right });
+			}
+		}
+
+		result.resize(best.size());
+		for (u64 i = result.size(); i > 0; i--)
+		{
+			result[i - 1] = best.top().second;
+			best.pop();
+		}
+	}
+
+	static constexpr f32 DEFAULT_MARGIN = 0.5f;
+	static constexpr u32 NULL_NODE = ~0u;
+private:
+	struct Node
+	{
+		AABB box;
+		u32 parent; // The next free node when the node is not used.
+		u32 left;
+		u32 right;
+		u32 userData;
+		i32 height; // 0 for the leaves, -1 for the free nodes.
+
+		inline bool isLeaf() const { return left == NULL_NODE; }
+	};
+
+	std::vector<Node> m_Nodes;
+	u32 m_Root = NULL_NODE;
+	u32 m_FreeList = NULL_NODE;
+	u32 m_ProxyCount = 0;
+	f32 m_Margin;
+
+	// The nodes left to visit by a query, kept on the call stack unless the tree is unusually deep.
+	class NodeStack
+	{
+	public:
+		inline void push(u32 index)
+		{
+			if (m_Size < STACK_CAPACITY)
+				m_Nodes[m_Size] = index;
+			else
+				m_Overflow.push_back(index);
+			m_Size++;
+		}
+
+		inline u32 pop()
+		{
+			m_Size--;
+			if (m_Size < STACK_CAPACITY) return m_Nodes[m_Size];
+
+			u32 index = m_Overflow.back();
+			m_Overflow.pop_back();
+			return index;
+		}
+
+		inline bool isEmpty() const { return m_Size == 0; }
+	private:
+		static constexpr u32 STACK_CAPACITY = 64;
+
+		u32 m_Nodes[STACK_CAPACITY];
+		u32 m_Size = 0;
+		std::vector<u32> m_Overflow;
+	};
+
+	u32 allocateNode();
+	void freeNode(u32 index);
+	void insertLeaf(u32 leaf);
+	void removeLeaf(u32 leaf);
+	void refitAncestors(u32 index);
+	u32 balance(u32 index);
+
+	template <class Test, class Callback>
+	void visit(Test&& test, Callback& callback) const
+	{
+		if (m_Root == NULL_NODE) return;
+
+		NodeStack stack;
+		stack.push(m_Root);
+
+		while (!stack.isEmpty())
+		{
+			u32 index = stack.pop();
+
+			const Node& node = m_Nodes[index];
+			if (!test(node.box)) continue;
+
+			if (node.isLeaf())
+			{
+				if (!callback(index)) return;
+			}
+			else
+			{
+				stack.push(node.left);
+				stack.push(node.right);
+			}
+		}
+	}
+};
+
+} // namespace vulture
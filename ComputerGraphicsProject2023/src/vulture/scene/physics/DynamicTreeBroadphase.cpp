@@ -0,0 +1,65 @@
+#include "DynamicTreeBroadphase.h"
+
+namespace vulture {
+
+DynamicTreeBroadphase::DynamicTreeBroadphase(f32 margin) :
+	m_Tree(margin)
+{}
+
+void DynamicTreeBroadphase::findPairs(const std::vector<AABB>& bounds, std::vector<CollisionPair>& pairs)
+{
+	m_Tree.queryPairs([&](u32 proxy, u32 otherProxy) {
+		u32 first = m_Tree.getUserData(proxy);
+		u32 second = m_Tree.getUserData(otherProxy);
+		if (!bounds[first].overlaps(bounds[second])) return;
+
+		pairs.push_back(first < second ? CollisionPair{ first, second } : CollisionPair{ second, first });
+	});
+}
+
+void DynamicTreeBroadphase::findPairs(const std::vector<AABB>& bounds, const std::vector<AABB>& others, std::vector<CollisionPair>& pairs)
+{
+	for (u32 k = 0; k < others.size(); k++)
+	{
+		const AABB& other = others[k];
+		m_Tree.query(other, [&](u32 proxy) {
+			u32 index = m_Tree.getUserData(proxy);
+			if (bounds[index].overlaps(other)) pairs.push_back({ index, k });
+			return true;
+		});
+	}
+}
+
+void DynamicTreeBroadphase::onAdded(u32 index)
+{
+	m_Proxies.resize(static_cast<u64>(index) + 1, DynamicAABBTree::NULL_NODE);
+}
+
+void DynamicTreeBroadphase::onRemoved(u32 index, u32 lastIndex)
+{
+	if (m_Proxies[index] != DynamicAABBTree::NULL_NODE)
+	{
+		m_Tree.remove(m_Proxies[index]);
+	}
+
+	m_Proxies[index] = m_Proxies[lastIndex];
+	m_Proxies.pop_back();
+
+	if (index != lastIndex && m_Proxies[index] != DynamicAABBTree::NULL_NODE)
+	{
+		m_Tree.setUserData(m_Proxies[index], index);
+	}
+}
+
+void DynamicTreeBroadphase::update(const std::vector<AABB>& bounds)
+{
+	for (u32 i = 0; i < bounds.size(); i++)
+	{
+		if (m_Proxies[i] == DynamicAABBTree::NULL_NODE)
+			m_Proxies[i] = m_Tree.insert(bounds[i], i);
+		else
+			m_Tree.move(m_Proxies[i], bounds[i]);
+	}
+}
+
+} // namespace vulture
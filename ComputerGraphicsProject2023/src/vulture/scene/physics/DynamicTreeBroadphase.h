@@ -0,0 +1,65 @@
+#pragma once
+
+#include "vulture/core/Core.h"
+#include "Broadphase.h"
+#include "DynamicAABBTree.h"
+
+#include <vector>
+
+namespace vulture {
+
+/**
+ * @brief Dynamic AABB tree used to find the pairs of overlapping bounding boxes.
+ *
+ * Every box has a leaf in the tree, which is refitted only when the box leaves its fat box,
+ * then the tree is descended against itself. Unlike the other broadphases it can also answer spatial queries,
+ * so the CollisionEngine uses one for those as well.
+ */
+class DynamicTreeBroadphase : public Broadphase
+{
+public:
+	/**
+	 * @brief Constructs an empty broadphase.
+	 *
+	 * @param margin The amount by which the boxes of the leaves are enlarged.
+	 */
+	explicit DynamicTreeBroadphase(f32 margin = DynamicAABBTree::DEFAULT_MARGIN);
+
+	/**
+	 * @brief Inserts the new boxes in the tree and refits the ones that moved.
+	 *
+	 * @param bounds The boxes, identified by their index.
+	 */
+	void update(const std::vector<AABB>& bounds) override;
+
+	/**
+	 * @brief Finds all the pairs of overlapping boxes.
+	 *
+	 * @param bounds The boxes passed to the last update.
+	 * @param pairs The vector the pairs are appended to.
+	 */
+	void findPairs(const std::vector<AABB>& bounds, std::vector<CollisionPair>& pairs) override;
+
+	/**
+	 * @brief Finds the pairs between the boxes and another set, querying the tree with each other box.
+	 *
+	 * @param bounds The boxes passed to the last update.
+	 * @param others The other boxes, identified by their index.
+	 * @param pairs The vector the pairs are appended to, with first the index in bounds and second the index in others.
+	 */
+	void findPairs(const std::vector<AABB>& bounds, const std::vector<AABB>& others, std::vector<CollisionPair>& pairs) override;
+
+	void onAdded(u32 index) override;
+	void onRemoved(u32 index, u32 lastIndex) override;
+
+	/**
+	 * @brief Gets the tree, whose leaves store the index of their box.
+	 */
+	inline const DynamicAABBTree& getTree() const { return m_Tree; }
+private:
+	DynamicAABBTree m_Tree;
+	// The proxy of each box, NULL_NODE until the box is inserted by the next update.
+	std::vector<u32> m_Proxies;
+};
+
+} // namespace vulture
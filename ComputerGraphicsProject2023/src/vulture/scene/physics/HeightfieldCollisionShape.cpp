@@ -0,0 +1,295 @@
+#include "HeightfieldCollisionShape.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace vulture {
+
+glm::vec3 closestPointOnLineSegment(glm::vec3 a, glm::vec3 b, glm::vec3 point);
+
+HeightfieldCollisionShape::HeightfieldCollisionShape() :
+	CollisionShape(CollisionShapeType::HEIGHTFIELD)
+{}
+
+void HeightfieldCollisionShape::setHeights(glm::vec2 origin, f32 size, u32 resolution, std::vector<f32> heights)
+{
+	m_Origin = origin;
+	m_Size = size;
+	m_Resolution = std::max(resolution, 2u);
+	m_CellSize = m_Size / static_cast<f32>(m_Resolution - 1);
+	m_Heights = std::move(heights);
+
+	if (m_Heights.empty()) return;
+
+	auto [min, max] = std::minmax_element(m_Heights.begin(), m_Heights.end());
+	m_MinHeight = *min;
+	m_MaxHeight = *max;
+}
+
+f32 HeightfieldCollisionShape::getHeightAt(glm::vec2 position) const
+{
+	f32 cellsCount = static_cast<f32>(m_Resolution - 1);
+	glm::vec2 local = glm::clamp((position - m_Origin) / m_CellSize, 0.0f, cellsCount);
+
+	u32 x0 = std::min(static_cast<u32>(local.x), m_Resolution - 2);
+	u32 z0 = std::min(static_cast<u32>(local.y), m_Resolution - 2);
+	f32 tx = local.x - static_cast<f32>(x0);
+	f32 tz = local.y - static_cast<f32>(z0);
+
+	f32 h0 = at(x0, z0) + (at(x0 + 1, z0) - at(x0, z0)) * tx;
+	f32 h1 = at(x0, z0 + 1) + (at(x0 + 1, z0 + 1) - at(x0, z0 + 1)) * tx;
+	return h0 + (h1 - h0) * tz;
+}
+
+bool HeightfieldCollisionShape::contains(glm::vec2 position) const
+{
+	if (isEmpty()) return false;
+
+	glm::vec2 local = position - m_Origin;
+	return local.x >= 0.0f && local.y >= 0.0f && local.x <= m_Size && local.y <= m_Size;
+}
+
+void HeightfieldCollisionShape::applyTransform(const Transform& /* transform */)
+{}
+
+bool HeightfieldCollisionShape::testCollision(const Ref<CollisionShape> other) const
+{
+	switch (other->c_Type)
+	{
+	case CollisionShapeType::CAPSULE:
+	{
+		const CapsuleCollisionShape* capsule = reinterpret_cast<CapsuleCollisionShape*>(other.get());
+		glm::vec3 a, b;
+		capsule->getSegment(a, b);
+		return testCapsule(a, b, capsule->getRadius());
+	}
+	default:
+	break;
+	}
+	return false;
+}
+
+AABB HeightfieldCollisionShape::getBounds() const
+{
+	return AABB{
+		glm::vec3(m_Origin.x, m_MinHeight, m_Origin.y),
+		glm::vec3(m_Origin.x + m_Size, m_MaxHeight, m_Origin.y + m_Size)
+	};
+}
+
+f32 HeightfieldCollisionShape::getDistance(glm::vec3 point) const
+{
+	if (isEmpty()) return std::numeric_limits<f32>::infinity();
+
+	glm::vec2 position(point.x, point.z);
+	if (!contains(position)) return std::sqrt(getBounds().getDistanceSquared(point));
+
+	return std::max(point.y - getHeightAt(position), 0.0f);
+}
+
+bool HeightfieldCollisionShape::raycast(glm::vec3 origin, glm::vec3 direction, f32 maxDistance, f32& distance) const
+{
+	if (isEmpty()) return false;
+
+	f32 enter;
+	if (!getBounds().intersectsRay(origin, 1.0f / direction, maxDistance, enter)) return false;
+
+	// The cells are crossed in order, walking the grid on the XZ plane.
+	i64 cellsCount = static_cast<i64>(m_Resolution - 1);
+	glm::vec3 start = origin + direction * enter;
+	i64 x = std::clamp(static_cast<i64>(std::floor((start.x - m_Origin.x) / m_CellSize)), 0LL, cellsCount - 1);
+	i64 z = std::clamp(static_cast<i64>(std::floor((start.z - m_Origin.y) / m_CellSize)), 0LL, cellsCount - 1);
+
+	constexpr f32 INFINITY_DISTANCE = std::numeric_limits<f32>::infinity();
+	i64 stepX = direction.x >= 0.0f ? 1 : -1;
+	i64 stepZ = direction.z >= 0.0f ? 1 : -1;
+	f32 deltaX = direction.x != 0.0f ? m_CellSize / std::abs(direction.x) : INFINITY_DISTANCE;
+	f32 deltaZ = direction.z != 0.0f ? m_CellSize / std::abs(direction.z) : INFINITY_DISTANCE;
+	f32 nextX = direction.x != 0.0f ? (m_Origin.x + static_cast<f32>(x + (stepX > 0)) * m_CellSize - origin.x) / direction.x : INFINITY_DISTANCE;
+	f32 nextZ = direction.z != 0.0f ? (m_Origin.y + static_cast<f32>(z + (stepZ > 0)) * m_CellSize - origin.z) / direction.z : INFINITY_DISTANCE;
+
+	f32 begin = enter;
+	while (true)
+	{
+		f32 end = std::min(std::min(nextX, nextZ), maxDistance);
+		if (intersectCell(static_cast<u32>(x), static_cast<u32>(z), origin, direction, begin, end, distance)) return true;
+		if (end >= maxDistance) return false;
+
+		// Rising above the highest sample, the ray cannot hit anymore.
+		if (direction.y >= 0.0f && origin.y + direction.y * end > m_MaxHeight) return false;
+
+		if (nextX < nextZ)
+		{
+			x += stepX;
+			begin = nextX;
+			nextX += deltaX;
+		}
+		else
+		{
+			z += stepZ;
+			begin = nextZ;
+			nextZ += deltaZ;
+		}
+
+		if (x < 0 || x >= cellsCount || z < 0 || z >= cellsCount) return false;
+	}
+}
+
+bool HeightfieldCollisionShape::intersectCell(u32 x, u32 z, glm::vec3 origin, glm::vec3 direction, f32 begin, f32 end, f32& distance) const
+{
+	if (end < begin) return false;
+
+	f32 h00 = at(x, z);
+	f32 h10 = at(x + 1, z);
+	f32 h01 = at(x, z + 1);
+	f32 h11 = at(x + 1, z + 1);
+
+	// The bilinear patch is never above its highest corner.
+	f32 y0 = origin.y + direction.y * begin;
+	f32 y1 = origin.y + direction.y * end;
+	if (std::min(y0, y1) > std::max(std::max(h00, h10), std::max(h01, h11))) return false;
+
+	// Along the ray, the height above the patch is the quadratic qa * s^2 + qb * s + qc, with s = t - begin.
+	f32 u0 = (origin.x + direction.x * begin - m_Origin.x) / m_CellSize - static_cast<f32>(x);
+	f32 v0 = (origin.z + direction.z * begin - m_Origin.y) / m_CellSize - static_cast<f32>(z);
+	f32 du = direction.x / m_CellSize;
+	f32 dv = direction.z / m_CellSize;
+
+	f32 ex = h10 - h00;
+	f32 ez = h01 - h00;
+	f32 k = h00 - h10 - h01 + h11;
+
+	f32 qc = y0 - (h00 + ex * u0 + ez * v0 + k * u0 * v0);
+	if (qc <= 0.0f)
+	{
+		distance = begin;
+		return true;
+	}
+
+	f32 qb = direction.y - (ex * du + ez * dv + k * (u0 * dv + v0 * du));
+	f32 qa = -k * du * dv;
+
+	f32 discriminant = qb * qb - 4.0f * qa * qc;
+	if (discriminant < 0.0f) return false;
+
+	// Numerically stable roots, which also handle a vanishing qa.
+	f32 q = -0.5f * (qb + std::copysign(std::sqrt(discriminant), qb));
+	f32 s0 = q != 0.0f ? qc / q : -1.0f;
+	f32 s1 = qa != 0.0f ? q / qa : -1.0f;
+	if (s0 > s1) std::swap(s0, s1);
+
+	// The ray starts above the patch, so the first crossing is the smallest non negative root.
+	f32 s = s0 >= 0.0f ? s0 : s1;
+	if (s < 0.0f || s > end - begin) return false;
+
+	distance = begin + s;
+	return true;
+}
+
+bool HeightfieldCollisionShape::sweep(glm::vec3 displacement, const Ref<CollisionShape> other, glm::vec3 otherDisplacement, f32& timeOfImpact) const
+{
+	switch (other->c_Type)
+	{
+	case CollisionShapeType::CAPSULE:
+	{
+		const CapsuleCollisionShape* capsule = reinterpret_cast<CapsuleCollisionShape*>(other.get());
+		glm::vec3 a, b;
+		capsule->getSegment(a, b);
+		return sweepCapsule(a, b, capsule->getRadius(), otherDisplacement - displacement, timeOfImpact);
+	}
+	default:
+	break;
+	}
+	return false;
+}
+
+bool HeightfieldCollisionShape::testCapsule(glm::vec3 a, glm::vec3 b, f32 radius) const
+{
+	if (isEmpty()) return false;
+
+	glm::vec3 extent(radius);
+	AABB bounds{ glm::min(a, b) - extent, glm::max(a, b) + extent };
+	if (!bounds.overlaps(getBounds())) return false;
+
+	// The points of the segment with the bottom of their sphere under the surface.
+	f32 horizontalLength = glm::length(glm::vec2(b.x - a.x, b.z - a.z));
+	u32 steps = 1 + static_cast<u32>(horizontalLength / (m_CellSize * 0.5f));
+	for (u32 i = 0; i <= steps; i++)
+	{
+		glm::vec3 point = a + (b - a) * (static_cast<f32>(i) / static_cast<f32>(steps));
+		glm::vec2 position(point.x, point.z);
+		if (contains(position) && point.y - radius <= getHeightAt(position)) return true;
+	}
+
+	// The samples inside the capsule, for the slopes steeper than the capsule is wide.
+	auto getSampleRange = [this](f32 min, f32 max, f32 origin, u32& first, u32& last) {
+		f32 lastSample = static_cast<f32>(m_Resolution - 1);
+		first = static_cast<u32>(std::clamp(std::ceil((min - origin) / m_CellSize), 0.0f, lastSample));
+		last = static_cast<u32>(std::clamp(std::floor((max - origin) / m_CellSize), 0.0f, lastSample));
+	};
+
+	u32 firstX, lastX, firstZ, lastZ;
+	getSampleRange(bounds.min.x, bounds.max.x, m_Origin.x, firstX, lastX);
+	getSampleRange(bounds.min.z, bounds.max.z, m_Origin.y, firstZ, lastZ);
+
+	f32 radiusSquared = radius * radius;
+	for (u32 z = firstZ; z <= lastZ; z++)
+	{
+		for (u32 x = firstX; x <= lastX; x++)
+		{
+			glm::vec3 sample(m_Origin.x + static_cast<f32>(x) * m_CellSize, at(x, z), m_Origin.y + static_cast<f32>(z) * m_CellSize);
+			glm::vec3 offset = sample - closestPointOnLineSegment(a, b, sample);
+			if (glm::dot(offset, offset) <= radiusSquared) return true;
+		}
+	}
+
+	return false;
+}
+
+bool HeightfieldCollisionShape::sweepCapsule(glm::vec3 a, glm::vec3 b, f32 radius, glm::vec3 displacement, f32& timeOfImpact) const
+{
+	glm::vec3 startA = a - displacement;
+	glm::vec3 startB = b - displacement;
+	if (testCapsule(startA, startB, radius))
+	{
+		timeOfImpact = 0.0f;
+		return true;
+	}
+
+	f32 length = glm::length(displacement);
+	if (length > 0.0f)
+	{
+		glm::vec3 direction = displacement / length;
+		glm::vec3 bottom(0.0f, radius, 0.0f);
+
+		bool hit = false;
+		f32 nearest = length;
+		for (glm::vec3 end : { startA, startB })
+		{
+			f32 distance;
+			if (raycast(end - bottom, direction, nearest, distance))
+			{
+				nearest = distance;
+				hit = true;
+			}
+		}
+
+		if (hit)
+		{
+			timeOfImpact = nearest / length;
+			return true;
+		}
+	}
+
+	// The side of the capsule can still end up in a slope.
+	if (testCapsule(a, b, radius))
+	{
+		timeOfImpact = 1.0f;
+		return true;
+	}
+
+	return false;
+}
+
+} // namespace vulture
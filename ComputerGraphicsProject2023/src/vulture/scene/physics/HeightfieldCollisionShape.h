@@ -0,0 +1,154 @@
+#pragma once
+
+#include "vulture/core/Core.h"
+#include "CollisionShape.h"
+
+#include <vector>
+
+namespace vulture {
+
+/**
+ * @brief Represents the ground as a square grid of height samples.
+ *
+ * The samples are evenly spaced on the XZ plane and the surface between them is interpolated bilinearly.
+ * Everything between the lowest sample and the surface is solid, so that a shape sunk into the ground collides with it.
+ * The samples are in world space and the transform is ignored: a hit box made of a heightfield
+ * is meant to be static, without a transform.
+ */
+class HeightfieldCollisionShape : public CollisionShape
+{
+public:
+	/**
+	 * @brief Constructs an empty heightfield, which collides with nothing.
+	 */
+	HeightfieldCollisionShape();
+
+	/**
+	 * @brief Replaces the samples of the heightfield.
+	 * A static hit box using the heightfield must be added to the collision engine again to update its bounds.
+	 *
+	 * @param origin The world position on the XZ plane of the first sample.
+	 * @param size The side length of the covered region.
+	 * @param resolution The number of samples along each side, at least 2.
+	 * @param heights The heights of the samples, row by row along Z with X changing fastest.
+	 */
+	void setHeights(glm::vec2 origin, f32 size, u32 resolution, std::vector<f32> heights);
+
+	/**
+	 * @brief Computes the height of the surface using bilinear interpolation.
+	 *
+	 * @param position The position on the XZ plane, clamped to the covered region.
+	 *
+	 * @return The interpolated height.
+	 */
+	f32 getHeightAt(glm::vec2 position) const;
+
+	/**
+	 * @brief Checks whether a position on the XZ plane lies inside the covered region.
+	 */
+	bool contains(glm::vec2 position) const;
+
+	inline bool isEmpty() const { return m_Heights.empty(); }
+
+	/**
+	 * @brief Does nothing, as the samples are already in world space.
+	 *
+	 * @param transform The transformation, ignored.
+	 */
+	virtual void applyTransform(const Transform& transform);
+
+	/**
+	 * @brief Tests collision between the ground and another collision shape.
+	 *
+	 * @param other A reference to the other collision shape.
+	 * @return true if a collision is detected, false otherwise.
+	 */
+	virtual bool testCollision(const Ref<CollisionShape> other) const;
+
+	/**
+	 * @brief Computes the bounding box of the samples.
+	 *
+	 * @return The world space bounding box.
+	 */
+	virtual AABB getBounds() const;
+
+	/**
+	 * @brief Computes the distance between a point and the ground.
+	 * Above the covered region the distance is measured vertically, so it is larger than the true one on slopes.
+	 *
+	 * @param point The point in world space.
+	 *
+	 * @return The distance from the surface, 0 if the point is under it.
+	 */
+	virtual f32 getDistance(glm::vec3 point) const;
+
+	/**
+	 * @brief Intersects a ray with the ground, walking the crossed cells in order.
+	 *
+	 * @param origin The origin of the ray.
+	 * @param direction The normalized direction of the ray.
+	 * @param maxDistance The length of the ray.
+	 * @param distance Receives the distance of the hit, 0 if the origin is under the surface.
+	 *
+	 * @return true if the ray hits the ground within maxDistance, false otherwise.
+	 */
+	virtual bool raycast(glm::vec3 origin, glm::vec3 direction, f32 maxDistance, f32& distance) const;
+
+	/**
+	 * @brief Tests collision between the ground and another collision shape along their movement since the previous positions.
+	 *
+	 * @param displacement The translation of the heightfield since its previous position.
+	 * @param other A reference to the other collision shape.
+	 * @param otherDisplacement The translation of the other shape since its previous position.
+	 * @param timeOfImpact Receives the fraction of the movement at which the shapes first touch.
+	 *
+	 * @return true if the shapes touch at any point of the movement, false otherwise.
+	 */
+	virtual bool sweep(glm::vec3 displacement, const Ref<CollisionShape> other, glm::vec3 otherDisplacement, f32& timeOfImpact) const;
+
+	/**
+	 * @brief Tests whether a capsule touches the ground.
+	 * The capsule is tested at points of its segment no farther apart than half a cell,
+	 * together with the samples inside it.
+	 *
+	 * @param a The first end of the segment of the capsule.
+	 * @param b The second end of the segment of the capsule.
+	 * @param radius The radius of the capsule.
+	 *
+	 * @return true if the capsule touches the ground, false otherwise.
+	 */
+	bool testCapsule(glm::vec3 a, glm::vec3 b, f32 radius) const;
+
+	/**
+	 * @brief Tests a capsule translating against the ground.
+	 * The movement is cast from the lowest points of the two ends of the capsule.
+	 *
+	 * @param a The first end of the segment of the capsule, at the end of the movement.
+	 * @param b The second end of the segment of the capsule, at the end of the movement.
+	 * @param radius The radius of the capsule.
+	 * @param displacement The translation of the capsule.
+	 * @param timeOfImpact Receives the fraction of the movement at which the capsule first touches the ground.
+	 *
+	 * @return true if the capsule touches the ground at any point of the movement, false otherwise.
+	 */
+	bool sweepCapsule(glm::vec3 a, glm::vec3 b, f32 radius, glm::vec3 displacement, f32& timeOfImpact) const;
+
+	/**
+	 * @brief Virtual destructor for proper cleanup of derived classes.
+	 */
+	virtual ~HeightfieldCollisionShape() = default;
+private:
+	glm::vec2 m_Origin = { 0, 0 };
+	f32 m_Size = 0.0f;
+	f32 m_CellSize = 0.0f;
+	u32 m_Resolution = 0;
+	f32 m_MinHeight = 0.0f;
+	f32 m_MaxHeight = 0.0f;
+	std::vector<f32> m_Heights;
+
+	inline f32 at(u32 x, u32 z) const { return m_Heights[static_cast<u64>(z) * m_Resolution + x]; }
+
+	bool intersectCell(u32 x, u32 z, glm::vec3 origin, glm::vec3 direction, f32 begin, f32 end, f32& distance) const;
+};
+
+} // namespace vulture
@@ -1,5 +1,7 @@
 #include "HitBox.h"
 
+#include <algorithm>
+
 namespace vulture {
 
 HitBox::HitBox(Ref<CollisionShape> shape)
@@ -13,29 +15,77 @@ void HitBox::addCollisionShape(Ref<CollisionShape> shape)
 }
 
 void HitBox::applyTransform()
+{
+	if (transform)
+	{
+		for (auto& shape : m_Shapes)
+		{
+			shape->applyTransform(*transform);
+		}
+	}
+
+	m_Bounds = m_Shapes.front()->getBounds();
+	for (u64 i = 1; i < m_Shapes.size(); i++)
+	{
+		m_Bounds = m_Bounds.merge(m_Shapes[i]->getBounds());
+	}
+}
+
+bool HitBox::testCollision(const HitBox& other) const
 {
 	for (auto& shape : m_Shapes)
 	{
-		shape->applyTransform(*transform);
+		for (auto& otherShape : other.m_Shapes)
+		{
+			if (shape->testCollision(otherShape)) return true;
+		}
 	}
+	return false;
 }
 
-void HitBox::registerCollidingHitbox(Ref<HitBox> hitbox)
+f32 HitBox::getDistance(glm::vec3 point) const
 {
-	auto [it, added] = m_CurrentCollidingHitBoxes.insert(hitbox);
-	if (added && !m_PreviousCollidingHitBoxes.contains(hitbox))
-		emit(HitBoxEntered{ hitbox->data });
+	f32 distance = m_Shapes.front()->getDistance(point);
+	for (u64 i = 1; i < m_Shapes.size(); i++)
+	{
+		distance = std::min(distance, m_Shapes[i]->getDistance(point));
+	}
+	return distance;
 }
 
-void HitBox::update()
+bool HitBox::raycast(glm::vec3 origin, glm::vec3 direction, f32 maxDistance, f32& distance) const
 {
-	for (auto& hitbox : m_PreviousCollidingHitBoxes)
+	bool hit = false;
+	for (auto& shape : m_Shapes)
+	{
+		f32 shapeDistance;
+		if (shape->raycast(origin, direction, maxDistance, shapeDistance))
+		{
+			// Later shapes only need to beat the nearest hit.
+			maxDistance = shapeDistance;
+			distance = shapeDistance;
+			hit = true;
+		}
+	}
+	return hit;
+}
+
+bool HitBox::sweep(const HitBox& other, glm::vec3 displacement, glm::vec3 otherDisplacement, f32& timeOfImpact) const
+{
+	bool hit = false;
+	for (auto& shape : m_Shapes)
 	{
-		if (!m_CurrentCollidingHitBoxes.contains(hitbox))
-			emit(HitBoxExited{ hitbox->data });
+		for (auto& otherShape : other.m_Shapes)
+		{
+			f32 shapeTimeOfImpact;
+			if (shape->sweep(displacement, otherShape, otherDisplacement, shapeTimeOfImpact) && (!hit || shapeTimeOfImpact < timeOfImpact))
+			{
+				timeOfImpact = shapeTimeOfImpact;
+				hit = true;
+			}
+		}
 	}
-	m_PreviousCollidingHitBoxes.clear();
-	std::swap(m_PreviousCollidingHitBoxes, m_CurrentCollidingHitBoxes);
+	return hit;
 }
 
 } // namespace vulture
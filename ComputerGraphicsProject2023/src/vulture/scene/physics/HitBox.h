@@ -5,7 +5,6 @@
 #include "CollisionShape.h"
 
 #include <vector>
-#include <unordered_set>
 
 namespace vulture {
 
@@ -43,6 +42,8 @@ enum BitMask : u64
 struct HitBoxEntered
 {
 	void* data;
+	u64 layerMask = BitMask::NOME; // The layers of the hit box that entered.
+	f32 timeOfImpact = 1.0f; // The fraction of the movement since the previous update at which the hit boxes first touched.
 };
 
 struct HitBoxExited
@@ -80,8 +81,25 @@ public:
 	 */
 	void* data = nullptr;
 
+	/**
+	 * @brief Whether the hit box moves fast enough to pass through other hit boxes between two updates.
+	 * The collisions of a fast hit box are tested along the translation of its transform since the previous
+	 * collision engine update, so that HitBoxEntered is emitted even if the hit boxes never overlap at an update.
+	 */
+	bool fast = false;
+
+	/**
+	 * @brief Whether the hit box never moves, like the trees and the rocks.
+	 * The collision engine applies the transform of a static hit box only when it is added,
+	 * and never tests two static hit boxes against each other.
+	 */
+	bool isStatic = false;
+
 	/**
 	 * @brief Transform of the hit box.
+	 * A hit box without a transform is always static: its shapes are used as they are, in world space.
+	 * A hit box whose transform has not changed since the previous collision engine update is asleep
+	 * and keeps its previous bounds, so the shapes must not be resized without changing the transform.
 	 */
 	Ref<Transform> transform;
 
@@ -112,16 +130,55 @@ public:
 	 * @return An iterator to the end of the collision shapes container.
 	 */
 	auto end() { return m_Shapes.end(); }
-private:
-	using HitBoxesSet = std::unordered_set<Ref<HitBox>>;
 
+	/**
+	 * @brief Gets the bounding box of all the collision shapes, as computed during the last collision engine update.
+	 *
+	 * @return The world space bounding box.
+	 */
+	inline const AABB& getBounds() const { return m_Bounds; }
+
+	/**
+	 * @brief Computes the distance between a point and the nearest collision shape.
+	 *
+	 * @param point The point in world space.
+	 *
+	 * @return The distance from the surface of the nearest shape, 0 if the point is inside one.
+	 */
+	f32 getDistance(glm::vec3 point) const;
+
+	/**
+	 * @brief Intersects a ray with the collision shapes.
+	 *
+	 * @param origin The origin of the ray.
+	 * @param direction The normalized direction of the ray.
+	 * @param maxDistance The length of the ray.
+	 * @param distance Receives the distance of the nearest hit.
+	 *
+	 * @return true if the ray hits a shape within maxDistance, false otherwise.
+	 */
+	bool raycast(glm::vec3 origin, glm::vec3 direction, f32 maxDistance, f32& distance) const;
+
+	/**
+	 * @brief Tests collision with another hit box along the movement of both since their previous positions.
+	 *
+	 * @param other The other hit box.
+	 * @param displacement The translation of this hit box since its previous position.
+	 * @param otherDisplacement The translation of the other hit box since its previous position.
+	 * @param timeOfImpact Receives the fraction of the movement at which the hit boxes first touch.
+	 *
+	 * @return true if the hit boxes touch at any point of the movement, false otherwise.
+	 */
+	bool sweep(const HitBox& other, glm::vec3 displacement, glm::vec3 otherDisplacement, f32& timeOfImpact) const;
+private:
 	std::vector<Ref<CollisionShape>> m_Shapes;
-	HitBoxesSet m_PreviousCollidingHitBoxes;
-	HitBoxesSet m_CurrentCollidingHitBoxes;
+	AABB m_Bounds;
+	u32 m_EngineIndex = INVALID_ENGINE_INDEX; // The position in the CollisionEngine.
+
+	static constexpr u32 INVALID_ENGINE_INDEX = ~0u;
 
 	void applyTransform();
-	void registerCollidingHitbox(Ref<HitBox> hitbox);
-	void update();
+	bool testCollision(const HitBox& other) const;
 public:
 	friend class CollisionEngine;
 };
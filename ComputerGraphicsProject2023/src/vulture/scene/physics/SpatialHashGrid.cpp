@@ -0,0 +1,173 @@
+#include "SpatialHashGrid.h"
+
+#include <algorithm>
+#include <bit> // std::bit_ceil
+
+namespace vulture {
+
+static inline u32 hashCell(i32 x, i32 z)
+{
+	return static_cast<u32>(x) * 73856093u ^ static_cast<u32>(z) * 19349663u;
+}
+
+static inline CollisionPair makePair(u32 a, u32 b)
+{
+	return a < b ? CollisionPair{ a, b } : CollisionPair{ b, a };
+}
+
+SpatialHashGrid::SpatialHashGrid(f32 cellSize)
+{
+	setCellSize(cellSize);
+}
+
+void SpatialHashGrid::setCellSize(f32 cellSize)
+{
+	m_CellSize = std::max(cellSize, 0.001f);
+	m_InverseCellSize = 1.0f / m_CellSize;
+}
+
+void SpatialHashGrid::update(const std::vector<AABB>& bounds)
+{
+	m_Entries.clear();
+	m_OversizedBoxes.clear();
+
+	for (u32 i = 0; i < bounds.size(); i++)
+	{
+		const AABB& box = bounds[i];
+		i32 minX = getCell(box.min.x), maxX = getCell(box.max.x);
+		i32 minZ = getCell(box.min.z), maxZ = getCell(box.max.z);
+
+		if (isOversized(minX, maxX, minZ, maxZ))
+		{
+			m_OversizedBoxes.push_back(i);
+			continue;
+		}
+
+		for (i32 x = minX; x <= maxX; x++)
+		{
+			for (i32 z = minZ; z <= maxZ; z++)
+			{
+				m_Entries.push_back({ x, z, i, 0 });
+			}
+		}
+	}
+
+	// Counting sort of the entries by bucket.
+	u32 bucketsCount = std::bit_ceil(std::max(static_cast<u32>(m_Entries.size()) * 2, 16u));
+	m_BucketMask = bucketsCount - 1;
+
+	m_BucketStarts.assign(bucketsCount + 1, 0);
+	for (auto& entry : m_Entries)
+	{
+		entry.bucket = hashCell(entry.x, entry.z) & m_BucketMask;
+		m_BucketStarts[entry.bucket + 1]++;
+	}
+	for (u32 i = 0; i < bucketsCount; i++)
+	{
+		m_BucketStarts[i + 1] += m_BucketStarts[i];
+	}
+
+	// The entries of a bucket keep the order of the boxes, which makes the output deterministic.
+	m_BucketCursors.assign(m_BucketStarts.begin(), m_BucketStarts.end() - 1);
+	m_SortedEntries.resize(m_Entries.size());
+	for (auto& entry : m_Entries)
+	{
+		m_SortedEntries[m_BucketCursors[entry.bucket]++] = entry;
+	}
+}
+
+void SpatialHashGrid::findPairs(const std::vector<AABB>& bounds, std::vector<CollisionPair>& pairs)
+{
+	u32 bucketsCount = m_BucketMask + 1;
+	for (u32 bucket = 0; bucket < bucketsCount; bucket++)
+	{
+		u32 end = m_BucketStarts[bucket + 1];
+		for (u32 i = m_BucketStarts[bucket]; i < end; i++)
+		{
+			const Entry& a = m_SortedEntries[i];
+			const AABB& boxA = bounds[a.index];
+
+			for (u32 j = i + 1; j < end; j++)
+			{
+				const Entry& b = m_SortedEntries[j];
+				// Different cells can share a bucket.
+				if (a.x != b.x || a.z != b.z) continue;
+
+				const AABB& boxB = bounds[b.index];
+				if (!boxA.overlaps(boxB)) continue;
+
+				// Both boxes cover the cell of the minimum corner of their intersection: only that cell reports the pair.
+				if (getCell(std::max(boxA.min.x, boxB.min.x)) != a.x || getCell(std::max(boxA.min.z, boxB.min.z)) != a.z) continue;
+
+				pairs.push_back(makePair(a.index, b.index));
+			}
+		}
+	}
+
+	for (u32 i = 0; i < m_OversizedBoxes.size(); i++)
+	{
+		u32 oversized = m_OversizedBoxes[i];
+		for (u32 other = 0; other < bounds.size(); other++)
+		{
+			if (other == oversized) continue;
+			// Pairs of oversized boxes are reported once.
+			if (other < oversized && std::binary_search(m_OversizedBoxes.begin(), m_OversizedBoxes.end(), other)) continue;
+
+			if (bounds[oversized].overlaps(bounds[other]))
+			{
+				pairs.push_back(makePair(oversized, other));
+			}
+		}
+	}
+}
+
+void SpatialHashGrid::findPairs(const std::vector<AABB>& bounds, const std::vector<AABB>& others, std::vector<CollisionPair>& pairs)
+{
+	if (bounds.empty()) return;
+
+	for (u32 k = 0; k < others.size(); k++)
+	{
+		const AABB& other = others[k];
+		i32 minX = getCell(other.min.x), maxX = getCell(other.max.x);
+		i32 minZ = getCell(other.min.z), maxZ = getCell(other.max.z);
+
+		// An oversized other box is tested against all the boxes, the oversized ones included.
+		if (isOversized(minX, maxX, minZ, maxZ))
+		{
+			for (u32 i = 0; i < bounds.size(); i++)
+			{
+				if (bounds[i].overlaps(other)) pairs.push_back({ i, k });
+			}
+			continue;
+		}
+
+		for (i32 x = minX; x <= maxX; x++)
+		{
+			for (i32 z = minZ; z <= maxZ; z++)
+			{
+				u32 bucket = hashCell(x, z) & m_BucketMask;
+				u32 end = m_BucketStarts[bucket + 1];
+				for (u32 i = m_BucketStarts[bucket]; i < end; i++)
+				{
+					const Entry& entry = m_SortedEntries[i];
+					if (entry.x != x || entry.z != z) continue;
+
+					const AABB& box = bounds[entry.index];
+					if (!box.overlaps(other)) continue;
+
+					// As for the pairs among the boxes, only the cell of the minimum corner of the intersection reports the pair.
+					if (getCell(std::max(box.min.x, other.min.x)) != x || getCell(std::max(box.min.z, other.min.z)) != z) continue;
+
+					pairs.push_back({ entry.index, k });
+				}
+			}
+		}
+
+		for (u32 oversized : m_OversizedBoxes)
+		{
+			if (bounds[oversized].overlaps(other)) pairs.push_back({ oversized, k });
+		}
+	}
+}
+
+} // namespace vulture
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "vulture/core/Core.h"
+#include "Broadphase.h"
+
+#include <cmath> // std::floor
+#include <vector>
+
+namespace vulture {
+
+/**
+ * @brief Uniform grid over the XZ plane used to find the pairs of overlapping bounding boxes.
+ *
+ * Every box is inserted in all the cells it covers, and the cells are hashed into buckets
+ * with a counting sort, so that rebuilding the grid from scratch every update is linear in the number of boxes.
+ * Only the boxes sharing a cell are tested against each other; a pair is reported by a single cell,
+ * so no duplicate has to be removed.
+ * Boxes covering more than MAX_CELLS_PER_BOX cells are not inserted and are tested against every other box.
+ */
+class SpatialHashGrid : public Broadphase
+{
+public:
+	/**
+	 * @brief Constructs an empty grid.
+	 *
+	 * @param cellSize The side of a cell, ideally a bit larger than the typical box.
+	 */
+	explicit SpatialHashGrid(f32 cellSize = DEFAULT_CELL_SIZE);
+
+	/**
+	 * @brief Rebuilds the grid from the current boxes.
+	 *
+	 * @param bounds The boxes, identified by their index.
+	 */
+	void update(const std::vector<AABB>& bounds) override;
+
+	/**
+	 * @brief Finds all the pairs of overlapping boxes.
+	 *
+	 * @param bounds The boxes passed to the last update.
+	 * @param pairs The vector the pairs are appended to.
+	 */
+	void findPairs(const std::vector<AABB>& bounds, std::vector<CollisionPair>& pairs) override;
+
+	/**
+	 * @brief Finds the pairs between the boxes and another set, looking up the cells covered by each other box.
+	 *
+	 * @param bounds The boxes passed to the last update.
+	 * @param others The other boxes, identified by their index.
+	 * @param pairs The vector the pairs are appended to, with first the index in bounds and second the index in others.
+	 */
+	void findPairs(const std::vector<AABB>& bounds, const std::vector<AABB>& others, std::vector<CollisionPair>& pairs) override;
+
+	/**
+	 * @brief The grid is rebuilt every frame, so it does not track the boxes.
+	 */
+	inline void onAdded(u32) override {}
+	inline void onRemoved(u32, u32) override {}
+
+	/**
+	 * @brief Sets the side of a cell.
+	 *
+	 * @param cellSize The new side of a cell, must be positive.
+	 */
+	void setCellSize(f32 cellSize);
+
+	inline f32 getCellSize() const { return m_CellSize; }
+
+	static constexpr f32 DEFAULT_CELL_SIZE = 4.0f;
+	static constexpr u32 MAX_CELLS_PER_BOX = 64;
+private:
+	struct Entry
+	{
+		i32 x;
+		i32 z;
+		u32 index;
+		u32 bucket;
+	};
+
+	f32 m_CellSize;
+	f32 m_InverseCellSize;
+
+	// Kept between the frames to avoid reallocations.
+	std::vector<Entry> m_Entries;
+	std::vector<Entry> m_SortedEntries;
+	std::vector<u32> m_BucketStarts;
+	std::vector<u32> m_BucketCursors;
+	std::vector<u32> m_OversizedBoxes;
+	u32 m_BucketMask = 0;
+
+	inline i32 getCell(f32 coordinate) const { return static_cast<i32>(std::floor(coordinate * m_InverseCellSize)); }
+	inline bool isOversized(i32 minX, i32 maxX, i32 minZ, i32 maxZ) const
+	{
+		return static_cast<u64>(maxX - minX + 1) * static_cast<u64>(maxZ - minZ + 1) > MAX_CELLS_PER_BOX;
+	}
+};
+
+} // namespace vulture
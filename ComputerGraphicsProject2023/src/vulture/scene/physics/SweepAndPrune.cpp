@@ -0,0 +1,134 @@
+#include "SweepAndPrune.h"
+
+#include <algorithm>
+
+namespace vulture {
+
+SweepAndPrune::SweepAndPrune(u32 axis) :
+	m_Axis(std::min(axis, 2u))
+{}
+
+void SweepAndPrune::update(const std::vector<AABB>& bounds)
+{
+	for (auto& endpoint : m_Endpoints)
+	{
+		const AABB& box = bounds[endpoint.box];
+		endpoint.value = endpoint.isMax ? box.max[m_Axis] : box.min[m_Axis];
+	}
+
+	// Between the frames only a few endpoints get out of place, so the insertion sort does little work.
+	for (u64 i = 1; i < m_Endpoints.size(); i++)
+	{
+		Endpoint endpoint = m_Endpoints[i];
+		u64 j = i;
+		while (j > 0 && precedes(endpoint, m_Endpoints[j - 1]))
+		{
+			m_Endpoints[j] = m_Endpoints[j - 1];
+			j--;
+		}
+		m_Endpoints[j] = endpoint;
+	}
+}
+
+void SweepAndPrune::findPairs(const std::vector<AABB>& bounds, std::vector<CollisionPair>& pairs)
+{
+	m_Active.clear();
+	m_ActivePositions.resize(bounds.size());
+	for (auto& endpoint : m_Endpoints)
+	{
+		if (endpoint.isMax)
+		{
+			deactivate(m_Active, m_ActivePositions, endpoint.box);
+			continue;
+		}
+
+		const AABB& box = bounds[endpoint.box];
+		for (u32 other : m_Active)
+		{
+			if (box.overlaps(bounds[other]))
+			{
+				pairs.push_back(endpoint.box < other ? CollisionPair{ endpoint.box, other } : CollisionPair{ other, endpoint.box });
+			}
+		}
+
+		activate(m_Active, m_ActivePositions, endpoint.box);
+	}
+}
+
+void SweepAndPrune::findPairs(const std::vector<AABB>& bounds, const std::vector<AABB>& others, std::vector<CollisionPair>& pairs)
+{
+	m_OtherEndpoints.clear();
+	for (u32 k = 0; k < others.size(); k++)
+	{
+		m_OtherEndpoints.push_back({ others[k].min[m_Axis], k, false });
+		m_OtherEndpoints.push_back({ others[k].max[m_Axis], k, true });
+	}
+	std::sort(m_OtherEndpoints.begin(), m_OtherEndpoints.end(), precedes);
+
+	m_Active.clear();
+	m_ActivePositions.resize(bounds.size());
+	m_OtherActive.clear();
+	m_OtherActivePositions.resize(others.size());
+
+	// Merge of the two sorted lists: a box starting is tested against the active boxes of the other set.
+	u64 i = 0, j = 0;
+	while (i < m_Endpoints.size() || j < m_OtherEndpoints.size())
+	{
+		bool takeOwn = j == m_OtherEndpoints.size() ||
+			(i < m_Endpoints.size() && !precedes(m_OtherEndpoints[j], m_Endpoints[i]));
+
+		if (takeOwn)
+		{
+			const Endpoint& endpoint = m_Endpoints[i++];
+			if (endpoint.isMax)
+			{
+				deactivate(m_Active, m_ActivePositions, endpoint.box);
+				continue;
+			}
+
+			const AABB& box = bounds[endpoint.box];
+			for (u32 other : m_OtherActive)
+			{
+				if (box.overlaps(others[other])) pairs.push_back({ endpoint.box, other });
+			}
+			activate(m_Active, m_ActivePositions, endpoint.box);
+		}
+		else
+		{
+			const Endpoint& endpoint = m_OtherEndpoints[j++];
+			if (endpoint.isMax)
+			{
+				deactivate(m_OtherActive, m_OtherActivePositions, endpoint.box);
+				continue;
+			}
+
+			const AABB& other = others[endpoint.box];
+			for (u32 box : m_Active)
+			{
+				if (bounds[box].overlaps(other)) pairs.push_back({ box, endpoint.box });
+			}
+			activate(m_OtherActive, m_OtherActivePositions, endpoint.box);
+		}
+	}
+}
+
+void SweepAndPrune::onAdded(u32 index)
+{
+	// The values are updated and sorted by the next update.
+	m_Endpoints.push_back({ 0.0f, index, false });
+	m_Endpoints.push_back({ 0.0f, index, true });
+}
+
+void SweepAndPrune::onRemoved(u32 index, u32 lastIndex)
+{
+	std::erase_if(m_Endpoints, [index](const Endpoint& endpoint) { return endpoint.box == index; });
+
+	if (lastIndex == index) return;
+
+	for (auto& endpoint : m_Endpoints)
+	{
+		if (endpoint.box == lastIndex) endpoint.box = index;
+	}
+}
+
+} // namespace vulture
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "vulture/core/Core.h"
+#include "Broadphase.h"
+
+#include <vector>
+
+namespace vulture {
+
+/**
+ * @brief Sort and sweep along one axis used to find the pairs of overlapping bounding boxes.
+ *
+ * The endpoints of the boxes along the axis are kept sorted between the frames and re-sorted
+ * with an insertion sort: as the boxes move little from one frame to the next, the update is nearly linear.
+ * The sorted endpoints are then swept keeping the list of the boxes crossing the current position,
+ * and every box is tested only against the boxes in that list.
+ */
+class SweepAndPrune : public Broadphase
+{
+public:
+	/**
+	 * @brief Constructs an empty broadphase.
+	 *
+	 * @param axis The axis the boxes are sorted along: 0 for X, 1 for Y and 2 for Z.
+	 */
+	explicit SweepAndPrune(u32 axis = 0);
+
+	/**
+	 * @brief Updates the endpoints of the boxes and sorts them again.
+	 *
+	 * @param bounds The boxes, identified by their index.
+	 */
+	void update(const std::vector<AABB>& bounds) override;
+
+	/**
+	 * @brief Finds all the pairs of overlapping boxes.
+	 *
+	 * @param bounds The boxes passed to the last update.
+	 * @param pairs The vector the pairs are appended to.
+	 */
+	void findPairs(const std::vector<AABB>& bounds, std::vector<CollisionPair>& pairs) override;
+
+	/**
+	 * @brief Finds the pairs between the boxes and another set, sweeping the endpoints of both sets together.
+	 * The endpoints of the other boxes are sorted from scratch.
+	 *
+	 * @param bounds The boxes passed to the last update.
+	 * @param others The other boxes, identified by their index.
+	 * @param pairs The vector the pairs are appended to, with first the index in bounds and second the index in others.
+	 */
+	void findPairs(const std::vector<AABB>& bounds, const std::vector<AABB>& others, std::vector<CollisionPair>& pairs) override;
+
+	void onAdded(u32 index) override;
+	void onRemoved(u32 index, u32 lastIndex) override;
+private:
+	struct Endpoint
+	{
+		f32 value;
+		u32 box;
+		bool isMax;
+	};
+
+	u32 m_Axis;
+	std::vector<Endpoint> m_Endpoints;
+
+	// The boxes crossing the sweep position and the position of each box in that list.
+	std::vector<u32> m_Active;
+	std::vector<u32> m_ActivePositions;
+
+	// The same for the other set of boxes.
+	std::vector<Endpoint> m_OtherEndpoints;
+	std::vector<u32> m_OtherActive;
+	std::vector<u32> m_OtherActivePositions;
+
+	static inline void activate(std::vector<u32>& active, std::vector<u32>& positions, u32 box)
+	{
+		positions[box] = static_cast<u32>(active.size());
+		active.push_back(box);
+	}
+
+	static inline void deactivate(std::vector<u32>& active, std::vector<u32>& positions, u32 box)
+	{
+		u32 position = positions[box];
+		active[position] = active.back();
+		positions[active[position]] = position;
+		active.pop_back();
+	}
+
+	static inline bool precedes(const Endpoint& a, const Endpoint& b)
+	{
+		// The minimum endpoints come first on ties, so that touching boxes overlap.
+		return a.value < b.value || (a.value == b.value && !a.isMax && b.isMax);
+	}
+};
+
+} // namespace vulture
@@ -22,7 +22,7 @@ public:
 	inline void setPosition(glm::vec3 pos)
 	{
 		m_Position = pos;
-		m_ShouldUpdate = true;
+		invalidate();
 	}
 
 	/**
@@ -42,7 +42,7 @@ public:
 	void translate(glm::vec3 translation)
 	{
 		m_Position += translation;
-		m_ShouldUpdate = true;
+		invalidate();
 	}
 
 	/**
@@ -66,7 +66,7 @@ public:
 	 *
 	 * @param scale The new scale of the object as a glm::vec3.
 	 */
-	inline void setScale(glm::vec3 scale) { m_Scale = scale; m_ShouldUpdate = true; }
+	inline void setScale(glm::vec3 scale) { m_Scale = scale; invalidate(); }
 
 	/**
 	 * @brief Sets the scale of the object.
@@ -96,14 +96,14 @@ public:
 	 *
 	 * @param rot The rotation quaternion.
 	 */
-	inline void setRotation(glm::quat rot) { m_Rotation = rot; m_ShouldUpdate = true; }
+	inline void setRotation(glm::quat rot) { m_Rotation = rot; invalidate(); }
 
 	/**
 	 * @brief Sets the rotation of the object using a rotation vector.
 	 *
 	 * @param rot The rotation vector.
 	 */
-	inline void setRotation(glm::vec3 rot) { m_Rotation = glm::quat(rot); m_ShouldUpdate = true; }
+	inline void setRotation(glm::vec3 rot) { m_Rotation = glm::quat(rot); invalidate(); }
 
 	/**
 	 * @brief Sets the rotation of the object using Euler angles.
@@ -119,7 +119,7 @@ public:
 	 *
 	 * @param rotation The rotation quaternion.
 	 */
-	inline void rotate(glm::quat rotation) { m_Rotation *= rotation; m_ShouldUpdate = true; }
+	inline void rotate(glm::quat rotation) { m_Rotation *= rotation; invalidate(); }
 
 	/**
 	 * @brief Rotates the object by the specified angles around the x, y, and z axes, respectively.
@@ -155,6 +155,14 @@ public:
 
 		return m_WorldMatrix;
 	}
+
+	/**
+	 * @brief Returns a counter incremented by every change of the transform.
+	 * Unlike the flag cleared by getWorldMatrix it is never reset, so that any number of users can tell whether the transform changed.
+	 *
+	 * @return The number of changes of the transform.
+	 */
+	inline u64 getVersion() const { return m_Version; }
 private:
 	glm::vec3 m_Position = glm::vec3(0.0f);
 	glm::quat m_Rotation = glm::quat(glm::vec3(0.0f));
@@ -162,6 +170,13 @@ private:
 
 	bool m_ShouldUpdate = true;
 	glm::mat4 m_WorldMatrix = glm::mat4(1);
+	u64 m_Version = 0;
+
+	inline void invalidate()
+	{
+		m_ShouldUpdate = true;
+		m_Version++;
+	}
 };
 
 } // namespace vulture
\ No newline at end of file
@@ -1,2 +1,11 @@
 #define STB_PERLIN_IMPLEMENTATION
 #include "stb_perlin.h"
+
+#include <cstring>
+
+// Copies the permutation tables used by the noise functions, so that shaders can reproduce them.
+void stb_perlin_get_tables(unsigned char randtab[512], unsigned char gradIdx[512])
+{
+	std::memcpy(randtab, stb__perlin_randtab, 512);
+	std::memcpy(gradIdx, stb__perlin_randtab_grad_idx, 512);
+}
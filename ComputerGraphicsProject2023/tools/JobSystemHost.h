@@ -0,0 +1,21 @@
+#pragma once
+
+#include "vulture/core/Job.h"
+
+namespace vulture {
+
+/**
+ * @brief Stands in for the Application in the tools that only need the job system.
+ *
+ * The job system is started, pumped and stopped by the Application, which is the only class allowed to do so.
+ * The tools do not link the real one, since it needs a window and the renderer.
+ */
+class Application
+{
+public:
+	static inline bool initJobs(const JobSystemConfig& config = {}) { return Job::init(config); }
+	static inline void processJobs() { Job::process(); }
+	static inline void cleanupJobs() { Job::cleanup(); }
+};
+
+} // namespace vulture
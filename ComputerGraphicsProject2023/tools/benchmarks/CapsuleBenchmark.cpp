@@ -0,0 +1,153 @@
+// Capsule pairs tested per second by the narrowphase.
+//
+// Random capsules are tested in pairs whose bounding boxes overlap, as the broadphase hands them to the narrowphase, by:
+//   - testCollisionCapsuleCapsule, one pair at a time on the capsule shapes;
+//   - CollisionShape::testCollision, the virtual call the engine made for each pair before the capsules were batched;
+//   - CapsuleBatch::testPairsScalar, one pair at a time on the packed capsules;
+//   - CapsuleBatch::testPairs, CapsuleBatch::LANES pairs at a time.
+// Every method must agree with testCollisionCapsuleCapsule, the program fails otherwise.
+// The project is also built with AVX2 enabled, as CapsuleBenchmarkAVX2, to compare the 4 and 8 lanes kernels.
+//
+// Usage: CapsuleBenchmark [runs]
+
+#include "vulture/scene/physics/CapsuleBatch.h"
+#include "vulture/scene/physics/CollisionShape.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace vulture;
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr u32 CAPSULES_COUNT = 4096;
+static constexpr u64 PAIRS_COUNT = 1 << 20;
+static constexpr f32 WORLD_SIZE = 100.0f;
+
+static std::vector<Ref<CapsuleCollisionShape>> capsules;
+static std::vector<Ref<CollisionShape>> shapes;
+static std::vector<CapsulePair> pairs;
+static CapsuleBatch batch;
+
+static void generate()
+{
+	std::mt19937 random(42);
+	std::uniform_real_distribution<f32> position(0.0f, WORLD_SIZE);
+	std::uniform_real_distribution<f32> angle(0.0f, 6.2831853f);
+	std::uniform_real_distribution<f32> radius(0.5f, 2.0f);
+	std::uniform_real_distribution<f32> height(2.0f, 12.0f);
+
+	for (u32 i = 0; i < CAPSULES_COUNT; i++)
+	{
+		f32 capsuleRadius = radius(random);
+		auto capsule = makeRef<CapsuleCollisionShape>(capsuleRadius, capsuleRadius * 2.0f + height(random));
+
+		Transform transform;
+		transform.setPosition(position(random), position(random), position(random));
+		transform.setRotation(angle(random), angle(random), angle(random));
+		capsule->applyTransform(transform);
+
+		glm::vec3 a, b;
+		capsule->getSegment(a, b);
+		batch.add(a, b, capsule->getRadius());
+
+		capsules.push_back(capsule);
+		shapes.push_back(capsule);
+	}
+
+	// The overlapping pairs, shuffled and repeated up to PAIRS_COUNT.
+	std::vector<CapsulePair> overlapping;
+	for (u32 i = 0; i < CAPSULES_COUNT; i++)
+	{
+		AABB bounds = capsules[i]->getBounds();
+		for (u32 j = i + 1; j < CAPSULES_COUNT; j++)
+		{
+			if (bounds.overlaps(capsules[j]->getBounds())) overlapping.push_back({ i, j });
+		}
+	}
+	std::shuffle(overlapping.begin(), overlapping.end(), random);
+
+	pairs.resize(PAIRS_COUNT);
+	for (u64 i = 0; i < PAIRS_COUNT; i++)
+	{
+		pairs[i] = overlapping[i % overlapping.size()];
+	}
+}
+
+static void testShapes(std::vector<u8>& results)
+{
+	for (u64 i = 0; i < PAIRS_COUNT; i++)
+	{
+		results[i] = testCollisionCapsuleCapsule(capsules[pairs[i].first].get(), capsules[pairs[i].second].get());
+	}
+}
+
+static void testVirtual(std::vector<u8>& results)
+{
+	for (u64 i = 0; i < PAIRS_COUNT; i++)
+	{
+		results[i] = shapes[pairs[i].first]->testCollision(shapes[pairs[i].second]);
+	}
+}
+
+static void testBatchScalar(std::vector<u8>& results)
+{
+	batch.testPairsScalar(pairs, 0, PAIRS_COUNT, results);
+}
+
+static void testBatch(std::vector<u8>& results)
+{
+	batch.testPairs(pairs, 0, PAIRS_COUNT, results);
+}
+
+// Returns the number of pairs that do not agree with the reference.
+static u64 report(const char* name, void (*test)(std::vector<u8>&), const std::vector<u8>& reference, u32 runsCount)
+{
+	std::vector<u8> results(PAIRS_COUNT);
+	std::vector<f64> pairsPerSecond;
+	for (u32 i = 0; i < runsCount; i++)
+	{
+		Clock::time_point start = Clock::now();
+		test(results);
+		f64 seconds = std::chrono::duration<f64>(Clock::now() - start).count();
+		pairsPerSecond.push_back(static_cast<f64>(PAIRS_COUNT) / seconds);
+	}
+	std::sort(pairsPerSecond.begin(), pairsPerSecond.end());
+
+	u64 mismatchesCount = 0;
+	for (u64 i = 0; i < PAIRS_COUNT; i++)
+	{
+		if (results[i] != reference[i]) mismatchesCount++;
+	}
+
+	std::printf("%-28s %8.1f Mpairs/s   %llu mismatches\n", name, pairsPerSecond[runsCount / 2] / 1e6,
+		static_cast<unsigned long long>(mismatchesCount));
+	return mismatchesCount;
+}
+
+int main(int argc, char** argv)
+{
+	u32 runsCount = argc > 1 ? static_cast<u32>(std::max(1, std::atoi(argv[1]))) : 9;
+
+	generate();
+
+	std::vector<u8> reference(PAIRS_COUNT);
+	testShapes(reference);
+	u64 collisionsCount = std::count(reference.begin(), reference.end(), 1);
+
+	std::printf("%llu pairs of %u capsules, %llu colliding, %u lanes, median of %u runs\n",
+		static_cast<unsigned long long>(PAIRS_COUNT), CAPSULES_COUNT, static_cast<unsigned long long>(collisionsCount),
+		CapsuleBatch::LANES, runsCount);
+
+	u64 mismatchesCount = 0;
+	mismatchesCount += report("testCollisionCapsuleCapsule", testShapes, reference, runsCount);
+	mismatchesCount += report("testCollision (virtual)", testVirtual, reference, runsCount);
+	mismatchesCount += report("testPairsScalar", testBatchScalar, reference, runsCount);
+	mismatchesCount += report("testPairs", testBatch, reference, runsCount);
+
+	return mismatchesCount == 0 ? 0 : 1;
+}
@@ -0,0 +1,268 @@
+// Cost of a collision engine update from 100 to 10,000 hit boxes, for each broadphase.
+//
+// The scene looks like a wave of the game at a constant density: enemies walking around, bullets flying
+// across the XZ plane and static trees. Every broadphase updates the same scene with the same movements.
+// After the last update the contacts reported by the events are checked against all the pairs of hit boxes
+// tested one by one, so a broadphase missing pairs makes the program fail.
+//
+// Besides the time, each update is measured in CPU cycles and in heap allocations, counted by replacing the
+// global allocation functions. The allocations of the workers during the update are counted as well.
+//
+// Usage: CollisionBenchmark [frames]
+
+#include "JobSystemHost.h"
+
+#include "vulture/scene/physics/CollisionEngine.h"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+using namespace vulture;
+
+using Clock = std::chrono::steady_clock;
+
+static std::atomic<u64> allocationsCount = 0;
+
+void* operator new(std::size_t size)
+{
+	allocationsCount.fetch_add(1, std::memory_order_relaxed);
+	if (void* pointer = std::malloc(size == 0 ? 1 : size)) return pointer;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+	std::free(pointer);
+}
+
+// The time stamp counter on x86, the nanoseconds of the steady clock elsewhere.
+static inline u64 readCycles()
+{
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	return static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count());
+#endif
+}
+
+static constexpr u32 WARM_UP_FRAMES = 5;
+static constexpr f32 AREA_PER_HITBOX = 36.0f; // Square meters of the plane for each hit box.
+
+static constexpr u64 ENEMY_LAYER = BitMask::BIT0;
+static constexpr u64 BULLET_LAYER = BitMask::BIT1;
+static constexpr u64 TREE_LAYER = BitMask::BIT2;
+
+struct BroadphaseResult
+{
+	f64 updateTime; // Milliseconds for each update.
+	f64 updateCycles; // Millions of cycles for each update.
+	u64 allocations; // For each update.
+	u64 testedPairs; // For each update.
+	i64 contacts;   // Live contacts after the last update, as told by the events.
+	i64 expectedContacts;
+};
+
+class BenchmarkScene
+{
+public:
+	BenchmarkScene(BroadphaseType broadphase, u32 hitboxesCount) :
+		m_Engine(broadphase), m_Contacts(hitboxesCount, 0)
+	{
+		m_Side = std::sqrt(static_cast<f32>(hitboxesCount) * AREA_PER_HITBOX);
+
+		std::uniform_real_distribution<f32> position(0.0f, m_Side);
+		std::uniform_real_distribution<f32> direction(-1.0f, 1.0f);
+		for (u32 i = 0; i < hitboxesCount; i++)
+		{
+			// 60% enemies, 25% bullets, 15% trees.
+			u32 kind = i % 20;
+			Ref<HitBox> hitbox;
+			glm::vec3 velocity(0.0f);
+			if (kind < 12)
+			{
+				hitbox = makeRef<HitBox>(makeRef<CapsuleCollisionShape>(0.8f, 3.0f));
+				hitbox->layerMask = ENEMY_LAYER;
+				hitbox->collisionMask = BULLET_LAYER | TREE_LAYER;
+				velocity = glm::vec3(direction(m_Random), 0.0f, direction(m_Random)) * 0.05f;
+			}
+			else if (kind < 17)
+			{
+				hitbox = makeRef<HitBox>(makeRef<CapsuleCollisionShape>(0.2f, 0.6f));
+				hitbox->layerMask = BULLET_LAYER;
+				hitbox->collisionMask = ENEMY_LAYER | TREE_LAYER;
+				velocity = glm::vec3(direction(m_Random), 0.0f, direction(m_Random)) * 0.5f;
+			}
+			else
+			{
+				hitbox = makeRef<HitBox>(makeRef<CapsuleCollisionShape>(1.0f, 8.0f));
+				hitbox->layerMask = TREE_LAYER;
+				hitbox->collisionMask = BitMask::NOME;
+				hitbox->isStatic = true;
+			}
+
+			hitbox->transform = makeRef<Transform>();
+			hitbox->transform->setPosition(position(m_Random), 0.0f, position(m_Random));
+			hitbox->addCallback([this, i](const HitBoxEntered&) { m_Contacts[i]++; });
+			hitbox->addCallback([this, i](const HitBoxExited&) { m_Contacts[i]--; });
+
+			m_Engine.addHitbox(hitbox);
+			m_HitBoxes.push_back(hitbox);
+			m_Velocities.push_back(velocity);
+		}
+	}
+
+	// Moves the enemies and the bullets, wrapping around the edges of the plane.
+	void move()
+	{
+		for (u64 i = 0; i < m_HitBoxes.size(); i++)
+		{
+			if (m_HitBoxes[i]->isStatic) continue;
+
+			Transform& transform = *m_HitBoxes[i]->transform;
+			glm::vec3 position = transform.getPosition() + m_Velocities[i];
+			position.x = std::fmod(position.x + m_Side, m_Side);
+			position.z = std::fmod(position.z + m_Side, m_Side);
+			transform.setPosition(position);
+		}
+	}
+
+	inline CollisionEngine& getEngine() { return m_Engine; }
+
+	i64 getContactsCount() const
+	{
+		i64 count = 0;
+		for (i64 contacts : m_Contacts)
+		{
+			count += contacts;
+		}
+		return count;
+	}
+
+	// The contacts as of the last update, testing every pair of hit boxes shape by shape.
+	i64 countContacts() const
+	{
+		i64 count = 0;
+		for (u64 i = 0; i < m_HitBoxes.size(); i++)
+		{
+			HitBox& hitbox = *m_HitBoxes[i];
+			for (u64 j = 0; j < m_HitBoxes.size(); j++)
+			{
+				HitBox& other = *m_HitBoxes[j];
+				if (i == j || (hitbox.collisionMask & other.layerMask) == 0) continue;
+				if (!hitbox.getBounds().overlaps(other.getBounds())) continue;
+
+				bool collides = false;
+				for (auto& shape : hitbox)
+				{
+					for (auto& otherShape : other)
+					{
+						collides = collides || shape->testCollision(otherShape);
+					}
+				}
+				if (collides) count++;
+			}
+		}
+		return count;
+	}
+private:
+	CollisionEngine m_Engine;
+	std::vector<Ref<HitBox>> m_HitBoxes;
+	std::vector<glm::vec3> m_Velocities;
+	std::vector<i64> m_Contacts; // For each hit box, the hit boxes it entered minus the ones it exited.
+	std::mt19937 m_Random{ 7 };
+	f32 m_Side;
+};
+
+static BroadphaseResult run(BroadphaseType broadphase, u32 hitboxesCount, u32 framesCount)
+{
+	BenchmarkScene scene(broadphase, hitboxesCount);
+	for (u32 frame = 0; frame < WARM_UP_FRAMES; frame++)
+	{
+		scene.move();
+		scene.getEngine().update(0.016f);
+	}
+
+	f64 updateTime = 0.0;
+	u64 updateCycles = 0;
+	u64 allocations = 0;
+	u64 testedPairs = 0;
+	for (u32 frame = 0; frame < framesCount; frame++)
+	{
+		scene.move();
+
+		u64 startAllocations = allocationsCount.load();
+		u64 startCycles = readCycles();
+		Clock::time_point start = Clock::now();
+		scene.getEngine().update(0.016f);
+		updateTime += std::chrono::duration<f64, std::milli>(Clock::now() - start).count();
+		updateCycles += readCycles() - startCycles;
+		allocations += allocationsCount.load() - startAllocations;
+		testedPairs += scene.getEngine().getTestedPairCount();
+	}
+
+	BroadphaseResult result;
+	result.updateTime = updateTime / framesCount;
+	result.updateCycles = static_cast<f64>(updateCycles) / 1e6 / framesCount;
+	result.allocations = allocations / framesCount;
+	result.testedPairs = testedPairs / framesCount;
+	result.contacts = scene.getContactsCount();
+	result.expectedContacts = scene.countContacts();
+	return result;
+}
+
+int main(int argc, char** argv)
+{
+	u32 framesCount = argc > 1 ? static_cast<u32>(std::max(1, std::atoi(argv[1]))) : 30;
+
+	Application::initJobs();
+
+	struct NamedBroadphase
+	{
+		const char* name;
+		BroadphaseType type;
+	};
+	const NamedBroadphase broadphases[] = {
+		{ "grid", BroadphaseType::SPATIAL_HASH_GRID },
+		{ "sap", BroadphaseType::SWEEP_AND_PRUNE },
+		{ "tree", BroadphaseType::DYNAMIC_TREE },
+	};
+
+	std::printf("%u threads taking part, mean of %u updates\n", Job::getParallelism(), framesCount);
+
+	bool correct = true;
+	for (u32 hitboxesCount : { 100u, 1000u, 10000u })
+	{
+		for (const NamedBroadphase& broadphase : broadphases)
+		{
+			BroadphaseResult result = run(broadphase.type, hitboxesCount, framesCount);
+			bool matches = result.contacts == result.expectedContacts;
+			correct = correct && matches;
+
+			std::printf("%6u hit boxes %-5s %9.3f ms/update %8.2f Mcycles/update %6llu allocations/update "
+				"%8llu pairs/update %7lld contacts%s\n",
+				hitboxesCount, broadphase.name, result.updateTime, result.updateCycles,
+				static_cast<unsigned long long>(result.allocations), static_cast<unsigned long long>(result.testedPairs),
+				static_cast<long long>(result.contacts), matches ? "" : "   MISMATCH");
+		}
+	}
+
+	Application::cleanupJobs();
+	return correct ? 0 : 1;
+}
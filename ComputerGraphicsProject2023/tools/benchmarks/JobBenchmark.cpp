@@ -0,0 +1,131 @@
+// Throughput and latency of the job system with many tiny jobs.
+//
+// The main thread submits JOBS_COUNT jobs whose work only stores a timestamp, then calls Job::process
+// until all the cleanups have run, as the application does every frame. The latency of a job is the time
+// between its submission and the start of its work. Each run is repeated and the median run is reported.
+// The typed jobs are also run with the metrics enabled, to show the cost of timing every job.
+//
+// Usage: JobBenchmark [compute workers, 0 for one per logical CPU but the main thread] [runs]
+
+#include "JobSystemHost.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace vulture;
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr u64 JOBS_COUNT = 100000;
+
+struct RunResult
+{
+	f64 jobsPerSecond;
+	f64 p50; // Microseconds.
+	f64 p99;
+	f64 p999;
+};
+
+static std::vector<Clock::time_point> submitTimes(JOBS_COUNT);
+static std::vector<Clock::time_point> startTimes(JOBS_COUNT);
+static u64 cleanupsCount = 0;
+
+static RunResult collect(Clock::time_point begin, Clock::time_point end)
+{
+	std::vector<f64> latencies(JOBS_COUNT);
+	for (u64 i = 0; i < JOBS_COUNT; i++)
+	{
+		latencies[i] = std::chrono::duration<f64, std::micro>(startTimes[i] - submitTimes[i]).count();
+	}
+	std::sort(latencies.begin(), latencies.end());
+
+	RunResult result;
+	result.jobsPerSecond = static_cast<f64>(JOBS_COUNT) / std::chrono::duration<f64>(end - begin).count();
+	result.p50 = latencies[JOBS_COUNT / 2];
+	result.p99 = latencies[JOBS_COUNT * 99 / 100];
+	result.p999 = latencies[JOBS_COUNT * 999 / 1000];
+	return result;
+}
+
+// Jobs made of std::function callbacks, as submitted before the typed jobs existed.
+static RunResult runCallbackJobs()
+{
+	cleanupsCount = 0;
+	Clock::time_point begin = Clock::now();
+	for (u64 i = 0; i < JOBS_COUNT; i++)
+	{
+		submitTimes[i] = Clock::now();
+		Job::submit([](void* data) {
+			startTimes[reinterpret_cast<u64>(data)] = Clock::now();
+			return true;
+		}, reinterpret_cast<void*>(i), [](bool, void*) { cleanupsCount++; });
+	}
+	while (cleanupsCount < JOBS_COUNT)
+	{
+		Application::processJobs();
+	}
+	return collect(begin, Clock::now());
+}
+
+// Jobs made of typed callables, stored inline in the pooled jobs.
+static RunResult runTypedJobs()
+{
+	cleanupsCount = 0;
+	Clock::time_point begin = Clock::now();
+	for (u64 i = 0; i < JOBS_COUNT; i++)
+	{
+		submitTimes[i] = Clock::now();
+		Job::submit([i]() { startTimes[i] = Clock::now(); }, []() { cleanupsCount++; });
+	}
+	while (cleanupsCount < JOBS_COUNT)
+	{
+		Application::processJobs();
+	}
+	return collect(begin, Clock::now());
+}
+
+static void report(const char* name, RunResult (*run)(), u32 runsCount)
+{
+	// The first run fills the job pool and the caches.
+	run();
+
+	std::vector<RunResult> results;
+	for (u32 i = 0; i < runsCount; i++)
+	{
+		results.push_back(run());
+	}
+	std::sort(results.begin(), results.end(), [](const RunResult& a, const RunResult& b) {
+		return a.jobsPerSecond < b.jobsPerSecond;
+	});
+
+	const RunResult& median = results[results.size() / 2];
+	std::printf("%-10s %12.0f jobs/s   p50 %9.1f us   p99 %9.1f us   p999 %9.1f us\n",
+		name, median.jobsPerSecond, median.p50, median.p99, median.p999);
+}
+
+int main(int argc, char** argv)
+{
+	JobSystemConfig config;
+	config.computeWorkers = argc > 1 ? static_cast<u32>(std::atoi(argv[1])) : 0;
+	config.ioWorkers = 0;
+	u32 runsCount = argc > 2 ? static_cast<u32>(std::max(1, std::atoi(argv[2]))) : 9;
+
+	Application::initJobs(config);
+	// The cleanups are measured as a whole, not spread over frames.
+	Job::setProcessBudget(0.0f);
+
+	std::printf("%llu jobs, %u threads taking part, median of %u runs\n",
+		static_cast<unsigned long long>(JOBS_COUNT), Job::getParallelism(), runsCount);
+	report("callback", runCallbackJobs, runsCount);
+	report("typed", runTypedJobs, runsCount);
+	// The same jobs, measuring the wait and run time of every job.
+	Job::setMetricsEnabled(true);
+	report("timed", runTypedJobs, runsCount);
+	Job::setMetricsEnabled(false);
+
+	Application::cleanupJobs();
+	return 0;
+}
@@ -0,0 +1,78 @@
+// Tests of the CollisionEngine running on the job system.
+
+#include "JobSystemHost.h"
+#include "tests/Testing.h"
+
+#include "vulture/scene/physics/CollisionEngine.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace vulture;
+
+using Clock = std::chrono::steady_clock;
+
+// The narrowphase asks the busy worker for help, while an unrelated job is queued before the helper.
+// The main thread has to do the whole narrowphase by itself, without running the unrelated job.
+static void narrowphaseSkipsUnrelatedJobs()
+{
+	constexpr auto UNRELATED_JOB_DURATION = std::chrono::milliseconds(300);
+
+	// Capsules on top of each other: 4950 capsule pairs, several chunks for the narrowphase.
+	CollisionEngine engine;
+	std::vector<Ref<HitBox>> hitboxes;
+	for (u32 i = 0; i < 100; i++)
+	{
+		auto hitbox = makeRef<HitBox>(makeRef<CapsuleCollisionShape>(0.5f, 2.0f));
+		hitbox->layerMask = BitMask::BIT0;
+		hitbox->collisionMask = BitMask::BIT0;
+		hitbox->transform = makeRef<Transform>();
+		hitbox->transform->setPosition(0.01f * static_cast<f32>(i), 0.0f, 0.0f);
+		engine.addHitbox(hitbox);
+		hitboxes.push_back(hitbox);
+	}
+
+	std::atomic<bool> workerBusy = false;
+	std::atomic<bool> releaseWorker = false;
+	JobHandle blocker = Job::submit([&]() {
+		workerBusy = true;
+		while (!releaseWorker) std::this_thread::yield();
+	});
+	while (!workerBusy) std::this_thread::yield();
+
+	// The worker is busy, so only the main thread could start it before the worker is released.
+	std::atomic<bool> unrelatedStarted = false;
+	JobHandle unrelated = Job::submit([&]() {
+		unrelatedStarted = true;
+		std::this_thread::sleep_for(UNRELATED_JOB_DURATION);
+	}, nullptr, {}, JobPriority::LOW);
+
+	Clock::time_point start = Clock::now();
+	engine.update(0.016f);
+	Clock::duration updateTime = Clock::now() - start;
+	bool unrelatedStartedDuringUpdate = unrelatedStarted;
+
+	releaseWorker = true;
+	Job::join({ blocker, unrelated });
+
+	VUCHECK(engine.getTestedPairCount() == 4950);
+	VUCHECK(updateTime < UNRELATED_JOB_DURATION);
+	VUCHECK(!unrelatedStartedDuringUpdate);
+}
+
+int main()
+{
+	JobSystemConfig config;
+	config.computeWorkers = 1;
+	config.ioWorkers = 0;
+	Application::initJobs(config);
+
+	int result = testing::runTests({
+		{ "narrowphaseSkipsUnrelatedJobs", narrowphaseSkipsUnrelatedJobs },
+	});
+
+	Application::cleanupJobs();
+	return result;
+}
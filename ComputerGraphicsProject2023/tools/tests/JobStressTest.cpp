@@ -0,0 +1,173 @@
+// Stress test of the job system, meant to be run under ThreadSanitizer.
+//
+// Several threads submit jobs at the same time as the workers submit nested jobs and push completed jobs
+// to the main thread, which runs the cleanups within a small budget. Every job records how many times its
+// work and its cleanup ran, so lost, duplicated or misplaced jobs are reported even without the sanitizer.
+
+#include "JobSystemHost.h"
+#include "tests/Testing.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using namespace vulture;
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr u32 PRODUCERS_COUNT = 4;
+static constexpr u32 JOBS_PER_PRODUCER = 20000;
+static constexpr u32 JOBS_COUNT = PRODUCERS_COUNT * JOBS_PER_PRODUCER;
+static constexpr u32 NESTED_JOB_INTERVAL = 4;   // Every few jobs submit another job from their work.
+static constexpr u32 DEPENDENT_JOB_INTERVAL = 8; // Every few jobs depend on the previous job of their producer.
+static constexpr u32 IDLE_GAP_INTERVAL = 1000;  // The producers pause so that the workers go to sleep.
+
+struct JobRecord
+{
+	std::atomic<u32> workRuns = 0;
+	std::atomic<bool> dependencyDone = true;
+	u32 cleanupRuns = 0; // Only touched by the main thread.
+	bool cleanupOnMainThread = true;
+};
+
+// The records of the submitted jobs, followed by the ones of the nested jobs.
+static std::array<JobRecord, 2 * JOBS_COUNT> records;
+
+static u32 cleanupsCount = 0;
+static std::atomic<u32> nestedJobsCount = 0;
+
+static void runCleanup(u32 index)
+{
+	records[index].cleanupRuns++;
+	records[index].cleanupOnMainThread = records[index].cleanupOnMainThread && Job::isMainThread();
+	cleanupsCount++;
+}
+
+static void runWork(u32 index)
+{
+	records[index].workRuns.fetch_add(1, std::memory_order_relaxed);
+	if (index % NESTED_JOB_INTERVAL != 0) return;
+
+	nestedJobsCount.fetch_add(1, std::memory_order_relaxed);
+	u32 nestedIndex = JOBS_COUNT + index;
+	Job::submit([nestedIndex]() {
+		records[nestedIndex].workRuns.fetch_add(1, std::memory_order_relaxed);
+		return nestedIndex;
+	}, [](u32 index) { runCleanup(index); }, {}, JobPriority::HIGH);
+}
+
+static void produce(u32 producer)
+{
+	JobHandle previous;
+	for (u32 i = 0; i < JOBS_PER_PRODUCER; i++)
+	{
+		u32 index = producer * JOBS_PER_PRODUCER + i;
+		JobPriority priority = static_cast<JobPriority>(index % 3);
+		JobQueue queue = index % 16 == 5 ? JobQueue::IO : JobQueue::COMPUTE;
+
+		JobHandle dependency;
+		if (i % DEPENDENT_JOB_INTERVAL == 0 && previous.isValid())
+		{
+			dependency = previous;
+			records[index].dependencyDone = false;
+		}
+
+		if (index % 2 == 0)
+		{
+			previous = Job::submit([index, dependency]() {
+				if (dependency.isValid()) records[index].dependencyDone = dependency.isDone();
+				runWork(index);
+				return index;
+			}, [](u32 index) { runCleanup(index); }, dependency.isValid() ? JobList(dependency) : JobList(), priority, queue);
+		}
+		else
+		{
+			// The callback jobs carry the index in their data pointer.
+			previous = Job::submit([dependency](void* data) {
+				u32 index = static_cast<u32>(reinterpret_cast<uintptr_t>(data));
+				if (dependency.isValid()) records[index].dependencyDone = dependency.isDone();
+				runWork(index);
+				return true;
+			}, reinterpret_cast<void*>(static_cast<uintptr_t>(index)), [](bool, void* data) {
+				runCleanup(static_cast<u32>(reinterpret_cast<uintptr_t>(data)));
+			}, dependency.isValid() ? JobList(dependency) : JobList(), priority, queue);
+		}
+
+		if (i % IDLE_GAP_INTERVAL == IDLE_GAP_INTERVAL - 1)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(2));
+		}
+	}
+}
+
+// The producers, the workers and the main thread all use the job system at the same time.
+static void concurrentProducers()
+{
+	constexpr auto TIMEOUT = std::chrono::seconds(120);
+
+	std::atomic<u32> producersDone = 0;
+	std::vector<std::thread> producers;
+	for (u32 producer = 0; producer < PRODUCERS_COUNT; producer++)
+	{
+		producers.emplace_back([producer, &producersDone]() {
+			produce(producer);
+			producersDone++;
+		});
+	}
+
+	// The cleanups are spread over many frames, so the completed jobs keep coming while they are run.
+	Job::setProcessBudget(0.05f);
+	Clock::time_point start = Clock::now();
+	while (producersDone < PRODUCERS_COUNT || cleanupsCount < JOBS_COUNT + nestedJobsCount)
+	{
+		Application::processJobs();
+		if (Clock::now() - start > TIMEOUT) break;
+	}
+
+	for (auto& producer : producers)
+	{
+		producer.join();
+	}
+
+	VUCHECK(cleanupsCount == JOBS_COUNT + nestedJobsCount);
+	VUCHECK(nestedJobsCount == JOBS_COUNT / NESTED_JOB_INTERVAL);
+
+	bool everyWorkRanOnce = true;
+	bool everyCleanupRanOnce = true;
+	bool everyCleanupOnMainThread = true;
+	bool everyDependencyDone = true;
+	for (u32 index = 0; index < JOBS_COUNT; index++)
+	{
+		everyWorkRanOnce = everyWorkRanOnce && records[index].workRuns == 1;
+		everyCleanupRanOnce = everyCleanupRanOnce && records[index].cleanupRuns == 1;
+		everyCleanupOnMainThread = everyCleanupOnMainThread && records[index].cleanupOnMainThread;
+		everyDependencyDone = everyDependencyDone && records[index].dependencyDone;
+
+		u32 nestedIndex = JOBS_COUNT + index;
+		u32 expectedNestedRuns = index % NESTED_JOB_INTERVAL == 0 ? 1 : 0;
+		everyWorkRanOnce = everyWorkRanOnce && records[nestedIndex].workRuns == expectedNestedRuns;
+		everyCleanupRanOnce = everyCleanupRanOnce && records[nestedIndex].cleanupRuns == expectedNestedRuns;
+		everyCleanupOnMainThread = everyCleanupOnMainThread && records[nestedIndex].cleanupOnMainThread;
+	}
+	VUCHECK(everyWorkRanOnce);
+	VUCHECK(everyCleanupRanOnce);
+	VUCHECK(everyCleanupOnMainThread);
+	VUCHECK(everyDependencyDone);
+}
+
+int main()
+{
+	JobSystemConfig config;
+	config.ioWorkers = 1;
+	Application::initJobs(config);
+
+	int result = testing::runTests({
+		{ "concurrentProducers", concurrentProducers },
+	});
+
+	Application::cleanupJobs();
+	return result;
+}
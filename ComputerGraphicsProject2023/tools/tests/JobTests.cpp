@@ -0,0 +1,196 @@
+// Tests of the job system.
+//
+// The global allocation functions are replaced to count the allocations, so that the paths meant to run
+// without allocating in the steady state can be checked. The last test stops the job system with jobs
+// still pending, and starts it again.
+
+#include "JobSystemHost.h"
+#include "tests/Testing.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <thread>
+
+using namespace vulture;
+
+static std::atomic<u64> allocationsCount = 0;
+
+void* operator new(std::size_t size)
+{
+	allocationsCount.fetch_add(1, std::memory_order_relaxed);
+	if (void* pointer = std::malloc(size == 0 ? 1 : size)) return pointer;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+	std::free(pointer);
+}
+
+static constexpr u64 JOBS_COUNT = 1000;
+
+// A single compute worker, which the shutdown test can keep busy.
+static JobSystemConfig makeConfig()
+{
+	JobSystemConfig config;
+	config.computeWorkers = 1;
+	config.ioWorkers = 0;
+	return config;
+}
+
+static void runTypedJobs(u64& cleanupsCount)
+{
+	cleanupsCount = 0;
+	for (u64 i = 0; i < JOBS_COUNT; i++)
+	{
+		Job::submit([i]() { return i; }, [&cleanupsCount](u64) { cleanupsCount++; });
+	}
+	while (cleanupsCount < JOBS_COUNT)
+	{
+		Application::processJobs();
+	}
+}
+
+static void typedSubmitDoesNotAllocate()
+{
+	// The first runs fill the job pool and grow the queues.
+	u64 cleanupsCount = 0;
+	for (u32 i = 0; i < 3; i++)
+	{
+		runTypedJobs(cleanupsCount);
+	}
+
+	u64 allocations = allocationsCount.load();
+	runTypedJobs(cleanupsCount);
+
+	VUCHECK(cleanupsCount == JOBS_COUNT);
+	VUCHECK(allocationsCount.load() == allocations);
+}
+
+static void parallelReduceDoesNotAllocate()
+{
+	constexpr u64 COUNT = 100000;
+	auto sum = []() {
+		return Job::parallelReduce(0, COUNT, 64, 0ULL,
+			[](u64 i) { return static_cast<unsigned long long>(i); },
+			[](unsigned long long a, unsigned long long b) { return a + b; });
+	};
+
+	for (u32 i = 0; i < 3; i++)
+	{
+		sum();
+	}
+
+	u64 allocations = allocationsCount.load();
+	unsigned long long result = sum();
+
+	VUCHECK(result == COUNT * (COUNT - 1) / 2);
+	VUCHECK(allocationsCount.load() == allocations);
+}
+
+static void parallelForDoesNotAllocate()
+{
+	constexpr u64 COUNT = 100000;
+	static std::atomic<u64> visited[COUNT];
+	auto visit = []() {
+		Job::parallelFor(0, COUNT, 64, [](u64 i) { visited[i].fetch_add(1, std::memory_order_relaxed); });
+	};
+
+	for (u32 i = 0; i < 3; i++)
+	{
+		visit();
+	}
+
+	u64 allocations = allocationsCount.load();
+	visit();
+
+	bool allVisited = true;
+	for (u64 i = 0; i < COUNT; i++)
+	{
+		allVisited = allVisited && visited[i].load() == 4;
+	}
+	VUCHECK(allVisited);
+	VUCHECK(allocationsCount.load() == allocations);
+}
+
+// The data handed to a job, freed by its cleanup.
+struct CleanupData
+{
+	static inline u32 liveCount = 0;
+
+	CleanupData() { liveCount++; }
+	~CleanupData() { liveCount--; }
+};
+
+// Jobs still queued or waiting for their cleanup when the job system is stopped.
+static void shutdownRunsPendingCleanups()
+{
+	constexpr u32 QUEUED_JOBS_COUNT = 16;
+	constexpr auto BLOCKER_DURATION = std::chrono::milliseconds(100);
+
+	u32 cleanupsCount = 0;
+	u32 successfulCleanupsCount = 0;
+	u32 stoppedCleanupsCount = 0;
+	auto cleanup = [&](bool result, void* data) {
+		delete static_cast<CleanupData*>(data);
+		cleanupsCount++;
+		if (result) successfulCleanupsCount++;
+		if (Job::getStopToken().stopRequested()) stoppedCleanupsCount++;
+	};
+
+	// Completed, but its cleanup is never processed.
+	JobHandle completed = Job::submit([](void*) { return true; }, new CleanupData, cleanup);
+	completed.wait();
+
+	// The only worker is busy until the job system is stopped, so the other jobs stay queued.
+	std::atomic<bool> blockerStarted = false;
+	JobHandle blocker = Job::submit([&]() {
+		blockerStarted = true;
+		std::this_thread::sleep_for(BLOCKER_DURATION);
+	});
+	while (!blockerStarted) std::this_thread::yield();
+
+	JobHandle queued;
+	for (u32 i = 0; i < QUEUED_JOBS_COUNT; i++)
+	{
+		queued = Job::submit([](void*) { return true; }, new CleanupData, cleanup);
+	}
+	Job::submit([](void*) { return true; }, new CleanupData, cleanup, { queued });
+
+	// The typed cleanups are not called with a false result, but their callables are still destroyed.
+	Ref<CleanupData> typedData = makeRef<CleanupData>();
+	Job::submit([typedData]() { return 0; }, [typedData](int) {});
+	typedData.reset();
+
+	Application::cleanupJobs();
+
+	VUCHECK(cleanupsCount == QUEUED_JOBS_COUNT + 2);
+	VUCHECK(successfulCleanupsCount == 0);
+	VUCHECK(stoppedCleanupsCount == QUEUED_JOBS_COUNT + 2);
+	VUCHECK(CleanupData::liveCount == 0);
+
+	// The job system is started again for the tests that follow.
+	Application::initJobs(makeConfig());
+}
+
+int main()
+{
+	Application::initJobs(makeConfig());
+
+	int result = testing::runTests({
+		{ "typedSubmitDoesNotAllocate", typedSubmitDoesNotAllocate },
+		{ "parallelReduceDoesNotAllocate", parallelReduceDoesNotAllocate },
+		{ "parallelForDoesNotAllocate", parallelForDoesNotAllocate },
+		{ "shutdownRunsPendingCleanups", shutdownRunsPendingCleanups },
+	});
+
+	Application::cleanupJobs();
+	return result;
+}
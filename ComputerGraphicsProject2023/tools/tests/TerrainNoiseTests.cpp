@@ -0,0 +1,149 @@
+// Checks the heightmaps generated by the TerrainNoise compute shader against the CPU noise function.
+//
+// The terrain queries are answered with the heights read back from the GPU, so they must agree with
+// noiseFunction within GPU_NOISE_TOLERANCE. Every chunk reports its largest absolute error.
+//
+// Needs a Vulkan device and a display. On a headless machine, with the lavapipe software driver:
+//   xvfb-run env VK_ICD_FILENAMES=/usr/share/vulkan/icd.d/lvp_icd.x86_64.json ./TerrainNoiseTests
+// The program is run from the directory containing res/shaders/TerrainNoise_comp.spv.
+
+#include "tests/Testing.h"
+
+#include "game/terrain/TerrainNoise.h"
+#include "game/terrain/TerrainNoiseShader.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+using namespace vulture;
+using namespace game;
+
+static constexpr u32 HEIGHTMAP_RESOLUTION = 128;
+// The size of a chunk in noise space with the default terrain configuration.
+static constexpr f32 CHUNK_NOISE_SIZE = 3.0f;
+
+static f32 getMaxError(const HeightGrid& heightGrid, glm::vec2 noisePosition, glm::vec2 noiseSize)
+{
+	u32 resolution = heightGrid.getResolution();
+
+	f32 maxError = 0.0f;
+	for (u32 y = 0; y < resolution; y++)
+	{
+		for (u32 x = 0; x < resolution; x++)
+		{
+			f32 noiseX = noiseSize.x * static_cast<f32>(x) / (resolution - 1);
+			f32 noiseY = noiseSize.y * static_cast<f32>(y) / (resolution - 1);
+
+			f32 expected = noiseFunction(noisePosition.x + noiseX, noisePosition.y + noiseY);
+			maxError = std::max(maxError, std::abs(heightGrid.at(x, y) - expected));
+		}
+	}
+	return maxError;
+}
+
+// Generates one chunk on the GPU, waiting for it, and returns its largest error.
+static f32 checkChunk(TerrainNoiseShader& noiseShader, glm::vec2 chunk, u32 resolution)
+{
+	glm::vec2 noiseSize(CHUNK_NOISE_SIZE);
+	glm::vec2 noisePosition = chunk * noiseSize;
+
+	auto heightmap = noiseShader.generate(noisePosition, noiseSize, resolution);
+	heightmap->wait();
+
+	HeightGrid heightGrid(chunk, 1.0f, resolution);
+	noiseShader.readHeights(*heightmap, heightGrid);
+
+	f32 maxError = getMaxError(heightGrid, noisePosition, noiseSize);
+	std::printf("    seed %d, chunk (%g, %g), %u samples per side: max abs error %e\n",
+		getTerrainNoiseSeed(), chunk.x, chunk.y, resolution, maxError);
+	return maxError;
+}
+
+static void chunksMatchCpuNoise()
+{
+	setTerrainNoiseSeed(1234);
+	TerrainNoiseShader noiseShader(getTerrainNoiseSeed());
+
+	const glm::vec2 chunks[] = { { 0, 0 }, { 1, 0 }, { -1, -1 }, { 2, -3 }, { -17, 25 } };
+	for (glm::vec2 chunk : chunks)
+	{
+		// Every level of detail of the terrain.
+		for (u32 resolution : { HEIGHTMAP_RESOLUTION, HEIGHTMAP_RESOLUTION / 2, HEIGHTMAP_RESOLUTION / 4 })
+		{
+			VUCHECK(checkChunk(noiseShader, chunk, resolution) <= GPU_NOISE_TOLERANCE);
+		}
+	}
+}
+
+// The CPU noise only uses the lowest byte of the seed, negative seeds included.
+static void seedsMatchCpuNoise()
+{
+	for (i32 seed : { 0, 7, 255, 256 + 42, -1, -123456 })
+	{
+		setTerrainNoiseSeed(seed);
+		TerrainNoiseShader noiseShader(seed);
+		VUCHECK(checkChunk(noiseShader, { 3, 5 }, HEIGHTMAP_RESOLUTION) <= GPU_NOISE_TOLERANCE);
+	}
+}
+
+// Several generations in flight at the same time, polled like the terrain does every frame.
+static void concurrentGenerationsMatchCpuNoise()
+{
+	setTerrainNoiseSeed(99);
+	TerrainNoiseShader noiseShader(getTerrainNoiseSeed());
+
+	glm::vec2 noiseSize(CHUNK_NOISE_SIZE);
+	std::vector<glm::vec2> chunks;
+	std::vector<Ref<PendingTexture>> heightmaps;
+	for (i32 y = -2; y <= 2; y++)
+	{
+		for (i32 x = -2; x <= 2; x++)
+		{
+			glm::vec2 chunk(static_cast<f32>(x), static_cast<f32>(y));
+			chunks.push_back(chunk);
+			heightmaps.push_back(noiseShader.generate(chunk * noiseSize, noiseSize, HEIGHTMAP_RESOLUTION));
+		}
+	}
+
+	f32 maxError = 0.0f;
+	u64 readCount = 0;
+	std::vector<bool> read(heightmaps.size(), false);
+	while (readCount < heightmaps.size())
+	{
+		for (u64 i = 0; i < heightmaps.size(); i++)
+		{
+			if (read[i] || !heightmaps[i]->isReady()) continue;
+
+			HeightGrid heightGrid(chunks[i], 1.0f, HEIGHTMAP_RESOLUTION);
+			noiseShader.readHeights(*heightmaps[i], heightGrid);
+			maxError = std::max(maxError, getMaxError(heightGrid, chunks[i] * noiseSize, noiseSize));
+
+			read[i] = true;
+			readCount++;
+		}
+	}
+
+	std::printf("    %zu chunks in flight: max abs error %e\n", heightmaps.size(), maxError);
+	VUCHECK(maxError <= GPU_NOISE_TOLERANCE);
+}
+
+int main()
+{
+	Window window("TerrainNoiseTests", 64, 64);
+	if (!Renderer::init("TerrainNoiseTests", window))
+	{
+		std::printf("Failed to initialize the renderer, a Vulkan device is needed.\n");
+		return 1;
+	}
+
+	int result = testing::runTests({
+		{ "chunksMatchCpuNoise", chunksMatchCpuNoise },
+		{ "seedsMatchCpuNoise", seedsMatchCpuNoise },
+		{ "concurrentGenerationsMatchCpuNoise", concurrentGenerationsMatchCpuNoise },
+	});
+
+	Renderer::cleanup();
+	return result;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdio>
+#include <initializer_list>
+
+namespace vulture::testing {
+
+/**
+ * @brief A named test, whose failures are reported through VUCHECK.
+ */
+struct TestCase
+{
+	const char* name;
+	void (*run)();
+};
+
+inline int failedChecksCount = 0;
+
+/**
+ * @brief Runs the tests in order and reports which ones failed.
+ *
+ * @return the exit code of the test program, 0 if every check passed.
+ */
+inline int runTests(std::initializer_list<TestCase> tests)
+{
+	int failedTestsCount = 0;
+	for (const TestCase& test : tests)
+	{
+		int previousFailedChecksCount = failedChecksCount;
+		test.run();
+
+		bool passed = failedChecksCount == previousFailedChecksCount;
+		std::printf("[%s] %s\n", passed ? "PASS" : "FAIL", test.name);
+		if (!passed) failedTestsCount++;
+	}
+
+	std::printf("%d of %zu tests failed\n", failedTestsCount, tests.size());
+	return failedTestsCount == 0 ? 0 : 1;
+}
+
+} // namespace vulture::testing
+
+#define VUCHECK(condition) do { if (!(condition)) { \
+	std::printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+	vulture::testing::failedChecksCount++; } } while (false)
@@ -51,6 +51,7 @@ project "ComputerGraphicsProject2023"
     postbuildcommands {
         "glslc %{prj.location}/res/shaders/Phong.vert -o %{prj.location}/res/shaders/Phong_vert.spv",
         "glslc %{prj.location}/res/shaders/Phong.frag -o %{prj.location}/res/shaders/Phong_frag.spv",
+        "glslc %{prj.location}/res/shaders/PhongInstanced.vert -o %{prj.location}/res/shaders/PhongInstanced_vert.spv",
         "glslc %{prj.location}/res/shaders/UItextSDF.vert -o %{prj.location}/res/shaders/UItextSDF_vert.spv",
         "glslc %{prj.location}/res/shaders/UItextSDF.frag -o %{prj.location}/res/shaders/UItextSDF_frag.spv",
         "glslc %{prj.location}/res/shaders/UIImage.vert -o %{prj.location}/res/shaders/UIImage_vert.spv",
@@ -59,6 +60,7 @@ project "ComputerGraphicsProject2023"
         "glslc %{prj.location}/res/shaders/Skybox.frag -o %{prj.location}/res/shaders/Skybox_frag.spv",
         "glslc %{prj.location}/res/shaders/Terrain.vert -o %{prj.location}/res/shaders/Terrain_vert.spv",
         "glslc %{prj.location}/res/shaders/Terrain.frag -o %{prj.location}/res/shaders/Terrain_frag.spv",
+        "glslc %{prj.location}/res/shaders/TerrainNoise.comp -o %{prj.location}/res/shaders/TerrainNoise_comp.spv",
         "{COPYDIR} %{prj.location}/res %{cfg.targetdir}/res"
     }
     
@@ -112,3 +114,116 @@ project "ComputerGraphicsProject2023"
             "VU_RELEASE_BUILD"
         }
         optimize "On"
+
+-- Console tools built from the tools directory and a subset of the engine sources, without the window and the renderer.
+-- The engine sources are relative to the src directory, the tool sources to the tools directory.
+JobSources = {
+    "vulture/core/Job.cpp",
+    "vulture/core/Logger.cpp",
+    "vulture/util/SystemTimer.cpp"
+}
+
+PhysicsSources = {
+    "vulture/scene/physics/**.cpp"
+}
+
+RendererSources = {
+    "vulture/renderer/**.cpp"
+}
+
+function engineTool(name, toolFiles, engineFiles)
+    project (name)
+        location "ComputerGraphicsProject2023"
+        kind "ConsoleApp"
+        language "C++"
+        cppdialect "C++20"
+        staticruntime "On"
+
+        targetdir ("bin/" .. outputdir .. "/%{prj.name}")
+        objdir ("bin-int/" .. outputdir .. "/%{prj.name}")
+
+        for _, file in ipairs(toolFiles) do
+            files { "ComputerGraphicsProject2023/tools/" .. file }
+        end
+        for _, file in ipairs(engineFiles) do
+            files { "ComputerGraphicsProject2023/src/" .. file }
+        end
+
+        includedirs
+        {
+            "ComputerGraphicsProject2023/src",
+            "ComputerGraphicsProject2023/tools",
+            "ComputerGraphicsProject2023/vendor/glm",
+            "ComputerGraphicsProject2023/vendor/stb"
+        }
+
+        filter "system:windows"
+            systemversion "latest"
+
+        filter "system:linux"
+            systemversion "latest"
+            links { "pthread" }
+
+        filter "configurations:Debug"
+            defines { "VU_DEBUG_BUILD" }
+            symbols "On"
+
+        filter "configurations:Release"
+            defines { "VU_NDEBUG_BUILD", "VU_RELEASE_BUILD" }
+            optimize "On"
+
+        filter {}
+end
+
+group "Tools"
+
+engineTool("JobBenchmark", { "JobSystemHost.h", "benchmarks/JobBenchmark.cpp" }, JobSources)
+
+engineTool("CapsuleBenchmark", { "benchmarks/CapsuleBenchmark.cpp" }, table.join(JobSources, PhysicsSources))
+
+engineTool("CapsuleBenchmarkAVX2", { "benchmarks/CapsuleBenchmark.cpp" }, table.join(JobSources, PhysicsSources))
+    -- The capsule batch tests 8 pairs at a time with AVX, 4 with the default SSE2.
+    vectorextensions "AVX2"
+
+engineTool("CollisionBenchmark", { "JobSystemHost.h", "benchmarks/CollisionBenchmark.cpp" },
+    table.join(JobSources, PhysicsSources))
+
+engineTool("CollisionEngineTests", { "JobSystemHost.h", "tests/Testing.h", "tests/CollisionEngineTests.cpp" },
+    table.join(JobSources, PhysicsSources))
+
+engineTool("JobTests", { "JobSystemHost.h", "tests/Testing.h", "tests/JobTests.cpp" }, JobSources)
+
+engineTool("JobStressTest", { "JobSystemHost.h", "tests/Testing.h", "tests/JobStressTest.cpp" }, JobSources)
+    -- Built with ThreadSanitizer, which reports the races between the producers, the workers and the main thread.
+    filter "system:linux"
+        buildoptions { "-fsanitize=thread" }
+        linkoptions { "-fsanitize=thread" }
+
+    filter {}
+
+engineTool("TerrainNoiseTests", { "tests/Testing.h", "tests/TerrainNoiseTests.cpp" },
+    table.join(JobSources, RendererSources, {
+        "vulture/util/stb_perlin.cpp",
+        "game/terrain/HeightGrid.cpp",
+        "game/terrain/TerrainNoise.cpp",
+        "game/terrain/TerrainNoiseShader.cpp"
+    }))
+    -- Unlike the other tools it opens a window and needs a Vulkan device, lavapipe is enough.
+    includedirs { "ComputerGraphicsProject2023/vendor/tinyobj" }
+    debugdir "%{cfg.targetdir}"
+
+    postbuildcommands {
+        "{MKDIR} %{cfg.targetdir}/res/shaders",
+        "glslc %{prj.location}/res/shaders/TerrainNoise.comp -o %{cfg.targetdir}/res/shaders/TerrainNoise_comp.spv"
+    }
+
+    filter "system:windows"
+        includedirs { "%{IncludeDirs.GLFW}", "%{IncludeDirs.VulkanSDK}" }
+        links { "GLFW", "%{Library.Vulkan}" }
+
+    filter "system:linux"
+        links { "vulkan", "glfw", "X11", "dl" }
+
+    filter {}
+
+group ""